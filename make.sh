@@ -15,7 +15,6 @@ cmake --build $BUILDDIR
 APPDIR=/tmp/GLPong.AppDir
 rm -rf ${APPDIR} || true
 mkdir -p ${APPDIR}/usr/bin/
-cp /code/res/*.png ${APPDIR}
 cp $BUILDDIR/glpong ${APPDIR}/usr/bin/
 
 # Generate the AppImage.
@@ -47,16 +46,44 @@ mkdir -p ${INCLUDE_EXTRA_DIR}
 ln -fs /usr/include/stb ${INCLUDE_EXTRA_DIR}/stb
 ln -fs /usr/include/glm ${INCLUDE_EXTRA_DIR}/glm
 
-emcc src/*.cpp \
-    -I ${INCLUDE_EXTRA_DIR} \
-    -s USE_SDL=2 \
-    -s USE_REGAL=1 \
-    -s STB_IMAGE=1 \
-    -s USE_WEBGL2=1 \
-    -O2 \
+EMCC_FLAGS=(
+    -I ${INCLUDE_EXTRA_DIR}
+    -s USE_SDL=2
+    -s USE_REGAL=1
+    -s STB_IMAGE=1
+    -s USE_WEBGL2=1
+    -O2
+)
+
+# Offline benchmark of the particle kernels under Node.js, with WebAssembly
+# SIMD and threads.
+if [ "$1" == "--bench" ]; then
+    emcc tools/ParticleBench.cpp src/ParticleKernels.cpp \
+        -I src \
+        -I ${INCLUDE_EXTRA_DIR} \
+        -O3 \
+        -msimd128 \
+        -pthread \
+        -s PTHREAD_POOL_SIZE=4 \
+        -s ENVIRONMENT=node,worker \
+        -o /tmp/particle_bench.js
+    exec node /tmp/particle_bench.js "${@:2}"
+fi
+
+# The asset archive was generated by the CMake build above.
+emcc src/*.cpp ${BUILDDIR}/AssetArchiveData.cpp \
+    "${EMCC_FLAGS[@]}" \
     -o ${WASMDIR}/glpong.html \
-    --preload-file ${CODEDIR}/res/particle.png@particle.png \
-    --preload-file ${CODEDIR}/res/small_blur_star.png@small_blur_star.png \
+    --emrun
+
+# Same with the SIMD particle kernels, for browsers supporting WebAssembly
+# SIMD. Threads would need the page to be cross-origin isolated, for little
+# gain at the firework's particle count: they stay off.
+mkdir -p ${WASMDIR}-simd
+emcc src/*.cpp ${BUILDDIR}/AssetArchiveData.cpp \
+    "${EMCC_FLAGS[@]}" \
+    -msimd128 \
+    -o ${WASMDIR}-simd/glpong.html \
     --emrun
 
 if [ "$1" == "--emrun" ]; then
@@ -0,0 +1,13 @@
+#version 300 es
+precision mediump float;
+in vec2 TexCoord;
+
+uniform sampler2D layerTexture;
+
+out vec4 FragColor;
+
+void main()
+{
+    // Premultiplied alpha.
+    FragColor = texture(layerTexture, TexCoord);
+}
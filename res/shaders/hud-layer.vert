@@ -0,0 +1,16 @@
+#version 300 es
+in vec2 aPos;  // Quad corner, in [0, 1].
+
+uniform vec2 canvasSize;
+uniform vec4 layerRect;  // Left, top, width and height on the canvas.
+
+out vec2 TexCoord;
+
+void main()
+{
+    vec2 pixel = layerRect.xy + aPos * layerRect.zw;
+    gl_Position = vec4(2.0 * pixel.x / canvasSize.x - 1.0, 1.0 - 2.0 * pixel.y / canvasSize.y,
+                       0.0, 1.0);
+    // Layer textures are rendered upside down, like any framebuffer.
+    TexCoord = vec2(aPos.x, 1.0 - aPos.y);
+}
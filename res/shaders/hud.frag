@@ -0,0 +1,17 @@
+#version 300 es
+precision mediump float;
+in vec2 TexCoord;
+in vec4 GlyphColor;
+
+uniform sampler2D glyphAtlas;
+
+out vec4 FragColor;
+
+void main()
+{
+    // Signed distance field: 0.5 is the glyph edge.
+    float distance = texture(glyphAtlas, TexCoord).r;
+    float width = fwidth(distance);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    FragColor = vec4(GlyphColor.rgb, GlyphColor.a * alpha);
+}
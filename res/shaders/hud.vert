@@ -0,0 +1,20 @@
+#version 300 es
+in vec2 aPos;    // Quad corner, in [0, 1].
+in vec4 aRect;   // Left, top, width and height on the canvas.
+in float aGlyph; // Cell of the glyph atlas.
+in vec4 aColor;
+
+uniform vec2 canvasSize;
+uniform float glyphCount;
+
+out vec2 TexCoord;
+out vec4 GlyphColor;
+
+void main()
+{
+    vec2 pixel = aRect.xy + aPos * aRect.zw;
+    gl_Position = vec4(2.0 * pixel.x / canvasSize.x - 1.0, 1.0 - 2.0 * pixel.y / canvasSize.y,
+                       0.0, 1.0);
+    TexCoord = vec2((aGlyph + aPos.x) / glyphCount, aPos.y);
+    GlyphColor = aColor;
+}
@@ -0,0 +1,12 @@
+#version 300 es
+precision mediump float;
+in float Light;
+
+uniform vec3 objectColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(Light * objectColor, 1.0);
+}
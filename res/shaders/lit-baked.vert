@@ -0,0 +1,21 @@
+#version 300 es
+in vec3 aPos;
+in float aLight;
+
+layout(std140) uniform Frame {
+    highp mat4 view;
+    highp mat4 projection;
+    highp vec3 lightPos;
+    highp vec3 lightAmbient;
+    highp vec3 lightDiffuse;
+};
+
+uniform mat4 model;
+
+out float Light;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    Light = aLight;
+}
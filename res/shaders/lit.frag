@@ -0,0 +1,28 @@
+#version 300 es
+precision mediump float;
+in vec3 Normal;
+in vec3 FragPos;
+
+layout(std140) uniform Frame {
+    highp mat4 view;
+    highp mat4 projection;
+    highp vec3 lightPos;
+    highp vec3 lightAmbient;
+    highp vec3 lightDiffuse;
+};
+
+uniform vec3 objectColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec3 ambient = lightAmbient * objectColor;
+
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(lightPos - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = lightDiffuse * diff * objectColor;
+
+    FragColor = vec4(ambient + diffuse, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 300 es
+in vec3 aPos;
+in vec3 aNormal;
+
+layout(std140) uniform Frame {
+    highp mat4 view;
+    highp mat4 projection;
+    highp vec3 lightPos;
+    highp vec3 lightAmbient;
+    highp vec3 lightDiffuse;
+};
+
+uniform mat4 model;
+
+out vec3 Normal;
+out vec3 FragPos;
+
+void main()
+{
+    mat4 modelview = view * model;
+    vec4 eyePos = modelview * vec4(aPos, 1.0);
+    gl_Position = projection * eyePos;
+    FragPos = vec3(eyePos);
+    Normal = mat3(modelview) * aNormal;
+}
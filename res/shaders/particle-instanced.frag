@@ -0,0 +1,14 @@
+#version 300 es
+precision mediump float;
+in vec2 TexCoord;
+in vec3 ParticleColor;
+
+uniform sampler2D particleTexture;
+
+out vec4 FragColor;
+
+void main()
+{
+    // One-channel texture.
+    FragColor = vec4(ParticleColor * texture(particleTexture, TexCoord).r, 1.0);
+}
@@ -0,0 +1,29 @@
+#version 300 es
+in vec2 aPos;     // Quad corner, in [0, 1].
+in vec4 aCenter;  // Center of the particle, and its size.
+in vec3 aColor;
+
+layout(std140) uniform Frame {
+    highp mat4 view;
+    highp mat4 projection;
+    highp vec3 lightPos;
+    highp vec3 lightAmbient;
+    highp vec3 lightDiffuse;
+};
+
+uniform mat4 model;
+
+out vec2 TexCoord;
+out vec3 ParticleColor;
+
+void main()
+{
+    // Facing the camera: along the right and up vectors of the view.
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    vec2 corner = (aPos * 2.0 - 1.0) * aCenter.w;
+    vec3 position = aCenter.xyz + right * corner.x + up * corner.y;
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    TexCoord = aPos;
+    ParticleColor = aColor;
+}
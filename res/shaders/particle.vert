@@ -0,0 +1,24 @@
+#version 300 es
+in vec3 aPos;
+in vec2 aTexCoord;
+in vec3 aColor;
+
+layout(std140) uniform Frame {
+    highp mat4 view;
+    highp mat4 projection;
+    highp vec3 lightPos;
+    highp vec3 lightAmbient;
+    highp vec3 lightDiffuse;
+};
+
+uniform mat4 model;
+
+out vec2 TexCoord;
+out vec3 ParticleColor;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    TexCoord = aTexCoord;
+    ParticleColor = aColor;
+}
@@ -0,0 +1,59 @@
+#include "AssetArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Generated by tools/PackAssets.cpp.
+extern const unsigned char kAssetArchiveData[];
+extern const size_t kAssetArchiveSize;
+
+AssetArchive::AssetArchive(const unsigned char* data, size_t size) : data_(data) {
+  const Header* header = reinterpret_cast<const Header*>(data);
+  if (size < sizeof(Header) || std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->version != kVersion ||
+      header->entry_count > (size - sizeof(Header)) / sizeof(Entry)) {
+    throw std::runtime_error("Invalid asset archive");
+  }
+  entries_ = reinterpret_cast<const Entry*>(data + sizeof(Header));
+  entry_count_ = header->entry_count;
+
+  for (const Entry* entry = entries_; entry != entries_ + entry_count_; ++entry) {
+    if (entry->name_offset >= size || !std::memchr(data + entry->name_offset, '\0',
+                                                   size - entry->name_offset) ||
+        entry->data_offset > size || entry->data_size >= size - entry->data_offset ||
+        data[entry->data_offset + entry->data_size] != '\0') {
+      throw std::runtime_error("Invalid asset archive entry");
+    }
+  }
+}
+
+const AssetArchive& AssetArchive::Embedded() {
+  static const AssetArchive archive(kAssetArchiveData, kAssetArchiveSize);
+  return archive;
+}
+
+bool AssetArchive::Find(std::string_view name, Asset* asset) const {
+  const Entry* end = entries_ + entry_count_;
+  const Entry* entry = std::lower_bound(
+      entries_, end, name, [this](const Entry& entry, std::string_view name) {
+        return GetName(entry) < name;
+      });
+  if (entry == end || GetName(*entry) != name) return false;
+
+  asset->data = data_ + entry->data_offset;
+  asset->size = entry->data_size;
+  asset->hash = entry->hash;
+  return true;
+}
+
+AssetArchive::Asset AssetArchive::Get(std::string_view name) const {
+  Asset asset;
+  if (!Find(name, &asset)) throw std::runtime_error("Missing asset: " + std::string(name));
+  return asset;
+}
+
+std::string_view AssetArchive::GetName(const Entry& entry) const {
+  return reinterpret_cast<const char*>(data_ + entry.name_offset);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Read-only archive of the game's resources and shaders, packed at build time
+// by tools/PackAssets.cpp and built into the executable. Assets are used in
+// place: no copies and no file system lookups.
+//
+// Layout: a Header, the Entry index sorted by name, the NUL-terminated names,
+// then the data of each asset, kAlignment aligned and followed by a NUL byte.
+class AssetArchive {
+ public:
+  static constexpr char kMagic[4] = {'G', 'L', 'P', 'A'};
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kAlignment = 16;
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+  };
+
+  struct Entry {
+    uint64_t hash;         // HashBytes() of the data.
+    uint32_t name_offset;  // Offsets from the start of the archive.
+    uint32_t data_offset;
+    uint32_t data_size;  // Not counting the trailing NUL byte.
+    uint32_t reserved;
+  };
+
+  struct Asset {
+    // The trailing NUL byte makes text assets C strings.
+    const char* GetText() const { return reinterpret_cast<const char*>(data); }
+
+    const unsigned char* data;
+    size_t size;
+    uint64_t hash;  // Identifies the content, e.g. for caches.
+  };
+
+  // The archive must outlive this object. Throws std::runtime_error if it is
+  // malformed.
+  AssetArchive(const unsigned char* data, size_t size);
+
+  // The archive built into the executable.
+  static const AssetArchive& Embedded();
+
+  // Returns false if there is no asset with this name, a path relative to res/
+  // with '/' separators.
+  bool Find(std::string_view name, Asset* asset) const;
+
+  // Like Find(), but throws std::runtime_error if the asset is missing.
+  Asset Get(std::string_view name) const;
+
+ private:
+  std::string_view GetName(const Entry& entry) const;
+
+  const unsigned char* data_;
+  const Entry* entries_;
+  uint32_t entry_count_;
+};
@@ -0,0 +1,184 @@
+#include "AudioMixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+constexpr int kRequestedFrequency = 48000;  // Hz
+// About 5 ms per buffer: sounds start at most a few milliseconds late.
+constexpr int kRequestedBufferFrames = 256;
+constexpr float kMasterVolume = 0.5f;
+constexpr float kTwoPi = 2.0f * float(M_PI);
+
+// Samples of a sound lasting duration seconds, from a function of time.
+template <typename Function>
+std::vector<float> SynthesizeSound(int frequency, float duration, Function function) {
+  std::vector<float> samples(static_cast<size_t>(frequency * duration));
+  for (size_t i = 0; i < samples.size(); ++i) samples[i] = function(float(i) / frequency);
+  return samples;
+}
+}  // namespace
+
+AudioMixer::AudioMixer() {
+  if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+    std::cerr << "Audio initialization failed: " << SDL_GetError() << std::endl;
+    return;
+  }
+
+  SDL_AudioSpec desired = {};
+  desired.freq = kRequestedFrequency;
+  desired.format = AUDIO_F32SYS;
+  desired.channels = 2;
+  desired.samples = kRequestedBufferFrames;
+  desired.callback = &AudioMixer::AudioCallback;
+  desired.userdata = this;
+  SDL_AudioSpec obtained;
+  // SDL converts to the device's format and channels if needed.
+  device_ = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained,
+                                SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+  if (!device_) {
+    std::cerr << "Audio device opening failed: " << SDL_GetError() << std::endl;
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    return;
+  }
+  frequency_ = obtained.freq;
+  buffer_frames_ = obtained.samples;
+  std::cout << "Audio: " << SDL_GetCurrentAudioDriver() << " driver, " << frequency_ << " Hz, "
+            << buffer_frames_ << " frame buffers" << std::endl;
+
+  Synthesize();
+  SDL_PauseAudioDevice(device_, 0);
+}
+
+AudioMixer::~AudioMixer() {
+  if (!device_) return;
+  SDL_CloseAudioDevice(device_);
+  SDL_QuitSubSystem(SDL_INIT_AUDIO);
+
+  Stats stats = GetStats();
+  std::cout << "Audio: " << stats.sound_count << " sounds, latency mean " << stats.mean_latency
+            << " ms, max " << stats.max_latency << " ms; " << stats.underrun_count
+            << " underruns in " << stats.callback_count << " callbacks; " << stats.dropped_count
+            << " sounds dropped" << std::endl;
+}
+
+void AudioMixer::Play(Sound sound, float volume, float pan) {
+  if (!device_) return;
+  if (!commands_.Push({sound, volume, pan, SDL_GetPerformanceCounter()}))
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+AudioMixer::Stats AudioMixer::GetStats() const {
+  const double ticks_per_millisecond = SDL_GetPerformanceFrequency() / 1000.0;
+  // Samples mixed in a callback are heard after the buffer ahead of them.
+  const double buffer_duration = buffer_frames_ * 1000.0 / frequency_;
+
+  Stats stats;
+  stats.callback_count = callback_count_.load(std::memory_order_relaxed);
+  stats.underrun_count = underrun_count_.load(std::memory_order_relaxed);
+  stats.dropped_count = dropped_count_.load(std::memory_order_relaxed);
+  stats.sound_count = sound_count_.load(std::memory_order_relaxed);
+  stats.mean_latency = 0.0;
+  stats.max_latency = 0.0;
+  if (stats.sound_count > 0) {
+    stats.mean_latency = latency_sum_.load(std::memory_order_relaxed) / ticks_per_millisecond /
+                             stats.sound_count +
+                         buffer_duration;
+    stats.max_latency =
+        max_latency_.load(std::memory_order_relaxed) / ticks_per_millisecond + buffer_duration;
+  }
+  return stats;
+}
+
+void AudioMixer::Synthesize() {
+  auto& paddle_hit = sounds_[static_cast<int>(Sound::kPaddleHit)];
+  auto& wall_bounce = sounds_[static_cast<int>(Sound::kWallBounce)];
+  auto& score = sounds_[static_cast<int>(Sound::kScore)];
+  auto& explosion = sounds_[static_cast<int>(Sound::kExplosion)];
+
+  // Short, bright blip.
+  paddle_hit = SynthesizeSound(frequency_, 0.12f, [&](float t) {
+    return std::sin(kTwoPi * 660.0f * t) * std::exp(-t * 40.0f);
+  });
+  // Lower and shorter.
+  wall_bounce = SynthesizeSound(frequency_, 0.08f, [&](float t) {
+    return 0.8f * std::sin(kTwoPi * 330.0f * t) * std::exp(-t * 50.0f);
+  });
+  // Falling tone, from 880 Hz to 220 Hz.
+  constexpr float kScoreDuration = 0.35f;
+  score = SynthesizeSound(frequency_, kScoreDuration, [&](float t) {
+    float phase = kTwoPi * (880.0f * t - 660.0f * t * t / (2.0f * kScoreDuration));
+    return 0.7f * std::sin(phase) * (1.0f - t / kScoreDuration);
+  });
+  // Low-passed noise burst.
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+  float low_pass = 0.0f;
+  explosion = SynthesizeSound(frequency_, 0.8f, [&](float t) {
+    low_pass += 0.15f * (noise(generator) - low_pass);
+    return 2.0f * low_pass * std::exp(-t * 6.0f);
+  });
+}
+
+void AudioMixer::AudioCallback(void* mixer, Uint8* stream, int length) {
+  static_cast<AudioMixer*>(mixer)->Mix(reinterpret_cast<float*>(stream),
+                                       length / (2 * sizeof(float)));
+}
+
+void AudioMixer::StartVoice(const Command& command, Uint64 now) {
+  // Steal the voice closest to its end if they are all busy.
+  Voice* voice = &voices_[0];
+  for (Voice& candidate : voices_) {
+    if (!candidate.samples) {
+      voice = &candidate;
+      break;
+    }
+    if (candidate.samples->size() - candidate.position < voice->samples->size() - voice->position)
+      voice = &candidate;
+  }
+
+  // Constant power panning.
+  float angle = (std::clamp(command.pan, -1.0f, 1.0f) + 1.0f) * float(M_PI) / 4.0f;
+  float gain = command.volume * kMasterVolume;
+  voice->samples = &sounds_[static_cast<int>(command.sound)];
+  voice->position = 0;
+  voice->left_gain = gain * std::cos(angle);
+  voice->right_gain = gain * std::sin(angle);
+
+  uint64_t latency = now - command.time;
+  latency_sum_.fetch_add(latency, std::memory_order_relaxed);
+  if (latency > max_latency_.load(std::memory_order_relaxed))
+    max_latency_.store(latency, std::memory_order_relaxed);
+  sound_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioMixer::Mix(float* output, int frame_count) {
+  const Uint64 now = SDL_GetPerformanceCounter();
+  if (last_callback_time_) {
+    // The device played everything queued before asking for more.
+    const Uint64 buffer_ticks = SDL_GetPerformanceFrequency() * buffer_frames_ / frequency_;
+    if (now - last_callback_time_ > buffer_ticks * 3 / 2)
+      underrun_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  last_callback_time_ = now;
+  callback_count_.fetch_add(1, std::memory_order_relaxed);
+
+  Command command;
+  while (commands_.Pop(&command)) StartVoice(command, now);
+
+  std::fill(output, output + frame_count * 2, 0.0f);
+  for (Voice& voice : voices_) {
+    if (!voice.samples) continue;
+    const size_t count = std::min<size_t>(frame_count, voice.samples->size() - voice.position);
+    const float* samples = voice.samples->data() + voice.position;
+    for (size_t i = 0; i < count; ++i) {
+      output[2 * i] += samples[i] * voice.left_gain;
+      output[2 * i + 1] += samples[i] * voice.right_gain;
+    }
+    voice.position += count;
+    if (voice.position == voice.samples->size()) voice.samples = nullptr;
+  }
+  for (int i = 0; i < frame_count * 2; ++i) output[i] = std::clamp(output[i], -1.0f, 1.0f);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "SpscQueue.h"
+
+enum class Sound { kPaddleHit, kWallBounce, kScore, kExplosion };
+
+// Plays the game's sounds, synthesized once at startup.
+//
+// Play() only pushes a command to a lock-free queue. The SDL audio callback
+// drains it and mixes the voices into small buffers, without locks or
+// allocations, so that sounds start within a buffer or two. The game stays
+// silent if no audio device can be opened. SDL_AUDIODRIVER=dummy runs the
+// mixer without a sound card, e.g. to measure it.
+class AudioMixer {
+ public:
+  // Trigger to output latency and buffer underruns since the start.
+  struct Stats {
+    uint64_t callback_count;
+    uint64_t underrun_count;  // Callbacks late by more than half a buffer.
+    uint64_t dropped_count;   // Sounds not played because the queue was full.
+    uint64_t sound_count;
+    double mean_latency;  // Milliseconds.
+    double max_latency;   // Milliseconds.
+  };
+
+  AudioMixer();
+  // Prints the statistics.
+  ~AudioMixer();
+
+  AudioMixer(const AudioMixer&) = delete;
+  AudioMixer& operator=(const AudioMixer&) = delete;
+
+  // Starts a sound. pan goes from -1 (left) to 1 (right). Calls must not run
+  // concurrently: scene objects declare the mixer in their update's writes.
+  void Play(Sound sound, float volume = 1.0f, float pan = 0.0f);
+
+  Stats GetStats() const;
+
+ private:
+  static constexpr int kSoundCount = 4;
+  static constexpr int kMaxVoices = 16;
+
+  struct Command {
+    Sound sound;
+    float volume;
+    float pan;
+    Uint64 time;  // Performance counter when Play() was called.
+  };
+
+  struct Voice {
+    const std::vector<float>* samples = nullptr;  // Mono.
+    size_t position = 0;
+    float left_gain = 0.0f;
+    float right_gain = 0.0f;
+  };
+
+  static void AudioCallback(void* mixer, Uint8* stream, int length);
+
+  void Synthesize();
+  // Audio thread.
+  void StartVoice(const Command& command, Uint64 now);
+  void Mix(float* output, int frame_count);
+
+  SDL_AudioDeviceID device_ = 0;
+  int frequency_ = 48000;  // Hz
+  int buffer_frames_ = 256;
+  std::array<std::vector<float>, kSoundCount> sounds_;
+  SpscQueue<Command, 64> commands_;
+
+  // Audio thread state.
+  std::array<Voice, kMaxVoices> voices_;
+  Uint64 last_callback_time_ = 0;
+
+  // Written by the audio thread, read by GetStats().
+  std::atomic<uint64_t> callback_count_{0};
+  std::atomic<uint64_t> underrun_count_{0};
+  std::atomic<uint64_t> sound_count_{0};
+  std::atomic<uint64_t> latency_sum_{0};  // Performance counter ticks.
+  std::atomic<uint64_t> max_latency_{0};  // Performance counter ticks.
+  // Producer side.
+  std::atomic<uint64_t> dropped_count_{0};
+};
@@ -0,0 +1,44 @@
+#include "BallGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PongPhysics.h"
+
+// The board has its left border at positive x.
+constexpr float kGridWidth = kBoardLeft - kBoardRight;
+constexpr float kGridHeight = kBoardTop - kBoardBottom;
+
+BallGrid::BallGrid(float cell_size)
+    : columns_(std::max(1, static_cast<int>(kGridWidth / cell_size))),
+      rows_(std::max(1, static_cast<int>(kGridHeight / cell_size))),
+      // Rounded down, so cells are at least cell_size.
+      columns_per_unit_(columns_ / kGridWidth),
+      rows_per_unit_(rows_ / kGridHeight),
+      cell_starts_(columns_ * rows_ + 1) {}
+
+int BallGrid::GetCell(const glm::vec2& position) const {
+  const int column = std::clamp(
+      static_cast<int>((position.x - kBoardRight) * columns_per_unit_), 0, columns_ - 1);
+  const int row =
+      std::clamp(static_cast<int>((position.y - kBoardBottom) * rows_per_unit_), 0, rows_ - 1);
+  return row * columns_ + column;
+}
+
+void BallGrid::Build(const std::vector<glm::vec2>& positions) {
+  // Counting sort: sizes of the cells, their ends, then the balls.
+  std::fill(cell_starts_.begin(), cell_starts_.end(), 0);
+  ball_cells_.resize(positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    ball_cells_[i] = GetCell(positions[i]);
+    ++cell_starts_[ball_cells_[i]];
+  }
+  for (size_t cell = 1; cell < cell_starts_.size(); ++cell)
+    cell_starts_[cell] += cell_starts_[cell - 1];
+
+  // Filled from the end of each cell, which ends up at its start. Backward,
+  // so that the balls of a cell are in order.
+  cell_balls_.resize(positions.size());
+  for (size_t i = positions.size(); i-- > 0;)
+    cell_balls_[--cell_starts_[ball_cells_[i]]] = static_cast<uint32_t>(i);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Uniform grid over the board, to find the balls that may touch without
+// testing every pair. Cells are at least as wide as a ball, so that touching
+// balls are in the same cell or in neighbouring ones. Balls outside of the
+// board, e.g. past a paddle, are in the cells of its border.
+class BallGrid {
+ public:
+  explicit BallGrid(float cell_size);
+
+  // Sorts the balls into the cells, by their index in positions.
+  void Build(const std::vector<glm::vec2>& positions);
+
+  // Calls function(i, j) once for each pair of balls in the same or in
+  // neighbouring cells.
+  template <typename Function>
+  void ForEachNearbyPair(Function function) const;
+
+ private:
+  int GetCell(const glm::vec2& position) const;
+
+  int columns_;
+  int rows_;
+  float columns_per_unit_;
+  float rows_per_unit_;
+  // Ball indices sorted by cell; those of cell c are from cell_starts_[c] to
+  // cell_starts_[c + 1].
+  std::vector<uint32_t> cell_starts_;
+  std::vector<uint32_t> cell_balls_;
+  std::vector<uint32_t> ball_cells_;  // Reused by Build().
+};
+
+template <typename Function>
+void BallGrid::ForEachNearbyPair(Function function) const {
+  // Each pair of cells once: a cell with itself, then with the neighbours on
+  // its right and below it.
+  constexpr int kNeighbours[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+  for (int row = 0; row < rows_; ++row) {
+    for (int column = 0; column < columns_; ++column) {
+      const int cell = row * columns_ + column;
+      const uint32_t begin = cell_starts_[cell];
+      const uint32_t end = cell_starts_[cell + 1];
+      for (uint32_t i = begin; i < end; ++i) {
+        for (uint32_t j = i + 1; j < end; ++j) function(cell_balls_[i], cell_balls_[j]);
+      }
+      if (begin == end) continue;
+
+      for (const auto& neighbour : kNeighbours) {
+        const int other_column = column + neighbour[0];
+        const int other_row = row + neighbour[1];
+        if (other_column < 0 || other_column >= columns_ || other_row >= rows_) continue;
+        const int other = other_row * columns_ + other_column;
+        for (uint32_t i = begin; i < end; ++i) {
+          for (uint32_t j = cell_starts_[other]; j < cell_starts_[other + 1]; ++j)
+            function(cell_balls_[i], cell_balls_[j]);
+        }
+      }
+    }
+  }
+}
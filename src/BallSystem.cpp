@@ -0,0 +1,292 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Copyright (c) 2003-2024 Werner BEROUX
+ * Mail: werner@beroux.com
+ * Web : www.beroux.com
+ */
+
+#include "BallSystem.h"
+
+#include <GL/gl.h>
+
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <optional>
+#include <vector>
+
+#include "AudioMixer.h"
+#include "Board.h"
+#include "PaddleSystem.h"
+#include "PongPhysics.h"
+#include "Trajectory.h"
+
+// Dots of the predicted path.
+constexpr int kMaxPredictionDots = 64;
+constexpr float kPredictionDotSpacing = 4.0f;
+constexpr float kPredictionDotSize = 0.8f;
+
+// Obstacles a ball bounces off in a tick, at most: one wedged between two
+// could bounce forever.
+constexpr int kMaxObstacleBounces = 4;
+// Fraction of the motion that a ball stops short of an obstacle, so that the
+// next sweep doesn't start inside it.
+constexpr float kObstacleGap = 1e-3f;
+
+// Where the center of the ball is when it touches the front of a paddle.
+static float GetPaddleLine(bool is_left, float radius) {
+  return is_left ? Board::GetLeft() - PaddleSystem::GetWidth() - radius
+                 : Board::GetRight() + PaddleSystem::GetWidth() + radius;
+}
+
+BallSystem::BallSystem(ShaderLibrary& shaders, World& world, AudioMixer& audio, Board& board,
+                       GLuint texture, int max_ball_count)
+    : world_(world),
+      audio_(audio),
+      board_(board),
+      max_ball_count_(max_ball_count),
+      ball_radius_(GetBallRadius(max_ball_count)),
+      grid_(2.0f * ball_radius_),
+      trail_shader_(shaders, texture),
+      gen_(std::random_device()()),
+      fade_dist_(3.0f, 28.0f) {}
+
+BallSystem::~BallSystem() {}
+
+Entity BallSystem::Spawn(Entity left_paddle, Entity right_paddle) {
+  assert(world_.balls.GetCount() < static_cast<size_t>(max_ball_count_));
+  Entity entity = world_.Create();
+  Ball& ball = world_.balls.Add(entity);
+  ball.left_paddle = left_paddle;
+  ball.right_paddle = right_paddle;
+
+  // Create a new ball.
+  ball.position.y = 0.0f;
+  bool go_left = std::uniform_int_distribution(0, 1)(gen_) == 0;
+  NewBall(ball, go_left);
+  // Rather than on top of each other.
+  if (world_.balls.GetCount() > 1) {
+    std::uniform_real_distribution<float> x_dist(kBoardRight + kPaddleWidth + ball_radius_,
+                                                 kBoardLeft - kPaddleWidth - ball_radius_);
+    std::uniform_real_distribution<float> y_dist(kBoardBottom + ball_radius_,
+                                                 kBoardTop - ball_radius_);
+    ball.position = {x_dist(gen_), y_dist(gen_)};
+    Predict(ball);
+  }
+
+  // Init particles.
+  BallTrail& trail = world_.trails.Add(entity);
+  for (auto& part : trail.particles) {
+    part.life = 1.0f;
+    part.fade = fade_dist_(gen_);  // Random Fade Value
+    part.pos.x = ball.speed.x;
+    part.pos.y = ball.speed.y;
+    part.pos.z = -ball_radius_;
+  }
+  return entity;
+}
+
+JobAccess BallSystem::GetUpdateAccess() const {
+  JobAccess access{{}, {&world_.balls, &world_.trails, &world_.paddles, &board_, &audio_}};
+  if (obstacles_) access.reads.push_back(obstacles_);
+  return access;
+}
+
+void BallSystem::Update(float dt) {
+  tick_events_ = 0;
+  for (Ball& ball : world_.balls) UpdateBall(ball, dt);
+  if (world_.balls.GetCount() > 1) UpdateCollisions();
+  if (is_trail_enabled_) UpdateTrails(dt);
+}
+
+void BallSystem::UpdateBall(Ball& ball, float dt) {
+  if (ball.is_networked) return;
+  Paddle* left_paddle = world_.paddles.Find(ball.left_paddle);
+  Paddle* right_paddle = world_.paddles.Find(ball.right_paddle);
+  float time_left = dt;
+  uint8_t events = 0;
+  if (obstacles_) {
+    time_left = BounceOffObstacles(ball, dt);
+    if (time_left < dt) events |= kBallWallBounce;
+  }
+  // Without a paddle, the ball goes through.
+  events |= StepBall(ball.position, ball.speed, left_paddle ? &left_paddle->y : nullptr,
+                     right_paddle ? &right_paddle->y : nullptr, time_left, ball_radius_);
+  const uint8_t new_events = events & ~tick_events_;
+  tick_events_ |= events;
+  if (new_events & kBallWallBounce)
+    audio_.Play(Sound::kWallBounce, 0.6f, Board::GetPan(ball.position.x));
+
+  const bool is_scoring = max_ball_count_ == 1;
+  if (events & kBallLeftPaddleHit) {
+    PaddleSystem::Illuminate(*left_paddle);
+    if (new_events & kBallLeftPaddleHit)
+      audio_.Play(Sound::kPaddleHit, 1.0f, Board::GetPan(Board::GetLeft()));
+    Predict(ball);
+  } else if (events & kBallRightPaddleHit) {
+    PaddleSystem::Illuminate(*right_paddle);
+    if (new_events & kBallRightPaddleHit)
+      audio_.Play(Sound::kPaddleHit, 1.0f, Board::GetPan(Board::GetRight()));
+    Predict(ball);
+  } else if (events & kBallPassedLeft) {
+    if (is_scoring)
+      board_.Score(true);
+    else if (new_events & kBallPassedLeft)
+      board_.ShowPoint(true);
+    NewBall(ball, true);
+  } else if (events & kBallPassedRight) {
+    if (is_scoring)
+      board_.Score(false);
+    else if (new_events & kBallPassedRight)
+      board_.ShowPoint(false);
+    NewBall(ball, false);
+  }
+}
+
+float BallSystem::BounceOffObstacles(Ball& ball, float dt) {
+  for (int bounce = 0; bounce < kMaxObstacleBounces; ++bounce) {
+    const glm::vec2 motion = ball.speed * dt;
+    std::optional<ObstacleHit> hit = obstacles_->Sweep(ball.position, motion, ball_radius_);
+    if (!hit) {
+      if (bounce > 0) Predict(ball);
+      return dt;
+    }
+    ball.position += motion * std::max(0.0f, hit->time - kObstacleGap);
+    ball.speed = glm::reflect(ball.speed, hit->normal);
+    dt *= 1.0f - hit->time;
+  }
+  // Wedged: it stays there for the rest of the tick.
+  Predict(ball);
+  return 0.0f;
+}
+
+void BallSystem::UpdateCollisions() {
+  positions_.clear();
+  for (const Ball& ball : world_.balls) positions_.push_back(ball.position);
+  grid_.Build(positions_);
+
+  bool has_bounced = false;
+  grid_.ForEachNearbyPair([&](uint32_t i, uint32_t j) {
+    Ball& ball = world_.balls[i];
+    Ball& other = world_.balls[j];
+    if (!CollideBalls(ball.position, ball.speed, other.position, other.speed, ball_radius_))
+      return;
+    Predict(ball);
+    Predict(other);
+    has_bounced = true;
+  });
+  if (has_bounced) audio_.Play(Sound::kWallBounce, 0.2f, 0.0f);
+}
+
+void BallSystem::UpdateTrails(float dt) {
+  std::uniform_real_distribution<float> pos_dist(-ball_radius_ * 0.5f, ball_radius_ * 0.5f);
+  const std::vector<Entity>& entities = world_.trails.GetEntities();
+  for (size_t i = 0; i < entities.size(); ++i) {
+    const Ball* ball = world_.balls.Find(entities[i]);
+    if (!ball) continue;
+
+    for (auto& part : world_.trails[i].particles) {
+      // Reduce Particles Life By 'Fade'
+      part.life -= part.fade * dt;
+
+      // Regenerate if Particle is Burned Out
+      if (part.life >= 0.0f) continue;
+
+      part.life = 1.0f;
+      part.fade = fade_dist_(gen_);  // Random Fade Value
+      part.pos.x = ball->position.x + pos_dist(gen_);
+      part.pos.y = ball->position.y + pos_dist(gen_);
+      part.pos.z = -ball_radius_ + pos_dist(gen_);
+    }
+  }
+}
+
+void BallSystem::SetTrailEnabled(bool enabled) {
+  if (enabled && !is_trail_enabled_) {
+    // The particles were left behind: burn them out so they start over from
+    // the balls.
+    for (BallTrail& trail : world_.trails)
+      for (auto& part : trail.particles) part.life = -1.0f;
+  }
+  is_trail_enabled_ = enabled;
+}
+
+void BallSystem::Snapshot(SceneSnapshot& snapshot) const {
+  auto color = glm::vec3(0.0f, 1.0f, 0.0f);
+
+  // Smaller balls have smaller trails.
+  const float part_size = 1.7f * ball_radius_ / kBallRadius;
+  for (const BallTrail& trail : world_.trails) {
+    for (const auto& part : trail.particles) {
+      if (part.life <= 0.0f) continue;
+
+      snapshot.ball_particles.push_back({part.pos, part.life * part_size, color});
+    }
+  }
+
+  if (!is_prediction_shown_) return;
+  // Dots evenly spaced along the path of each ball to the next paddle.
+  for (const Ball& ball : world_.balls) {
+    PredictPath(ball.position, ball.speed, GetPaddleLine(ball.speed.x > 0.0f, ball_radius_),
+                Board::GetBottom() + ball_radius_, Board::GetTop() - ball_radius_, path_);
+    float length = 0.0f;
+    for (size_t i = 1; i < path_.size(); ++i) length += glm::distance(path_[i - 1], path_[i]);
+    const float spacing = std::max(kPredictionDotSpacing, length / kMaxPredictionDots);
+
+    float offset = spacing;  // Along the current segment.
+    int dot_count = 0;
+    for (size_t i = 1; i < path_.size(); ++i) {
+      const float segment_length = glm::distance(path_[i - 1], path_[i]);
+      for (; offset <= segment_length && dot_count < kMaxPredictionDots; offset += spacing) {
+        ++dot_count;
+        const glm::vec2 dot = glm::mix(path_[i - 1], path_[i], offset / segment_length);
+        snapshot.prediction_particles.push_back(
+            {glm::vec3(dot, -ball_radius_), kPredictionDotSize, color});
+      }
+      offset -= segment_length;
+    }
+  }
+}
+
+void BallSystem::Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4&,
+                        const glm::mat4&) const {
+  trail_shader_.Render(model, snapshot.ball_particles);
+  // Instanced as well: only the dots drawn take buffer space, not those of
+  // every ball.
+  trail_shader_.Render(model, snapshot.prediction_particles);
+}
+
+void BallSystem::NewBall(Ball& ball, bool go_to_left) {
+  // Selects a random angle.
+  std::uniform_real_distribution<float> angle_dist(-kBallMaxAngle, +kBallMaxAngle);
+  float angle;
+  do angle = angle_dist(gen_);
+  while (fabs(angle) < kBallMinAngle);
+
+  ServeBall(ball.position, ball.speed, go_to_left, angle);
+  Predict(ball);
+}
+
+void BallSystem::Predict(Ball& ball) const {
+  std::optional<TrajectoryCrossing> crossing =
+      PredictCrossing(ball.position, ball.speed, GetPaddleLine(ball.speed.x > 0.0f, ball_radius_),
+                      Board::GetBottom() + ball_radius_, Board::GetTop() - ball_radius_);
+  ball.predicted_y = crossing ? crossing->y : ball.position.y;
+  ++ball.trajectory_revision;
+}
@@ -0,0 +1,122 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * \todo Check that gluQuads can be created once and used many time.
+ */
+
+/**
+ * Copyright (c) 2003 Werner BEROUX
+ * Mail: werner@beroux.com
+ * Web : www.beroux.com
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+#include <random>
+#include <vector>
+
+#include "BallGrid.h"
+#include "GameState.h"
+#include "IObject.h"
+#include "InstancedParticleShader.h"
+#include "ObstacleField.h"
+#include "Random.h"
+#include "World.h"
+
+class AudioMixer;
+class Board;
+class ShaderLibrary;
+
+// Simulates and draws every ball of the world, with its trail. With more than
+// one ball, they bounce off each other, are smaller the more they are, and
+// points don't count: the match would be over in seconds.
+class BallSystem : public IObject {
+  // Constructor
+ public:
+  BallSystem(ShaderLibrary& shaders, World& world, AudioMixer& audio, Board& board,
+             GLuint texture, int max_ball_count = 1);
+  virtual ~BallSystem();
+
+  // Adds a ball playing between two paddles, served toward a random side.
+  // Balls after the first start anywhere on the board.
+  Entity Spawn(Entity left_paddle, Entity right_paddle);
+
+  // Implementation of IObject.
+  const char* GetName() const override { return "balls"; }
+
+  // Moves the balls, illuminates the paddles they hit and scores.
+  JobAccess GetUpdateAccess() const override;
+
+  // Update the balls.
+  void Update(float dt) override;
+
+  // Copy the trail particles.
+  void Snapshot(SceneSnapshot& snapshot) const override;
+
+  // Render the balls.
+  void Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4& view,
+              const glm::mat4& projection) const override;
+
+  // Whether the trail particles are simulated. Nobody sees them while the
+  // window is hidden.
+  void SetTrailEnabled(bool enabled);
+
+  // Obstacles the balls bounce off, none by default. Their positions are
+  // read during Update(): whoever moves them must be updated first.
+  void SetObstacles(const ObstacleField* obstacles) { obstacles_ = obstacles; }
+
+  // Whether the predicted paths of the balls are drawn.
+  void SetPredictionShown(bool shown) { is_prediction_shown_ = shown; }
+
+  // Save or restore the generator. The balls are saved with the world.
+  void Save(GameState& state) const { state.ball_random_state = gen_.GetState(); }
+  void Restore(const GameState& state) { gen_.SetState(state.ball_random_state); }
+
+  // Implementation
+ private:
+  void UpdateBall(Ball& ball, float dt);
+  // Moves the ball up to the obstacles in its way and bounces it off them.
+  // Returns the time left to move it by, in seconds.
+  float BounceOffObstacles(Ball& ball, float dt);
+  // Bounces the balls off each other.
+  void UpdateCollisions();
+  void UpdateTrails(float dt);
+
+  // Create a new ball aimed toward left or right player.
+  void NewBall(Ball& ball, bool go_to_left);
+
+  // Predicts where the ball will cross the line of the paddle it flies to.
+  void Predict(Ball& ball) const;
+
+  World& world_;
+  AudioMixer& audio_;
+  Board& board_;
+  const ObstacleField* obstacles_ = nullptr;
+  int max_ball_count_;
+  float ball_radius_;
+  BallGrid grid_;
+  std::vector<glm::vec2> positions_;  // Reused by UpdateCollisions().
+  // Events of the balls this tick: a sound of each kind per tick is enough.
+  uint8_t tick_events_ = 0;
+  InstancedParticleShader trail_shader_;  // Also draws the predicted paths.
+  Xorshift64 gen_;
+  std::uniform_real_distribution<float> fade_dist_;
+  bool is_trail_enabled_ = true;
+  bool is_prediction_shown_ = false;
+  mutable std::vector<glm::vec2> path_;  // Reused by Snapshot().
+};
@@ -28,58 +28,84 @@
 #include <glm/mat4x4.hpp>
 #include <memory>
 
+#include "GameState.h"
 #include "IObject.h"
+#include "Lighting.h"
+#include "PongPhysics.h"
+#include "Shader.h"
 
-class Shader;
+class AudioMixer;
+class ShaderLibrary;
 
 class Board : public IObject {
  public:
-  // Constructor
-  Board();
+  // Constructor. Static lighting is baked for the given camera view.
+  Board(ShaderLibrary& shaders, AudioMixer& audio, const glm::mat4& view);
   virtual ~Board();
 
   void Reset();
 
+  const char* GetName() const override { return "board"; }
+
   // Update the object.
   void Update(float dt) override;
 
+  // Copy the scores and border illumination.
+  void Snapshot(SceneSnapshot& snapshot) const override;
+
   // Render the object.
-  void Render(const glm::mat4& view, const glm::mat4& model,
+  void Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4& view,
               const glm::mat4& projection) const override;
 
-  // Process event.
-  bool ProcessEvent(const SDL_Event& event) override;
-
-  static const float GetTop() { return 48.0f; }
-  static const float GetBottom() { return -48.0f; }
-  static const float GetLeft() { return 64.0f; }
-  static const float GetRight() { return -64.0f; }
+  static const float GetTop() { return kBoardTop; }
+  static const float GetBottom() { return kBoardBottom; }
+  static const float GetLeft() { return kBoardLeft; }
+  static const float GetRight() { return kBoardRight; }
 
   static const float GetWidth() { return GetLeft() - GetRight(); }
   static const float GetHeight() { return GetTop() - GetBottom(); }
 
+  // Stereo position of a sound at x: -1 on the left of the screen, 1 on the
+  // right.
+  static float GetPan(float x);
+
   bool IsGameOver() const { return is_game_over_; }
 
   // Add points to a player's score.
   void Score(bool left_player);
 
- private:
-  void DrawDigitNumber(int number, glm::mat4 modelview) const;
+  // Lights a player's border up and plays the score sound.
+  void ShowPoint(bool left_player);
+
+  // Replaces the scores, e.g. with those of a network match. Doesn't end the
+  // game.
+  void SetScores(int left_score, int right_score);
 
+  void Save(GameState& state) const;
+  void Restore(const GameState& state);
+
+  int GetScore(bool left_player) const { return left_player ? left_score_ : right_score_; }
+
+  // Incremented whenever a score changes, so cached drawings of the scores can
+  // tell when they are out of date.
+  int GetScoreRevision() const { return score_revision_; }
+
+  // World position of the top screen-right corner of a player's score, and
+  // the score's height in world units. Scores are drawn by the HUD.
+  static glm::vec3 GetScoreAnchor(bool left_player);
+  static float GetScoreHeight();
+
+ private:
   int left_score_;
   int right_score_;
+  int score_revision_ = 0;
   float illuminate_left_border_;   // Illuminate the left border.
   float illuminate_right_border_;  // Illuminate the right border.
   bool is_game_over_;
 
+  AudioMixer& audio_;
   GLuint vao_ = 0;
   GLuint vbo_ = 0;
 
-  static constexpr int kDigits = 10;
-  std::array<GLuint, kDigits> digit_vaos_ = {0};
-  std::array<GLuint, kDigits> digit_vbos_ = {0};
-  std::array<int, kDigits> digit_vertex_counts_ = {0};
-
-  std::unique_ptr<Shader> board_shader_;
-  std::unique_ptr<Shader> digit_shader_;
+  LitMaterial material_;
 };
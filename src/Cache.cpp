@@ -0,0 +1,46 @@
+#include "Cache.h"
+
+#include <cstdlib>
+
+uint64_t Hash(const char* data, uint64_t hash) {
+  for (; *data; ++data) {
+    hash ^= static_cast<unsigned char>(*data);
+    hash *= 1099511628211ull;
+  }
+  // Separator, so that ("ab", "c") and ("a", "bc") differ.
+  return (hash ^ 0xFF) * 1099511628211ull;
+}
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t hash) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return (hash ^ 0xFF) * 1099511628211ull;
+}
+
+std::filesystem::path GetCacheDirectory(const std::string& name) {
+#if defined(__EMSCRIPTEN__)
+  // Nothing written to the browser's file system outlives the page.
+  return {};
+#else
+#if defined(_WIN32)
+  const char* local_app_data = std::getenv("LOCALAPPDATA");
+  if (!local_app_data) return {};
+  std::filesystem::path directory = std::filesystem::path(local_app_data) / "GLPong" / name;
+#else
+  std::filesystem::path directory;
+  if (const char* xdg_cache_home = std::getenv("XDG_CACHE_HOME")) {
+    directory = std::filesystem::path(xdg_cache_home) / "glpong" / name;
+  } else {
+    const char* home = std::getenv("HOME");
+    if (!home) return {};
+    directory = std::filesystem::path(home) / ".cache" / "glpong" / name;
+  }
+#endif
+  std::error_code error;
+  if (!std::filesystem::create_directories(directory, error) && error) return {};
+  return directory;
+#endif
+}
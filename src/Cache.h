@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// FNV-1a, stable across runs unlike std::hash.
+uint64_t Hash(const char* data, uint64_t hash = 14695981039346656037ull);
+
+// Same as Hash(), for binary data.
+uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+
+// Per-user directory where data that speeds up later runs is kept, created if
+// needed. Empty if there is none.
+std::filesystem::path GetCacheDirectory(const std::string& name);
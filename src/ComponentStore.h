@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Entity.h"
+
+// Components of type T of some entities, as a sparse set.
+//
+// The components are packed in a contiguous array that systems iterate in
+// bulk, next to the array of the entities owning them. A sparse array indexed
+// by entity locates each component, so that adding, finding and removing are
+// O(1). Removing moves the last component into the hole: the order isn't
+// stable, and Add() and Remove() invalidate references to components.
+template <typename T>
+class ComponentStore {
+ public:
+  // Adds a component to an entity that has none.
+  T& Add(Entity entity, T component = T()) {
+    assert(entity.IsValid() && !Find(entity));
+    if (entity.index >= sparse_.size()) sparse_.resize(entity.index + 1, kNone);
+    sparse_[entity.index] = static_cast<uint32_t>(entities_.size());
+    entities_.push_back(entity);
+    components_.push_back(std::move(component));
+    return components_.back();
+  }
+
+  // Removes the entity's component, if it has one.
+  void Remove(Entity entity) {
+    if (!Find(entity)) return;
+    const uint32_t dense = sparse_[entity.index];
+    const uint32_t last = static_cast<uint32_t>(entities_.size() - 1);
+    if (dense != last) {
+      entities_[dense] = entities_[last];
+      components_[dense] = std::move(components_[last]);
+      sparse_[entities_[dense].index] = dense;
+    }
+    entities_.pop_back();
+    components_.pop_back();
+    sparse_[entity.index] = kNone;
+  }
+
+  // The entity's component, or nullptr if it has none or was destroyed.
+  T* Find(Entity entity) {
+    return const_cast<T*>(static_cast<const ComponentStore*>(this)->Find(entity));
+  }
+  const T* Find(Entity entity) const {
+    if (entity.index >= sparse_.size()) return nullptr;
+    const uint32_t dense = sparse_[entity.index];
+    if (dense == kNone || entities_[dense] != entity) return nullptr;
+    return &components_[dense];
+  }
+
+  void Clear() {
+    for (Entity entity : entities_) sparse_[entity.index] = kNone;
+    entities_.clear();
+    components_.clear();
+  }
+
+  size_t GetCount() const { return components_.size(); }
+  bool IsEmpty() const { return components_.empty(); }
+
+  // The owner of each component, in the order of the components.
+  const std::vector<Entity>& GetEntities() const { return entities_; }
+
+  typename std::vector<T>::iterator begin() { return components_.begin(); }
+  typename std::vector<T>::iterator end() { return components_.end(); }
+  typename std::vector<T>::const_iterator begin() const { return components_.begin(); }
+  typename std::vector<T>::const_iterator end() const { return components_.end(); }
+  T& operator[](size_t i) { return components_[i]; }
+  const T& operator[](size_t i) const { return components_[i]; }
+
+ private:
+  static constexpr uint32_t kNone = ~0u;
+
+  std::vector<uint32_t> sparse_;  // Index in the dense arrays, by entity index.
+  std::vector<Entity> entities_;
+  std::vector<T> components_;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "Entity.h"
+#include "TripleBuffer.h"
+
+// Components of the game's entities: plain data, stored in the World and
+// updated in bulk by the systems (BallSystem, PaddleSystem).
+
+// Ball bouncing on the walls and on the paddles it plays against.
+struct Ball {
+  glm::vec2 position{0.0f, 0.0f};
+  glm::vec2 speed{0.0f, 0.0f};
+  Entity left_paddle;
+  Entity right_paddle;
+  // Where the ball will cross the line of the paddle it flies to. Bounces on
+  // the walls don't change it: it's predicted again only when the ball is
+  // served or hit.
+  float predicted_y = 0.0f;
+  uint32_t trajectory_revision = 0;  // Incremented with each prediction.
+  bool is_networked = false;         // Moved by NetPlay rather than BallSystem.
+};
+
+struct TrailParticle {
+  float life;  // life
+  float fade;  // Fade Speed
+  glm::vec3 pos;
+};
+
+// Particles following a ball. Kept apart from Ball, so that the physics
+// doesn't iterate over them.
+struct BallTrail {
+  static constexpr int kParticleCount = 50;
+
+  std::array<TrailParticle, kParticleCount> particles;
+};
+
+// Paddle motion, published to the render thread as soon as it changes.
+struct PaddleMotion {
+  float y = 0.0f;
+  float speed = 0.0f;
+  std::chrono::steady_clock::time_point time;  // When the paddle was at y.
+  float time_scale = 1.0f;  // Seconds of the game per second, see GLPONG_TIME_SCALE.
+  Uint32 input_timestamp = 0;                  // Last input applied, if any.
+};
+
+// Late latch of a paddle, read by the render thread just before drawing. On
+// the heap, so that it stays put when the component moves.
+struct PaddleLatch {
+  TripleBuffer<PaddleMotion> motion;
+  Uint32 reported_input_timestamp = 0;  // Render thread.
+};
+
+struct Paddle {
+  bool is_left = true;
+  float y = 0.0f;
+  float speed = 0.0f;
+  float illuminate = 0.0f;
+  Entity ball;  // Followed by the AI when nobody plays.
+  Uint32 last_update_ticks = 0;
+  Uint32 last_input_timestamp = 0;
+  // We start assuming that there was no human input.
+  float time_since_last_input = 99.0f;
+  // AI, aiming at the last trajectory of the ball it saw.
+  uint32_t ai_trajectory_revision = 0;
+  float ai_target_y = 0.0f;
+  float ai_reaction_time = 0.0f;  // Left before moving to the target.
+  bool is_networked = false;      // Moved by NetPlay rather than by input or AI.
+  std::unique_ptr<PaddleLatch> latch = std::make_unique<PaddleLatch>();
+};
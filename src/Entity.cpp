@@ -0,0 +1,17 @@
+#include "Entity.h"
+
+Entity EntityPool::Create() {
+  if (free_indices_.empty()) {
+    generations_.push_back(0);
+    return {static_cast<uint32_t>(generations_.size() - 1), 0};
+  }
+  const uint32_t index = free_indices_.back();
+  free_indices_.pop_back();
+  return {index, generations_[index]};
+}
+
+void EntityPool::Destroy(Entity entity) {
+  if (!IsAlive(entity)) return;
+  ++generations_[entity.index];
+  free_indices_.push_back(entity.index);
+}
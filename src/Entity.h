@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Handle to an entity of the World, copied freely instead of shared pointers.
+// When an entity is destroyed its index is reused with a new generation, so
+// handles to the destroyed entity never resolve to the new one.
+struct Entity {
+  static constexpr uint32_t kInvalidIndex = ~0u;
+
+  bool IsValid() const { return index != kInvalidIndex; }
+
+  bool operator==(const Entity& other) const {
+    return index == other.index && generation == other.generation;
+  }
+  bool operator!=(const Entity& other) const { return !(*this == other); }
+
+  uint32_t index = kInvalidIndex;
+  uint32_t generation = 0;
+};
+
+// Allocates entities, recycling the indices of destroyed ones so that
+// component stores indexed by entity stay small.
+class EntityPool {
+ public:
+  Entity Create();
+
+  // Invalidates every handle to the entity. Its components must be removed
+  // first, see World::Destroy().
+  void Destroy(Entity entity);
+
+  bool IsAlive(Entity entity) const {
+    return entity.index < generations_.size() && generations_[entity.index] == entity.generation;
+  }
+
+  // Number of entities alive.
+  size_t GetCount() const { return generations_.size() - free_indices_.size(); }
+
+ private:
+  std::vector<uint32_t> generations_;  // Current generation of each index.
+  std::vector<uint32_t> free_indices_;
+};
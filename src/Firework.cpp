@@ -28,6 +28,7 @@
 
 #include "Firework.h"
 
+#include <algorithm>
 #include <array>
 #include <glm/ext/matrix_float4x4.hpp>
 #include <glm/glm.hpp>
@@ -61,6 +62,15 @@ constexpr std::array<glm::vec3, kColorCount2> kWarmkColorCount = {{{1.0f, 0.5f,
                                                                    {1.0f, 1.0f, 0.8f}}};
 
 namespace {
+// Threads updating the fire of each rocket. A few thousand particles don't
+// amortize waking threads up, so builds opt in, e.g. with
+// -DGLPONG_PARTICLE_THREADS=2 -pthread.
+#ifdef GLPONG_PARTICLE_THREADS
+constexpr int kParticleThreadCount = GLPONG_PARTICLE_THREADS;
+#else
+constexpr int kParticleThreadCount = 1;
+#endif
+
 // Random number in [a, b]
 int RandomClosedInt(int a, int b) {
   static std::random_device rd;
@@ -86,12 +96,19 @@ float RandomClosedRange(float a, float b) {
 float RandomApprox(float a, float b) { return a + b * RandomClosedRange(-0.5f, 0.5f); }
 }  // namespace
 
-FireworkRocket::FireworkRocket() : is_exploding_(false) { Create(); }
+FireworkRocket::FireworkRocket(AudioMixer& audio)
+    : part_spark_(kRocketFireCount),
+      part_pink_(kExplosionPinkCount),
+      part_fire_(kExplosionPinkCount * kExplosionFireCount),
+      is_exploding_(false),
+      audio_(&audio) {
+  Create();
+}
 
 void FireworkRocket::Create() {
   // Create particles
-  for (auto& part : part_pink_) part.active = false;
-  for (auto& part : part_fire_) part.active = false;
+  std::fill(part_pink_.active.begin(), part_pink_.active.end(), 0);
+  std::fill(part_fire_.active.begin(), part_fire_.active.end(), 0);
   is_exploding_ = false;
 
   // Rocket's particle
@@ -110,59 +127,64 @@ void FireworkRocket::Create() {
   part_rocket_.color = part_rocket_.ini_color = {1.0f, 0.8f, 0.2f};
 
   // Rocket's sparks
-  for (auto& part : part_spark_) CreateRocketSpark(part);
+  for (int i = 0; i < kRocketFireCount; ++i) CreateRocketSpark(i);
 
   // Explosion's pink
   int exposition_color = RandomClosedInt(0, kColorCount - 1);
-  for (int i = 0; i < part_pink_.size(); ++i) {
-    Particle& part = part_pink_[i];
-    part = {};
-    part.active = false;
-    part.life = part.ini_life = RandomApprox(1.6f, 1.9f);
-    part.ini_size = 0.8f;
-    part.weight = 1.0f * part.ini_life;
+  for (int i = 0; i < kExplosionPinkCount; ++i) {
+    ParticleArrays& pink = part_pink_;
+    pink.life[i] = pink.initial_life[i] = RandomApprox(1.6f, 1.9f);
+    pink.initial_size[i] = 0.8f;
+    pink.size[i] = 0.0f;
+    pink.weight[i] = 1.0f * pink.initial_life[i];
     angle = RandomRange(0, 2.0 * M_PI);
     float angle2 = RandomRange(0, 2.0 * M_PI);
     float velocity = RandomApprox(7.2f, 11.1f);
-    part.speed.x = velocity * float(cos(angle2) * cos(angle));
-    part.speed.y = velocity * float(cos(angle2) * sin(angle));
-    part.speed.z = velocity * float(sin(angle2));
-    part.color = part.ini_color = kRainbowkColorCount[exposition_color];
+    pink.SetPosition(i, {0.0f, 0.0f, 0.0f});
+    pink.SetSpeed(i, velocity * glm::vec3(float(cos(angle2) * cos(angle)),
+                                          float(cos(angle2) * sin(angle)), float(sin(angle2))));
+    pink.SetColor(i, kRainbowkColorCount[exposition_color]);
 
     // Explosion's fire (trail following the pink bulbs).
-    for (int j = 0; j < kExplosionFireCount; ++j) {
-      part_fire_[i * kExplosionFireCount + j] = part;
-      part_fire_[i * kExplosionFireCount + j].weight = 0.8f;
-      part_fire_[i * kExplosionFireCount + j].speed = {0.0f, 0.0f, 0.0f};
-      part_fire_[i * kExplosionFireCount + j].color =
-          part_fire_[i * kExplosionFireCount + j].ini_color = {1.0f, 0.5f, 0.0f};
+    for (int j = i * kExplosionFireCount; j < (i + 1) * kExplosionFireCount; ++j) {
+      ParticleArrays& fire = part_fire_;
+      fire.life[j] = pink.life[i];
+      fire.initial_life[j] = pink.initial_life[i];
+      fire.initial_size[j] = pink.initial_size[i];
+      fire.size[j] = 0.0f;
+      fire.weight[j] = 0.8f;
+      fire.SetPosition(j, {0.0f, 0.0f, 0.0f});
+      fire.SetSpeed(j, {0.0f, 0.0f, 0.0f});
+      fire.SetColor(j, {1.0f, 0.5f, 0.0f});
     }
   }
 }
 
-void FireworkRocket::CreateRocketSpark(Particle& particle) {
+void FireworkRocket::CreateRocketSpark(int i) {
   int color = RandomClosedInt(0, kColorCount2 - 1);
   float rnd = RandomRange(0.0f, 0.1f);
 
-  particle.active = true;
-  particle.life = particle.ini_life = RandomApprox(1.1f, 2.0f);
-  particle.ini_size = RandomApprox(0.2f, 0.3f);
-  particle.weight = 0.5f;
-  particle.pos = part_rocket_.pos - (rnd * part_rocket_.speed +
-                                     glm::vec3{RandomApprox(0.0f, 0.1f), RandomApprox(0.0f, 0.1f),
-                                               RandomApprox(0.0f, 0.1f)});
-  particle.speed = {RandomApprox(0.0f, 0.8f), RandomApprox(0.0f, 0.8f), RandomApprox(0.0f, 0.8f)};
-  particle.color = particle.ini_color = kWarmkColorCount[color];
+  ParticleArrays& spark = part_spark_;
+  spark.active[i] = ~0;
+  spark.life[i] = spark.initial_life[i] = RandomApprox(1.1f, 2.0f);
+  spark.initial_size[i] = RandomApprox(0.2f, 0.3f);
+  spark.weight[i] = 0.5f;
+  spark.SetPosition(i, part_rocket_.pos - (rnd * part_rocket_.speed +
+                                           glm::vec3{RandomApprox(0.0f, 0.1f),
+                                                     RandomApprox(0.0f, 0.1f),
+                                                     RandomApprox(0.0f, 0.1f)}));
+  spark.SetSpeed(i, {RandomApprox(0.0f, 0.8f), RandomApprox(0.0f, 0.8f), RandomApprox(0.0f, 0.8f)});
+  spark.SetColor(i, kWarmkColorCount[color]);
 }
 
 void FireworkRocket::AddParticles(std::vector<ParticleShader::Particle>& shader_particles) const {
-  // Get camera vectors for billboarding from the actual view matrix
-  auto add_particles = [&](const auto& particles) {
-    shader_particles.reserve(shader_particles.size() + particles.size());
-    for (const auto& part : particles) {
-      if (!part.active) continue;
+  auto add_particles = [&](const ParticleArrays& particles) {
+    shader_particles.reserve(shader_particles.size() + particles.GetCount());
+    for (size_t i = 0; i < particles.GetCount(); ++i) {
+      if (!particles.active[i]) continue;
 
-      shader_particles.push_back({part.pos, part.size, part.color});
+      shader_particles.push_back(
+          {particles.GetPosition(i), particles.size[i], particles.GetColor(i)});
     }
   };
 
@@ -179,7 +201,6 @@ void FireworkRocket::AddParticles(std::vector<ParticleShader::Particle>& shader_
 void FireworkRocket::Update(float dt) {
   static float t = 0.0f;
   float life;
-  float alpha;
 
   t += dt;
 
@@ -203,79 +224,46 @@ void FireworkRocket::Update(float dt) {
   }
 
   // Update sparks
-  for (int i = 0; i < part_spark_.size(); ++i) {
-    Particle& part = part_spark_[i];
-    if (!part.active) continue;
-
-    life = part.life / part.ini_life;
-
-    part.pos += part.speed * life * life * dt;
-    part.speed.y -= float(part.weight * dt);
-    part.size = part.ini_size * life * life;
-    if (life < 0.2f) {
-      alpha = life * 5.0f;
-      part.color = part.ini_color * alpha;
-    }
-
-    part.life -= dt;
-    if (part.life < 0.0f) {
-      // If Particle Is Burned Out
-      if (part_rocket_.life < float(i) / kRocketFireCount)
-        part.active = false;
-      else
-        CreateRocketSpark(part);
-    }
+  UpdateParticles(part_spark_, dt, true);
+  for (int i = 0; i < kRocketFireCount; ++i) {
+    if (!part_spark_.active[i] || part_spark_.life[i] >= 0.0f) continue;
+
+    // If Particle Is Burned Out
+    if (part_rocket_.life < float(i) / kRocketFireCount)
+      part_spark_.active[i] = 0;
+    else
+      CreateRocketSpark(i);
   }
 
   if (!is_exploding_) return;
 
   // Update explosion particles
-  for (int i = 0; i < part_pink_.size(); ++i) {
-    Particle& part_pink = part_pink_[i];
-    if (!part_pink.active) continue;
-
-    life = part_pink.life / part_pink.ini_life;
-
-    part_pink.pos += part_pink.speed * life * life * dt;
-    part_pink.speed.y -= part_pink.weight * dt;
-    part_pink.size = part_pink.ini_size * life * life;
-    if (life < 0.2f) {
-      alpha = life * 5.0f;
-      part_pink.color = part_pink.ini_color * alpha;
-    }
+  UpdateParticles(part_pink_, dt, true);
+  for (int i = 0; i < kExplosionPinkCount; ++i) {
+    ParticleArrays& pink = part_pink_;
+    if (!pink.active[i]) continue;
 
-    part_pink.life -= (float)dt;
-    if (part_pink.life < 0.0f) part_pink.active = false;
+    // Life before this update.
+    life = (pink.life[i] + dt) / pink.initial_life[i];
+    if (pink.life[i] < 0.0f) pink.active[i] = 0;
 
     // Create fire trail
-    int j = int(life * (kExplosionFireCount - 2) + 1 + cos(t * 10.0f));
-    Particle& part_fire = part_fire_[i * kExplosionFireCount + j];
-    if (!part_fire.active) {
-      part_fire.active = true;
-      part_fire.life = 0.7f * part_pink.life;
-      part_fire.pos = part_pink.pos;
+    int j = i * kExplosionFireCount + int(life * (kExplosionFireCount - 2) + 1 + cos(t * 10.0f));
+    if (!part_fire_.active[j]) {
+      part_fire_.active[j] = ~0;
+      part_fire_.life[j] = 0.7f * pink.life[i];
+      part_fire_.SetPosition(j, pink.GetPosition(i));
     }
   }
 
+  UpdateParticlesParallel(part_fire_, dt, false, kParticleThreadCount);
   bool end_explode = true;
-  for (auto& part : part_fire_) {
-    if (!part.active) continue;
+  for (size_t i = 0; i < part_fire_.GetCount(); ++i) {
+    if (!part_fire_.active[i]) continue;
 
     end_explode = false;
-
-    life = part.life / part.ini_life;
-
-    part.pos += part.speed * dt;
-    part.speed.y -= part.weight * dt;
-    part.size = part.ini_size * life * life;
-    if (life < 0.2f) {
-      alpha = life * 5.0f;
-      part.color = part.ini_color * alpha;
-    }
-
-    part.life -= dt;
-    if (part.life < 0.0f)  // If Particle Is Burned Out
-      part.active = false;
+    if (part_fire_.life[i] < 0.0f)  // If Particle Is Burned Out
+      part_fire_.active[i] = 0;
   }
 
   // Re-create a new rocket once the explosion is complete.
@@ -283,17 +271,26 @@ void FireworkRocket::Update(float dt) {
 }
 
 void FireworkRocket::Explode() {
-  for (auto& part : part_pink_) {
-    part.active = true;
-    part.pos = part_rocket_.pos;
-  }
+  std::fill(part_pink_.active.begin(), part_pink_.active.begin() + kExplosionPinkCount, ~0);
+  for (int i = 0; i < kExplosionPinkCount; ++i) part_pink_.SetPosition(i, part_rocket_.pos);
 
   is_exploding_ = true;
+  // The firework is shown across the whole screen.
+  audio_->Play(Sound::kExplosion, 0.7f, glm::clamp(-part_rocket_.pos.x / 40.0f, -1.0f, 1.0f));
+}
+
+Firework::Firework(ShaderLibrary& shaders, AudioMixer& audio, GLuint texture, int rocket_count)
+    : particle_shader_(shaders, texture, rocket_count * FireworkRocket::MaxParticles()),
+      audio_(audio) {
+  // Each rocket is random.
+  rockets_.reserve(rocket_count);
+  for (int i = 0; i < rocket_count; ++i) rockets_.emplace_back(audio_);
 }
 
-Firework::Firework(GLuint texture, int rocket_count)
-    : particle_shader_(texture, rocket_count * FireworkRocket::MaxParticles()),
-      rockets_(rocket_count) {}
+void Firework::Reset() {
+  for (auto& rocket : rockets_) rocket = FireworkRocket(audio_);
+  is_done_ = false;
+}
 
 void Firework::Update(float dt) {
   for (auto& rocket : rockets_) {
@@ -301,30 +298,18 @@ void Firework::Update(float dt) {
   }
 }
 
-void Firework::Render(const glm::mat4& view_ignored, const glm::mat4& model_ignored,
-                      const glm::mat4& projection_ignored) const {
-  // We render the firework on top regardless of the camera view used during the game.
-  glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 120.0f));
-  glm::mat4 view = glm::lookAt(glm::vec3(0.0f, -120.0f, -100.0f), glm::vec3(0.0f, 0.0f, 0.0f),
-                               glm::vec3(0.0f, 1.0f, 0.0f));
-  glm::mat4 projection = glm::perspective(glm::radians(45.0f),  // field of view in radians
-                                          4.0f / 3.0f,          // width/height of viewport
-                                          0.1f,                 // near plane
-                                          1000.0f);             // far plane
-
-  std::vector<ParticleShader::Particle> particles;
+void Firework::Snapshot(SceneSnapshot& snapshot) const {
   for (const auto& rocket : rockets_) {
-    rocket.AddParticles(particles);
+    rocket.AddParticles(snapshot.firework_particles);
   }
-
-  particle_shader_.Render(model, view, projection, particles);
 }
 
-bool Firework::ProcessEvent(const SDL_Event& event) {
-  // Any key press or touch event will skip the firework animation.
-  if (event.type == SDL_KEYDOWN || event.type == SDL_FINGERDOWN || event.type == SDL_MOUSEBUTTONDOWN) {
-    is_done_ = true;
-    return true;
-  }
-  return false;
+void Firework::Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4& view,
+                      const glm::mat4& projection) const {
+  // We render the firework on top of the game: move it 120 units along the
+  // camera's view axis (the third row of the view matrix, in world space).
+  const glm::vec3 view_axis(view[0][2], view[1][2], view[2][2]);
+  glm::mat4 firework_model = glm::translate(model, 120.0f * view_axis);
+
+  particle_shader_.Render(firework_model, view, snapshot.firework_particles);
 }
@@ -27,7 +27,9 @@
 #include <memory>
 #include <vector>
 
+#include "AudioMixer.h"
 #include "IObject.h"
+#include "ParticleKernels.h"
 #include "ParticleShader.h"
 
 class Shader;
@@ -35,7 +37,7 @@ class Shader;
 class FireworkRocket {
   // Construction
  public:
-  FireworkRocket();
+  explicit FireworkRocket(AudioMixer& audio);
 
   static unsigned MaxParticles() {
     return kRocketFireCount + kExplosionPinkCount + kExplosionPinkCount * kExplosionFireCount;
@@ -69,37 +71,50 @@ class FireworkRocket {
   };
 
   void Explode();
-  void CreateRocketSpark(Particle& particle);
-
-  std::array<Particle, kRocketFireCount>
-      part_spark_;  // Particle Array (Rocket's propulsion sparks)
-  std::array<Particle, kExplosionPinkCount> part_pink_;  // Explosion's pink particles
-  std::array<Particle, kExplosionPinkCount * kExplosionFireCount>
-      part_fire_;         // Fire generated by the pink particles
-  Particle part_rocket_;  // Single Particle (Rocket)
+  void CreateRocketSpark(int i);
+
+  // Updated by the particle kernels.
+  ParticleArrays part_spark_;  // Rocket's propulsion sparks
+  ParticleArrays part_pink_;   // Explosion's pink particles
+  ParticleArrays part_fire_;   // Fire generated by the pink particles
+  Particle part_rocket_;        // Single Particle (Rocket)
   bool is_exploding_;
+  AudioMixer* audio_;  // A pointer, so that rockets can be assigned.
 };
 
 class Firework : public IObject {
  public:
-  Firework(GLuint texture, int rocket_count = 4);
+  Firework(ShaderLibrary& shaders, AudioMixer& audio, GLuint texture, int rocket_count = 4);
   virtual ~Firework() = default;
 
   bool IsDone() const { return is_done_; }
 
+  // Starts a new show. The firework is created once, ahead of time, so that
+  // game over doesn't create GL objects.
+  void Reset();
+
+  // Ends the show right away.
+  void Skip() { is_done_ = true; }
+
   // Implementation of IObject.
+  const char* GetName() const override { return "firework"; }
+
+  // Explosions play sounds.
+  JobAccess GetUpdateAccess() const override { return {{}, {&audio_}}; }
+
   // Update the object.
   void Update(float fTime) override;
 
+  // Copy the particles of every rocket.
+  void Snapshot(SceneSnapshot& snapshot) const override;
+
   // Render the object.
-  void Render(const glm::mat4& view, const glm::mat4& model,
+  void Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4& view,
               const glm::mat4& projection) const override;
 
-  // Process event.
-  bool ProcessEvent(const SDL_Event& event) override;
-
  private:
   ParticleShader particle_shader_;
+  AudioMixer& audio_;
   std::vector<FireworkRocket> rockets_;
   bool is_done_ = false;
 };
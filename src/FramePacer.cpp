@@ -0,0 +1,89 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+// Seconds between two statistics reports.
+constexpr int kReportInterval = 5;
+// Sleeping is only accurate to about a millisecond: the end of the wait is
+// spent yielding instead.
+constexpr auto kSleepMargin = std::chrono::milliseconds(1);
+
+int FramePacer::GetDisplayRefreshRate(SDL_Window* window) {
+  SDL_DisplayMode mode;
+  int display = SDL_GetWindowDisplayIndex(window);
+  if (display < 0 || SDL_GetCurrentDisplayMode(display, &mode) != 0 || mode.refresh_rate <= 0)
+    return 60;
+  return mode.refresh_rate;
+}
+
+FramePacer::FramePacer(int refresh_rate)
+    : refresh_rate_(refresh_rate),
+      period_(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / refresh_rate))) {
+#ifdef __EMSCRIPTEN__
+  // The browser paces the main loop with requestAnimationFrame.
+  swap_interval_ = 1;
+#else
+  if (SDL_GL_SetSwapInterval(-1) == 0)
+    swap_interval_ = -1;
+  else if (SDL_GL_SetSwapInterval(1) == 0)
+    swap_interval_ = 1;
+  else
+    swap_interval_ = 0;
+#endif
+  std::cout << "Frame pacing: " << refresh_rate_ << " Hz, "
+            << (swap_interval_ < 0   ? "adaptive vsync"
+                : swap_interval_ > 0 ? "vsync"
+                                     : "timer")
+            << std::endl;
+
+  deadline_ = last_present_ = report_start_ = Clock::now();
+}
+
+void FramePacer::WaitForNextFrame() {
+  if (IsVsyncEnabled()) return;
+
+  // Deadlines follow each other by exactly one period, so rounding errors
+  // don't accumulate. If a frame was missed, skip to the next one.
+  deadline_ += period_;
+  Clock::time_point now = Clock::now();
+  if (deadline_ < now) deadline_ = now + period_ - (now - deadline_) % period_;
+
+  std::this_thread::sleep_until(deadline_ - kSleepMargin);
+  while (Clock::now() < deadline_) std::this_thread::yield();
+}
+
+void FramePacer::FramePresented() {
+  Clock::time_point now = Clock::now();
+  float interval = std::chrono::duration<float, std::milli>(now - last_present_).count();
+  last_present_ = now;
+
+  intervals_[history_index_] = interval;
+  history_index_ = (history_index_ + 1) % kHistorySize;
+
+  ++frame_count_;
+  if (interval > 1.5f * GetFramePeriod()) ++late_frame_count_;
+  interval_sum_ += interval;
+  interval_square_sum_ += interval * interval;
+  max_interval_ = std::max(max_interval_, interval);
+
+  if (now - report_start_ >= std::chrono::seconds(kReportInterval)) Report(now);
+}
+
+void FramePacer::Report(Clock::time_point now) {
+  float seconds = std::chrono::duration<float>(now - report_start_).count();
+  double mean = interval_sum_ / frame_count_;
+  double jitter = std::sqrt(std::max(interval_square_sum_ / frame_count_ - mean * mean, 0.0));
+  std::cout << frame_count_ << " frames in " << seconds
+            << " seconds = " << frame_count_ / seconds << " FPS, interval " << mean << " ms +/- "
+            << jitter << " ms (max " << max_interval_ << " ms, " << late_frame_count_
+            << " late)" << std::endl;
+
+  report_start_ = now;
+  frame_count_ = late_frame_count_ = 0;
+  interval_sum_ = interval_square_sum_ = 0.0;
+  max_interval_ = 0.0f;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <chrono>
+
+// Presents frames at the display's refresh rate.
+//
+// Vsync is preferred, adaptive if the driver supports it, so that late frames
+// tear instead of waiting a whole extra refresh. Without vsync, frames are
+// paced by sleeping to fixed deadlines on a high resolution clock. Frame
+// interval jitter is tracked and reported periodically.
+class FramePacer {
+ public:
+  // Refresh rate of the display showing the window, in Hz, or 60 if unknown.
+  static int GetDisplayRefreshRate(SDL_Window* window);
+
+  // Sets the swap interval of the GL context current on the calling thread.
+  explicit FramePacer(int refresh_rate);
+
+  int GetRefreshRate() const { return refresh_rate_; }
+  bool IsVsyncEnabled() const { return swap_interval_ != 0; }
+
+  // Frame period, in milliseconds.
+  float GetFramePeriod() const { return 1000.0f / refresh_rate_; }
+
+  // Sleeps until the next frame is due. Returns immediately when vsync paces
+  // the frames.
+  void WaitForNextFrame();
+
+  // To call right after each buffer swap.
+  void FramePresented();
+
+  // Milliseconds between the last kHistorySize frames, in a ring buffer whose
+  // oldest entry is at GetHistoryIndex().
+  static constexpr int kHistorySize = 120;
+  const std::array<float, kHistorySize>& GetFrameIntervals() const { return intervals_; }
+  int GetHistoryIndex() const { return history_index_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // Prints interval statistics since the last report, and starts a new one.
+  void Report(Clock::time_point now);
+
+  int refresh_rate_;
+  int swap_interval_ = 0;  // -1 adaptive, 1 vsync, 0 none.
+  Clock::duration period_;
+  Clock::time_point deadline_;
+
+  Clock::time_point last_present_;
+  std::array<float, kHistorySize> intervals_ = {};
+  int history_index_ = 0;
+
+  // Statistics since the last report.
+  Clock::time_point report_start_;
+  int frame_count_ = 0;
+  int late_frame_count_ = 0;  // Frames that took more than 1.5 periods.
+  double interval_sum_ = 0.0;
+  double interval_square_sum_ = 0.0;
+  float max_interval_ = 0.0f;
+};
@@ -0,0 +1,26 @@
+#include "FrameUniforms.h"
+
+#include "Lighting.h"
+
+FrameUniforms::FrameUniforms() {
+  glGenBuffers(1, &ubo_);
+  glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  glBindBufferBase(GL_UNIFORM_BUFFER, kFrameUniformsBinding, ubo_);
+}
+
+FrameUniforms::~FrameUniforms() {
+  if (ubo_) glDeleteBuffers(1, &ubo_);
+}
+
+void FrameUniforms::Update(const glm::mat4& view, const glm::mat4& projection) {
+  const Data data = {view, projection, glm::vec4(kLightPosition, 0.0f),
+                     glm::vec4(glm::vec3(kLightAmbient), 0.0f),
+                     glm::vec4(glm::vec3(kLightDiffuse), 0.0f)};
+
+  glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Data), &data);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  glBindBufferBase(GL_UNIFORM_BUFFER, kFrameUniformsBinding, ubo_);
+}
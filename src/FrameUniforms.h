@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#ifdef __EMSCRIPTEN__
+#include <GLES3/gl3.h>
+#else
+#include <GL/glew.h>
+#endif
+
+// Uniform buffer binding point of the per-frame "Frame" block.
+constexpr GLuint kFrameUniformsBinding = 0;
+
+// Camera and lighting data shared by all programs through a std140 uniform
+// block, uploaded once per frame. Members are highp so that the block matches
+// across vertex and fragment stages:
+//
+//   layout(std140) uniform Frame {
+//     highp mat4 view;
+//     highp mat4 projection;
+//     highp vec3 lightPos;
+//     highp vec3 lightAmbient;
+//     highp vec3 lightDiffuse;
+//   };
+class FrameUniforms {
+ public:
+  FrameUniforms();
+  ~FrameUniforms();
+
+  // Uploads the frame data and binds the buffer to kFrameUniformsBinding.
+  void Update(const glm::mat4& view, const glm::mat4& projection);
+
+ private:
+  // Mirrors the std140 layout of the block (vec3 are padded to 16 bytes).
+  struct Data {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 light_position;
+    glm::vec4 light_ambient;
+    glm::vec4 light_diffuse;
+  };
+
+  GLuint ubo_ = 0;
+};
@@ -36,26 +36,60 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <glm/ext/matrix_float4x4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 #include <memory>
+#include <thread>
+#include <vector>
+
+// The simulation ticks at a fixed rate: this one, or the display's refresh
+// rate if higher, so that every frame shows a new state.
+constexpr int kMinSimulationFrequency = 120;
+// Rates while nobody is watching: the game goes on, slowly and without its
+// particle effects, while hidden; frames are drawn less often while unfocused.
+constexpr int kHiddenSimulationFrequency = 10;
+constexpr int kBackgroundFrameRate = 30;
+
+// History kept for rewinding, about 40 minutes at 120 ticks per second.
+constexpr size_t kRewindCapacity = 8 << 20;
+// Ticks gone back per tick while rewinding.
+constexpr int kRewindSpeed = 2;
+
+constexpr glm::vec4 kScoreColor(0.0f, 0.4f, 0.0f, 1.0f);
+constexpr int kMaxScoreDigits = 3;
+constexpr glm::vec4 kOverlayColor(0.3f, 1.0f, 0.3f, 1.0f);
+constexpr glm::vec4 kOverlayBackgroundColor(0.0f, 0.0f, 0.0f, 0.6f);
+
+// The camera never moves.
+static glm::mat4 GetCameraView() {
+  return glm::lookAt(glm::vec3(0.0f, -120.0f, -100.0f), glm::vec3(0.0f, 0.0f, 0.0f),
+                     glm::vec3(0.0f, 1.0f, 0.0f));
+}
 
-#include "Paddle.h"
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
+// High resolution time in milliseconds.
+static double GetMilliseconds() {
+  return SDL_GetPerformanceCounter() * 1000.0 / SDL_GetPerformanceFrequency();
+}
 
-constexpr int kScreenFrequency = 60;  // 60Hz
+// Checkpoint file of F7 and F8.
+static const char* GetStateFileName() {
+  const char* file_name = std::getenv("GLPONG_STATE_FILE");
+  return file_name ? file_name : "glpong.state";
+}
 
-static std::filesystem::path GetResourcePath(const std::string& relative) {
-  const char* appdir = std::getenv("APPDIR");
-  if (!appdir) {
-    // Not running in an AppImage -> fallback to current path
-    return std::filesystem::current_path() / relative;
-  }
-  return std::filesystem::path(appdir) / relative;
+// Threads updating the scene along with the simulation thread. The render
+// thread needs a core too.
+static int GetJobWorkerCount() {
+  if (const char* threads = std::getenv("GLPONG_JOB_THREADS")) return std::max(0, atoi(threads));
+  return std::clamp(static_cast<int>(std::thread::hardware_concurrency()) - 2, 0, 2);
 }
 
 static bool UserInputBoolean() {
@@ -64,47 +98,13 @@ static bool UserInputBoolean() {
   return !input.empty() && tolower(input[0]) == 'y';
 }
 
-// Load Bitmaps And Convert To Textures
-static GLuint LoadGLTextures(const char* filename) {
-  int width, height, channels;
-  unsigned char* data = stbi_load(filename, &width, &height, &channels, 0);
-  if (!data) {
-    std::cerr << "Failed to load image: " << filename << "\n";
-    return 0;
-  }
-
-  GLenum format;
-  if (channels == 1)
-    format = GL_LUMINANCE;
-  else if (channels == 3)
-    format = GL_RGB;
-  else if (channels == 4)
-    format = GL_RGBA;
-  else {
-    stbi_image_free(data);
-    throw std::runtime_error("Unsupported channel count");
-  }
-
-  GLuint gl_texture;
-  glGenTextures(1, &gl_texture);
-
-  // Typical Texture Generation Using Data From The TGA ( CHANGE )
-  glBindTexture(GL_TEXTURE_2D, gl_texture);
-  glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  stbi_image_free(data);
-
-  return gl_texture;
-}
-
-GLPong::GLPong() {
+GLPong::GLPong(GameClock& clock)
+    : jobs_(GetJobWorkerCount()), scene_(jobs_), rewind_(kRewindCapacity), clock_(clock) {
 // initialize SDL
 #ifdef _DEBUG
-  Uint32 flags = SDL_INIT_VIDEO | SDL_INIT_NOPARACHUTE;
+  Uint32 flags = SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER | SDL_INIT_NOPARACHUTE;
 #else
-  Uint32 flags = SDL_INIT_VIDEO;
+  Uint32 flags = SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER;
 #endif
   if (SDL_Init(flags) < 0) {
     std::cerr << "Video initialization failed: " << SDL_GetError() << std::endl;
@@ -124,6 +124,8 @@ GLPong::GLPong() {
     SDL_ShowCursor(SDL_DISABLE);
   }
 #endif
+  // Time to first frame, not counting the question above.
+  start_time_ = GetMilliseconds();
 
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
@@ -160,10 +162,12 @@ GLPong::GLPong() {
 
   // Initialize our window.
   InitGL();
+  SubscribeToInput();
 
   // resize the initial window
   SDL_SetWindowSize(sdl_window_, kWidth, kHeight);
   glViewport(0, 0, kWidth, kHeight);
+  viewport_size_ = glm::ivec2(kWidth, kHeight);
 }
 
 GLPong::~GLPong() {
@@ -173,144 +177,719 @@ GLPong::~GLPong() {
 }
 
 void GLPong::ProcessEvents() {
+  // Touch screens can queue a finger motion per finger per millisecond. Only
+  // the latest motion of each finger is processed, at the place of its first
+  // one in the queue.
+  std::vector<SDL_Event> finger_motions;
+  auto flush_finger_motions = [&] {
+    for (const SDL_Event& motion : finger_motions) ProcessEvent(motion);
+    finger_motions.clear();
+  };
+
   // Handle the events in the queue
-  static SDL_Event sdl_event;
+  SDL_Event sdl_event;
   while (SDL_PollEvent(&sdl_event)) {
-    switch (sdl_event.type) {
-      case SDL_WINDOWEVENT:
-        if (sdl_event.window.event == SDL_WINDOWEVENT_RESIZED)
-          glViewport(0, 0, sdl_event.window.data1, sdl_event.window.data2);
-        break;
+    if (sdl_event.type == SDL_FINGERMOTION) {
+      auto same_finger = std::find_if(
+          finger_motions.begin(), finger_motions.end(), [&](const SDL_Event& motion) {
+            return motion.tfinger.fingerId == sdl_event.tfinger.fingerId;
+          });
+      if (same_finger != finger_motions.end())
+        *same_finger = sdl_event;
+      else
+        finger_motions.push_back(sdl_event);
+      continue;
+    }
+    flush_finger_motions();
+    ProcessEvent(sdl_event);
+    if (!game_is_still_running_) return;
+  }
+  flush_finger_motions();
+}
 
-      case SDL_KEYDOWN:
-        switch (sdl_event.key.keysym.sym) {
+void GLPong::ProcessEvent(const SDL_Event& sdl_event) {
+  // Input only reaches the subscribers of its actions.
+  if (input_.Dispatch(sdl_event)) return;
+
+  switch (sdl_event.type) {
+    case SDL_WINDOWEVENT:
+      switch (sdl_event.window.event) {
+        case SDL_WINDOWEVENT_RESIZED:
+          // Applied by the render thread, which owns the GL context.
+          viewport_size_ = glm::ivec2(sdl_event.window.data1, sdl_event.window.data2);
+          is_frame_requested_ = true;
+          break;
+        case SDL_WINDOWEVENT_EXPOSED:
+          is_frame_requested_ = true;
+          break;
+        case SDL_WINDOWEVENT_FOCUS_GAINED:
+          has_focus_ = true;
+          break;
+        case SDL_WINDOWEVENT_FOCUS_LOST:
+          has_focus_ = false;
+          break;
+        case SDL_WINDOWEVENT_SHOWN:
+        case SDL_WINDOWEVENT_RESTORED:
+        case SDL_WINDOWEVENT_MAXIMIZED:
+          is_visible_ = true;
+          break;
+        case SDL_WINDOWEVENT_HIDDEN:
+        case SDL_WINDOWEVENT_MINIMIZED:
+          is_visible_ = false;
+          break;
+      }
+      break;
+  }
+}
+
+void GLPong::SubscribeToInput() {
+  // Presses, not key repeats, toggle.
+  auto on_press = [this](Action action, std::function<void()> function) {
+    input_.Subscribe(action, [function = std::move(function)](const InputAction& input) {
+      if (input.is_pressed && !input.is_repeat) function();
+    });
+  };
 #ifndef __EMSCRIPTEN__
-          case SDLK_ESCAPE:
-            SDL_Quit();
-            game_is_still_running_ = false;
-            return;
+  on_press(Action::kQuit, [this] { game_is_still_running_ = false; });
 #endif
-          case SDLK_F1: {
-            Uint32 flags = SDL_GetWindowFlags(sdl_window_);
-            if (flags & SDL_WINDOW_FULLSCREEN)
-              SDL_SetWindowFullscreen(sdl_window_, 0);  // back to windowed
-            else
-              SDL_SetWindowFullscreen(sdl_window_, SDL_WINDOW_FULLSCREEN);
-          } break;
-          case SDLK_PAUSE:
-            is_active_ = !is_active_;
-            break;
-        }
-        break;
-    }
+  on_press(Action::kToggleFullscreen, [this] {
+    Uint32 flags = SDL_GetWindowFlags(sdl_window_);
+    if (flags & SDL_WINDOW_FULLSCREEN)
+      SDL_SetWindowFullscreen(sdl_window_, 0);  // back to windowed
+    else
+      SDL_SetWindowFullscreen(sdl_window_, SDL_WINDOW_FULLSCREEN);
+  });
+  on_press(Action::kTogglePerformanceOverlay, [this] {
+    show_performance_overlay_ = !show_performance_overlay_;
+    is_frame_requested_ = true;
+  });
+  on_press(Action::kToggleLighting, [this] {
+    lighting_mode_ =
+        lighting_mode_ == LightingMode::kBaked ? LightingMode::kDynamic : LightingMode::kBaked;
+    is_frame_requested_ = true;
+  });
+  on_press(Action::kToggleLatency, [this] { measure_latency_ = !measure_latency_; });
+  on_press(Action::kPause, [this] { is_active_ = !is_active_; });
+  on_press(Action::kTogglePrediction, [this] {
+    show_prediction_ = !show_prediction_;
+    balls_->SetPredictionShown(show_prediction_);
+  });
+  // The update jobs of the last tick, for Graphviz.
+  on_press(Action::kDumpJobGraph, [this] {
+    const JobGraph& graph = scene_.GetUpdateGraph();
+    std::ofstream file("job_graph.dot");
+    graph.WriteDot(file);
+    std::cout << "Job graph written to job_graph.dot: critical path "
+              << graph.GetCriticalPathTime() << " ms of " << graph.GetTotalTime() << " ms"
+              << std::endl;
+  });
+  // Checkpoint of the game, to come back to or to start other games from.
+  on_press(Action::kSaveState, [this] { SaveStateFile(GetStateFileName()); });
+  on_press(Action::kLoadState, [this] { LoadStateFile(GetStateFileName()); });
+  on_press(Action::kSlowDown, [this] { ChangeTimeScale(false); });
+  on_press(Action::kSpeedUp, [this] { ChangeTimeScale(true); });
+  input_.Subscribe(Action::kRewind, [this](const InputAction& input) {
+    if (input.is_repeat) return;
+    if (input.is_pressed)
+      StartRewind();
+    else
+      StopRewind();
+  });
+  // Any press skips the firework.
+  on_press(Action::kAnyPress, [this] {
+    if (is_firework_running_) firework_->Skip();
+  });
+}
 
-    scene_.ProcessEvent(sdl_event);
-  }
+GLPong::IdleState GLPong::GetIdleState() const {
+  if (!is_active_) return IdleState::kPaused;
+  if (!is_visible_) return IdleState::kHidden;
+  if (!has_focus_) return IdleState::kBackground;
+  return IdleState::kActive;
 }
 
-void GLPong::Draw() {
-  ProcessEvents();
-  if (!is_active_) return;
+void GLPong::UpdateIdleState() {
+  IdleState state = GetIdleState();
+  if (state == idle_state_) return;
 
-  // Game logic update
-  Uint32 cur_ticks = SDL_GetTicks();
-  float dt = (cur_ticks - prev_ticks_) / 1000.0f;
-  prev_ticks_ = cur_ticks;
-  if (dt > 0.3f) dt = 0.0f;
+  balls_->SetTrailEnabled(state != IdleState::kHidden);
+  paddles_->SetPaused(state == IdleState::kPaused);
+  // Show the new state right away, whatever it is.
+  if (state != IdleState::kHidden) is_frame_requested_ = true;
+  idle_state_ = state;
+}
 
+void GLPong::Simulate(float dt) {
+  // Game logic update
+  double update_start = GetMilliseconds();
+  if (is_rewinding_) {
+    Rewind();
+    update_time_ = GetMilliseconds() - update_start;
+    return;
+  }
+  // Nobody would see the firework.
+  if (is_firework_running_ && idle_state_ == IdleState::kHidden) firework_->Skip();
   scene_.Update(dt);
 
-  if (firework_) {
+  if (is_firework_running_) {
     if (firework_->IsDone()) {
       // Once the firework is done, we remove it and reset the game.
-      scene_.RemoveObject(firework_);
-      firework_.reset();
+      scene_.RemoveObject(*firework_);
+      is_firework_running_ = false;
       board_->Reset();
-      scene_.AddObject(ball_);
+      scene_.AddObject(*balls_);
     }
   } else if (board_->IsGameOver()) {
-    firework_ = std::make_shared<Firework>(star_texture_);
-    scene_.AddObject(firework_);
+    firework_->Reset();
+    scene_.AddObject(*firework_);
+    is_firework_running_ = true;
     // We avoid to render the ball during the firework.
-    scene_.RemoveObject(ball_);
+    scene_.RemoveObject(*balls_);
+  }
+  RecordRewind();
+  update_time_ = GetMilliseconds() - update_start;
+  update_critical_path_ = scene_.GetUpdateGraph().GetCriticalPathTime();
+}
+
+bool GLPong::SaveState(GameState& state) const {
+  if (!SaveWorld(world_, state)) return false;
+  board_->Save(state);
+  paddles_->Save(state);
+  balls_->Save(state);
+  if (obstacles_) obstacles_->Save(state);
+  return true;
+}
+
+void GLPong::RestoreState(const GameState& state) {
+  // A game over saved starts its firework again.
+  if (is_firework_running_) {
+    scene_.RemoveObject(*firework_);
+    is_firework_running_ = false;
+    scene_.AddObject(*balls_);
+  }
+  RestoreWorld(state, world_);
+  board_->Restore(state);
+  paddles_->Restore(state);
+  balls_->Restore(state);
+  if (obstacles_) obstacles_->Restore(state);
+  is_frame_requested_ = true;
+}
+
+void GLPong::SaveStateFile(const char* file_name) const {
+  if (!CanSaveState()) {
+    std::cerr << "Games with more than one ball can't be saved" << std::endl;
+    return;
+  }
+  GameState state;
+  if (!SaveState(state)) {
+    std::cerr << "Game can't be saved to " << file_name << std::endl;
+    return;
+  }
+  // Write then rename, so that a failed save leaves the last checkpoint.
+  const std::filesystem::path path = file_name;
+  std::filesystem::path temp_path = path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (file) WriteGameState(file, state);
+    if (!file) {
+      std::cerr << "Game can't be saved to " << file_name << std::endl;
+      return;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temp_path, path, error);
+  if (error) {
+    std::cerr << "Game can't be saved to " << file_name << ": " << error.message() << std::endl;
+    return;
   }
+  std::cout << "Game saved to " << file_name << std::endl;
+}
 
-  // Render scene
-  if (cur_ticks - last_draw_ticks_ > 1000 / kScreenFrequency) {
-    last_draw_ticks_ = cur_ticks;
-    DrawGLScene();
-    SDL_GL_SwapWindow(sdl_window_);
+bool GLPong::LoadStateFile(const char* file_name) {
+  // The network match decides.
+  if (net_play_) return false;
+  // The saved balls wouldn't match those of the world.
+  if (!CanSaveState()) {
+    std::cerr << "Games with more than one ball can't be loaded" << std::endl;
+    return false;
   }
+  GameState state;
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file || !ReadGameState(file, state)) {
+    std::cerr << "No game to load from " << file_name << std::endl;
+    return false;
+  }
+  RestoreState(state);
+  std::cout << "Game loaded from " << file_name << std::endl;
+  return true;
+}
 
-  // Gather our frames per second
-  DrawFPS();
+void GLPong::RecordRewind() {
+  // The network match can't go back.
+  if (net_play_ || !CanSaveState()) return;
+  if (SaveState(rewind_state_))
+    rewind_.Record(rewind_state_);
+  else
+    rewind_.Clear();
+}
+
+void GLPong::StartRewind() {
+  if (!CanSaveState()) {
+    std::cerr << "Games with more than one ball can't be rewound" << std::endl;
+    return;
+  }
+  if (net_play_ || rewind_.IsEmpty()) return;
+  is_rewinding_ = true;
+  rewind_tick_ = rewind_.GetLastTick();
+}
+
+void GLPong::Rewind() {
+  rewind_tick_ = std::max(rewind_tick_ - kRewindSpeed, rewind_.GetFirstTick());
+  GameState state;
+  if (rewind_.Seek(rewind_tick_, state)) RestoreState(state);
+}
+
+void GLPong::StopRewind() {
+  if (!is_rewinding_) return;
+  is_rewinding_ = false;
+  rewind_.Truncate(rewind_tick_);
+}
+
+void GLPong::ChangeTimeScale(bool faster) {
+  // The network match goes at the pace of both players.
+  if (net_play_) return;
+  if (time_scale_ == kUnlimitedTimeScale) {
+    // Only from GLPONG_TIME_SCALE: kept by speeding up, paced again by slowing down.
+    if (!faster) time_scale_ = kMaxTimeScale;
+  } else {
+    time_scale_ = std::clamp(faster ? time_scale_ * 2.0 : time_scale_ / 2.0, kMinTimeScale,
+                             kMaxTimeScale);
+  }
+  paddles_->SetTimeScale(time_scale_);
+  std::cout << "Time scale: " << time_scale_ << std::endl;
+}
+
+void GLPong::PublishSnapshot() {
+  // Hand the new state over to the renderer.
+  SceneSnapshot& snapshot = snapshots_.GetWriteBuffer();
+  snapshot.Clear();
+  scene_.Snapshot(snapshot);
+  snapshot.lighting_mode = lighting_mode_;
+  snapshot.show_performance_overlay = show_performance_overlay_;
+  snapshot.measure_latency = measure_latency_;
+  snapshot.viewport_size = viewport_size_;
+  snapshot.update_time = update_time_;
+  snapshot.update_critical_path = update_critical_path_;
+  snapshots_.Publish();
+  is_frame_requested_ = false;
+  ticks_since_snapshot_ = 0;
+
+#ifndef __EMSCRIPTEN__
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    has_new_snapshot_ = true;
+  }
+  snapshot_published_.notify_one();
+#endif
+}
+
+bool GLPong::RenderFrame() {
+  if (!snapshots_.Acquire()) return false;
+  const SceneSnapshot& snapshot = snapshots_.GetReadBuffer();
+
+  double frame_start = GetMilliseconds();
+
+  if (texture_loader_ && texture_loader_->Upload()) {
+    std::cout << "Textures ready after " << static_cast<int>(frame_start - start_time_) << " ms ("
+              << texture_loader_->GetCachedCount() << " from cache)" << std::endl;
+    texture_loader_.reset();
+  }
+
+  if (snapshot.viewport_size != current_viewport_size_) {
+    current_viewport_size_ = snapshot.viewport_size;
+    glViewport(0, 0, current_viewport_size_.x, current_viewport_size_.y);
+    hud_->SetViewportSize(current_viewport_size_.x, current_viewport_size_.y);
+  }
+
+  DrawGLScene(snapshot);
+  render_time_ = GetMilliseconds() - frame_start;
+  SDL_GL_SwapWindow(sdl_window_);
+  frame_pacer_->FramePresented();
+  if (!has_presented_) {
+    has_presented_ = true;
+    std::cout << "First frame after " << static_cast<int>(GetMilliseconds() - start_time_) << " ms"
+              << std::endl;
+  }
+
+  // Time from the paddle inputs shown by this frame to the end of its swap.
+  for (const SceneSnapshot::PaddleState& paddle : snapshot.paddles) {
+    Uint32 input_timestamp = PaddleSystem::TakeDrawnInputTimestamp(*paddle.latch);
+    if (input_timestamp && snapshot.measure_latency)
+      input_latency_.Add(static_cast<Sint32>(SDL_GetTicks() - input_timestamp));
+  }
+  return true;
 }
 
-bool GLPong::Run() {
-  // Main loop
-  last_draw_ticks_ = prev_ticks_ = SDL_GetTicks();
 #ifdef __EMSCRIPTEN__
-  emscripten_set_main_loop_arg([](void* arg) { static_cast<GLPong*>(arg)->Draw(); }, this,
-                               /*fps=*/0, /*simulate_infinite_loop=*/1);
+void GLPong::Draw() {
+  ProcessEvents();
+  UpdateIdleState();
+
+  const double time = clock_.GetTime();
+  double dt = time - prev_time_;
+  prev_time_ = time;
+  if (dt > 0.3) dt = 0.0;
+
+  // Browsers already stop calling us in hidden tabs, and throttle the
+  // animation frames of background ones.
+  switch (idle_state_) {
+    case IdleState::kActive:
+    case IdleState::kBackground:
+      SimulateFor(dt);
+      PublishSnapshot();
+      break;
+    case IdleState::kHidden:
+      SimulateFor(dt);
+      break;
+    case IdleState::kPaused:
+      if (is_frame_requested_) PublishSnapshot();
+      break;
+  }
+  RenderFrame();
+}
+
+void GLPong::SimulateFor(double real_time) {
+  const double tick = 1.0 / simulation_frequency_;
+  if (time_scale_ == kUnlimitedTimeScale) {
+    // The browser calls us once per frame: simulate for most of it.
+    const double deadline = clock_.GetTime() + 0.8 * frame_pacer_->GetFramePeriod() / 1000.0;
+    do Simulate(tick);
+    while (clock_.GetTime() < deadline);
+    return;
+  }
+  // Fast-forwarded, in several ticks no longer than the frame, so that the
+  // balls don't leap over the paddles.
+  const double time = real_time * time_scale_;
+  const double max_tick = std::max(tick, real_time);
+  const int tick_count = std::max(1, static_cast<int>(std::ceil(time / max_tick)));
+  for (int i = 0; i < tick_count; ++i) Simulate(static_cast<float>(time / tick_count));
+}
 #else
+void GLPong::SimulationLoop() {
+  const double tick = 1.0 / simulation_frequency_;
+  const double hidden_tick = 1.0 / kHiddenSimulationFrequency;
+  const int background_ticks_per_frame = std::max(1, simulation_frequency_ / kBackgroundFrameRate);
+
+  TickPacer pacer(clock_);
   while (game_is_still_running_) {
-    Draw();
+    ProcessEvents();
+    UpdateIdleState();
 
-    if (is_active_)
-      SDL_Delay(2);
-    else
-      SDL_Delay(100);
+    switch (idle_state_) {
+      case IdleState::kActive:
+        Simulate(1.0f / simulation_frequency_);
+        PublishSnapshot();
+        break;
+      case IdleState::kBackground:
+        Simulate(1.0f / simulation_frequency_);
+        if (++ticks_since_snapshot_ >= background_ticks_per_frame) PublishSnapshot();
+        break;
+      case IdleState::kHidden:
+        Simulate(1.0f / kHiddenSimulationFrequency);
+        break;
+      case IdleState::kPaused:
+        if (is_frame_requested_) PublishSnapshot();
+        // Nothing to do until something happens.
+        SDL_WaitEvent(nullptr);
+        pacer.Restart();
+        continue;
+    }
+
+    // Steady tick rate, whatever the renderer is doing.
+    pacer.ScheduleNext(idle_state_ == IdleState::kHidden ? hidden_tick : tick, time_scale_);
+
+    // Until then, handle input as soon as it arrives: paddles publish their
+    // new motion to the render thread right away. A new idle state applies
+    // at once.
+    pacer.WaitForNextTick([this] {
+      ProcessEvents();
+      return game_is_still_running_ && GetIdleState() == idle_state_;
+    });
   }
-#endif
 
-  // End
-  return true;
+  // Let the render thread see that the game is over.
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    game_is_still_running_ = false;
+  }
+  snapshot_published_.notify_one();
 }
 
-void GLPong::DrawFPS() {
-  static int frames = 0;
-  static Uint32 start_ticks = SDL_GetTicks();
-  Uint32 current_ticks = SDL_GetTicks();
+void GLPong::RenderLoop() {
+  SDL_GL_MakeCurrent(sdl_window_, gl_context_);
+  // The swap interval belongs to the context.
+  frame_pacer_ = std::make_unique<FramePacer>(refresh_rate_);
 
-  frames++;
-  if (current_ticks - start_ticks >= 5000) {
-    GLfloat seconds = (current_ticks - start_ticks) / 1000.0f;
-    GLfloat fps = frames / seconds;
-    std::cout << frames << " frames in " << seconds << " seconds = " << fps << " FPS" << std::endl;
-    start_ticks = current_ticks;
-    frames = 0;
+  while (game_is_still_running_) {
+    // Sleeps for as long as there is nothing new to show: while hidden or
+    // paused.
+    WaitForSnapshot();
+    frame_pacer_->WaitForNextFrame();
+    RenderFrame();
   }
+
+  SDL_GL_MakeCurrent(sdl_window_, nullptr);
+}
+
+void GLPong::WaitForSnapshot() {
+  std::unique_lock<std::mutex> lock(snapshot_mutex_);
+  snapshot_published_.wait(lock, [this] { return has_new_snapshot_ || !game_is_still_running_; });
+  has_new_snapshot_ = false;
+}
+#endif
+
+bool GLPong::Run() {
+  // Main loop
+  refresh_rate_ = FramePacer::GetDisplayRefreshRate(sdl_window_);
+  simulation_frequency_ = std::max(kMinSimulationFrequency, refresh_rate_);
+#ifdef __EMSCRIPTEN__
+  // WebGL contexts belong to the browser's main thread: simulate and render
+  // in turn, once per animation frame.
+  frame_pacer_ = std::make_unique<FramePacer>(refresh_rate_);
+  prev_time_ = clock_.GetTime();
+  emscripten_set_main_loop_arg([](void* arg) { static_cast<GLPong*>(arg)->Draw(); }, this,
+                               /*fps=*/0, /*simulate_infinite_loop=*/1);
+#else
+  // Events and simulation stay on this thread, the one that created the
+  // window, while the render thread takes the GL context over.
+  SDL_GL_MakeCurrent(sdl_window_, nullptr);
+  std::thread render_thread(&GLPong::RenderLoop, this);
+  SimulationLoop();
+  render_thread.join();
+
+  // GL objects are deleted on this thread.
+  SDL_GL_MakeCurrent(sdl_window_, gl_context_);
+#endif
+
+  // End
+  return true;
 }
 
-void GLPong::DrawGLScene() {
+void GLPong::DrawGLScene(const SceneSnapshot& snapshot) {
   // Clear the screen and the depth buffer.
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
   glm::mat4 model = glm::mat4(1.0f);
 
-  glm::mat4 view = glm::lookAt(glm::vec3(0.0f, -120.0f, -100.0f), glm::vec3(0.0f, 0.0f, 0.0f),
-                               glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::mat4 view = GetCameraView();
 
   glm::mat4 projection = glm::perspective(glm::radians(45.0f),  // field of view in radians
                                           4.0f / 3.0f,          // width/height of viewport
                                           0.1f,                 // near plane
                                           1000.0f);             // far plane
 
+  // Shared by every program through the "Frame" uniform block.
+  frame_uniforms_->Update(view, projection);
+
   // Scene manager
-  scene_.Render(model, view, projection);
+  scene_.Render(snapshot, model, view, projection);
+
+  DrawHud(snapshot, view, projection);
+}
+
+void GLPong::DrawHud(const SceneSnapshot& snapshot, const glm::mat4& view,
+                     const glm::mat4& projection) {
+  auto to_canvas = [&](const glm::vec3& position) {
+    glm::vec4 clip = projection * view * glm::vec4(position, 1.0f);
+    return glm::vec2((clip.x / clip.w + 1.0f) * 0.5f * Hud::kCanvasWidth,
+                     (1.0f - clip.y / clip.w) * 0.5f * Hud::kCanvasHeight);
+  };
+
+  // Scores, where they would be above the board. They are cached and only
+  // redrawn when they change.
+  if (snapshot.board.score_revision != hud_score_revision_) {
+    hud_score_revision_ = snapshot.board.score_revision;
+    hud_scores_ = {snapshot.board.right_score, snapshot.board.left_score};
+    for (auto& layer : score_layers_) layer->Invalidate();
+  }
+  for (bool left_player : {true, false}) {
+    glm::vec3 anchor = Board::GetScoreAnchor(left_player);
+    glm::vec2 top_right = to_canvas(anchor);
+    glm::vec2 bottom_right = to_canvas(anchor - glm::vec3(0.0f, Board::GetScoreHeight(), 0.0f));
+    glm::vec2 size(0.0f, bottom_right.y - top_right.y);
+    size.x = Hud::MeasureText(std::string(kMaxScoreDigits, '0'), size.y);
+    hud_->AddLayer(*score_layers_[left_player], top_right - glm::vec2(size.x, 0.0f), size);
+  }
+
+  if (snapshot.show_performance_overlay) DrawPerformanceOverlay(snapshot);
+
+  hud_->Render();
+}
+
+void GLPong::DrawPerformanceOverlay(const SceneSnapshot& snapshot) {
+  constexpr float kLineHeight = 14.0f;
+  constexpr float kGraphHeight = 60.0f;
+  constexpr float kGraphScale = kGraphHeight / 50.0f;  // Pixels per millisecond.
+  constexpr float kBarWidth = 2.0f;
+  const auto& frame_times = frame_pacer_->GetFrameIntervals();
+  const float frame_period = frame_pacer_->GetFramePeriod();
+  const bool is_networked = snapshot.resimulated_ticks >= 0;
+  const int line_count = is_networked ? 6 : 5;
+  const glm::vec2 origin(8.0f,
+                         Hud::kCanvasHeight - 8.0f - line_count * kLineHeight - kGraphHeight);
+
+  hud_->AddRect(origin - glm::vec2(4.0f),
+                glm::vec2(frame_times.size() * kBarWidth, line_count * kLineHeight + kGraphHeight) +
+                    glm::vec2(8.0f),
+                kOverlayBackgroundColor);
+
+  // Frame time graph, oldest frame on the left, with a line at the refresh
+  // period. Late frames are red.
+  const glm::vec2 graph_bottom = origin + glm::vec2(0.0f, kGraphHeight);
+  for (int i = 0; i < static_cast<int>(frame_times.size()); ++i) {
+    float frame_time = frame_times[(frame_pacer_->GetHistoryIndex() + i) % frame_times.size()];
+    float height = std::min(frame_time * kGraphScale, kGraphHeight);
+    glm::vec4 color =
+        frame_time > 1.5f * frame_period ? glm::vec4(1.0f, 0.3f, 0.3f, 1.0f) : kOverlayColor;
+    hud_->AddRect(graph_bottom + glm::vec2(i * kBarWidth, -height),
+                  glm::vec2(kBarWidth * 0.5f, height), color);
+  }
+  hud_->AddRect(graph_bottom - glm::vec2(0.0f, frame_period * kGraphScale),
+                glm::vec2(frame_times.size() * kBarWidth, 1.0f),
+                glm::vec4(1.0f, 1.0f, 1.0f, 0.5f));
+
+  // Update/render split and particle counts.
+  int particle_count = snapshot.ball_particles.size() + snapshot.firework_particles.size();
+  char line[32];
+  glm::vec2 position = graph_bottom + glm::vec2(0.0f, 4.0f);
+  float frame_time_sum = 0.0f;
+  for (float frame_time : frame_times) frame_time_sum += frame_time;
+  snprintf(line, sizeof(line), "FPS %5.1f",
+           frame_time_sum > 0.0f ? 1000.0f * frame_times.size() / frame_time_sum : 0.0f);
+  hud_->AddText(line, position, kLineHeight - 2.0f, kOverlayColor);
+  position.y += kLineHeight;
+  snprintf(line, sizeof(line), "UPd %5.2f", snapshot.update_time);
+  hud_->AddText(line, position, kLineHeight - 2.0f, kOverlayColor);
+  position.y += kLineHeight;
+  // Critical path of the update jobs.
+  snprintf(line, sizeof(line), "PAtH %5.2f", snapshot.update_critical_path);
+  hud_->AddText(line, position, kLineHeight - 2.0f, kOverlayColor);
+  position.y += kLineHeight;
+  snprintf(line, sizeof(line), "rNd %5.2f", render_time_);
+  hud_->AddText(line, position, kLineHeight - 2.0f, kOverlayColor);
+  position.y += kLineHeight;
+  snprintf(line, sizeof(line), "PArt %5d", particle_count);
+  hud_->AddText(line, position, kLineHeight - 2.0f, kOverlayColor);
+  if (!is_networked) return;
+  // Rollbacks: ticks played again and their time.
+  position.y += kLineHeight;
+  snprintf(line, sizeof(line), "rOLL %2d %5.2f", snapshot.resimulated_ticks,
+           snapshot.resimulation_time);
+  hud_->AddText(line, position, kLineHeight - 2.0f, kOverlayColor);
+}
+
+#ifndef __EMSCRIPTEN__
+std::unique_ptr<NetPlay> GLPong::CreateNetPlay() {
+  const char* net = std::getenv("GLPONG_NET");
+  if (!net) return nullptr;
+  char side[8];
+  char remote_host[256];
+  unsigned local_port, remote_port;
+  if (sscanf(net, "%7[^:]:%u:%255[^:]:%u", side, &local_port, remote_host, &remote_port) != 4 ||
+      (strcmp(side, "left") != 0 && strcmp(side, "right") != 0)) {
+    std::cerr << "GLPONG_NET must be left|right:<local port>:<remote host>:<remote port>"
+              << std::endl;
+    return nullptr;
+  }
+
+  LinkConditions conditions;
+  if (const char* latency = std::getenv("GLPONG_NET_LATENCY")) conditions.latency = atof(latency);
+  if (const char* jitter = std::getenv("GLPONG_NET_JITTER")) conditions.jitter = atof(jitter);
+  if (const char* loss = std::getenv("GLPONG_NET_LOSS")) conditions.loss = atof(loss);
+  const char* delay = std::getenv("GLPONG_NET_DELAY");
+  const char* seed = std::getenv("GLPONG_NET_SEED");
+  std::cout << "Network play on the " << side << ", port " << local_port << ", against "
+            << remote_host << ":" << remote_port << std::endl;
+  return std::make_unique<NetPlay>(
+      world_, *board_, *audio_, input_,
+      std::make_unique<UdpTransport>(local_port, remote_host, remote_port, conditions),
+      strcmp(side, "left") == 0, seed ? strtoull(seed, nullptr, 10) : 0,
+      delay ? std::max(0, atoi(delay)) : 2);
 }
+#endif
 
 // All Setup For OpenGL Goes Here
 void GLPong::InitGL() {
-  particle_texture_ = LoadGLTextures(GetResourcePath("particle.png").c_str());
-  star_texture_ = LoadGLTextures(GetResourcePath("small_blur_star.png").c_str());
+  // Decoded while the rest is set up, and uploaded by the first frames.
+  texture_loader_ = std::make_unique<TextureLoader>();
+  particle_texture_ = texture_loader_->Load("particle.png");
+  star_texture_ = texture_loader_->Load("small_blur_star.png");
+  frame_uniforms_ = std::make_unique<FrameUniforms>();
+
+  // Build all programs up front: they compile in parallel, and the firework
+  // doesn't have to compile anything at game over.
+  shader_library_ = std::make_unique<ShaderLibrary>();
+  shader_library_->Preload(AllShaderSources());
+
+  hud_ = std::make_unique<Hud>(*shader_library_);
+  for (bool left_player : {true, false}) {
+    score_layers_[left_player] =
+        std::make_unique<HudLayer>([this, left_player](Hud& hud, const glm::vec2& size) {
+          // Right aligned.
+          std::string score = std::to_string(hud_scores_[left_player]);
+          hud.AddText(score, {size.x - Hud::MeasureText(score, size.y), 0.0f}, size.y,
+                      kScoreColor);
+        });
+  }
 
-  auto paddle_left = std::make_shared<Paddle>(true);
-  auto paddle_right = std::make_shared<Paddle>(false);
-  board_ = std::make_shared<Board>();
-  ball_ = std::make_shared<Ball>(board_, paddle_left, paddle_right, particle_texture_);
-  paddle_left->TrackBall(ball_);
-  paddle_right->TrackBall(ball_);
+  audio_ = std::make_unique<AudioMixer>();
+
+  board_ = std::make_unique<Board>(*shader_library_, *audio_, GetCameraView());
+  // Per-pixel lighting can still be chosen, for comparison or faster GPUs.
+  if (std::getenv("GLPONG_DYNAMIC_LIGHTING")) lighting_mode_ = LightingMode::kDynamic;
+  paddles_ = std::make_unique<PaddleSystem>(*shader_library_, world_, input_, GetCameraView());
+  // From 0 to 1.
+  if (const char* difficulty = std::getenv("GLPONG_AI_DIFFICULTY"))
+    paddles_->SetAiDifficulty(atof(difficulty));
+  // Multi-ball mode, to stress the physics and the rendering. Not in network
+  // play, which has one ball.
+  int ball_count = 1;
+  if (const char* balls = std::getenv("GLPONG_BALLS")) ball_count = std::max(1, atoi(balls));
+#ifndef __EMSCRIPTEN__
+  if (std::getenv("GLPONG_NET")) ball_count = 1;
+#endif
+  balls_ = std::make_unique<BallSystem>(*shader_library_, world_, *audio_, *board_,
+                                        particle_texture_, ball_count);
+  if (ball_count > GameState::kMaxBalls)
+    std::cout << ball_count << " balls: saving, loading and rewinding are off" << std::endl;
+  // Obstacles on the board, from a layout file. Not in network play either.
+  const char* obstacle_layout = std::getenv("GLPONG_OBSTACLES");
+#ifndef __EMSCRIPTEN__
+  if (std::getenv("GLPONG_NET")) obstacle_layout = nullptr;
+#endif
+  if (obstacle_layout) {
+    obstacles_ = std::make_unique<ObstacleSystem>(*shader_library_, particle_texture_,
+                                                  LoadObstacleLayout(obstacle_layout));
+    balls_->SetObstacles(&obstacles_->GetField());
+  }
+  // Created up front, with its GL objects, and only reset at game over.
+  firework_ = std::make_unique<Firework>(*shader_library_, *audio_, star_texture_);
+  measure_latency_ = std::getenv("GLPONG_MEASURE_LATENCY") != nullptr;
+
+  Entity left_paddle = paddles_->Spawn(true);
+  Entity right_paddle = paddles_->Spawn(false);
+  // The AI follows the first ball.
+  paddles_->TrackBall(balls_->Spawn(left_paddle, right_paddle));
+  for (int i = 1; i < ball_count; ++i) balls_->Spawn(left_paddle, right_paddle);
+#ifndef __EMSCRIPTEN__
+  net_play_ = CreateNetPlay();
+#endif
+  // Slow motion, fast-forward, or as fast as possible, e.g. for soak tests
+  // between AI players. Network play goes at the pace of both players.
+  const char* time_scale = std::getenv("GLPONG_TIME_SCALE");
+  if (time_scale && !net_play_) time_scale_ = ParseTimeScale(time_scale);
+  paddles_->SetTimeScale(time_scale_);
 
   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);  // Black Background
   glClearDepth(1.0f);
@@ -320,8 +899,14 @@ void GLPong::InitGL() {
   glDisable(GL_TEXTURE_2D);
 
   // Scene manager.
-  scene_.AddObject(board_);
-  scene_.AddObject(paddle_left);
-  scene_.AddObject(paddle_right);
-  scene_.AddObject(ball_);
+  scene_.AddObject(*board_);
+  // Moves the paddles before they are published.
+  if (net_play_) scene_.AddObject(*net_play_);
+  scene_.AddObject(*paddles_);
+  // Moved before the balls bounce off them.
+  if (obstacles_) scene_.AddObject(*obstacles_);
+  scene_.AddObject(*balls_);
+
+  // Resumes a saved game, e.g. a checkpoint of a soak test.
+  if (const char* file_name = std::getenv("GLPONG_RESUME")) LoadStateFile(file_name);
 }
@@ -24,38 +24,182 @@
 
 #include <SDL2/SDL.h>
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
-#include "Ball.h"
+#include "AudioMixer.h"
+#include "BallSystem.h"
 #include "Board.h"
 #include "Firework.h"
+#include "FramePacer.h"
+#include "FrameUniforms.h"
+#include "GameClock.h"
+#include "GameState.h"
+#include "Hud.h"
+#include "InputRouter.h"
+#include "LatencyHistogram.h"
+#include "Lighting.h"
+#include "NetPlay.h"
+#include "ObstacleSystem.h"
+#include "PaddleSystem.h"
+#include "RewindBuffer.h"
+#include "SceneSnapshot.h"
 #include "SceneManager.h"
+#include "ShaderLibrary.h"
+#include "TextureLoader.h"
+#include "TripleBuffer.h"
+#include "World.h"
 
 class GLPong {
  public:
-  GLPong();
+  // The game loop paces itself on clock, e.g. a FakeClock to run as fast as
+  // possible.
+  explicit GLPong(GameClock& clock);
   ~GLPong();
 
   bool Run();
 
  private:
+  // How much work the game does, from the Pause key and the window state.
+  enum class IdleState {
+    kActive,      // Simulates and renders at full rate.
+    kBackground,  // Unfocused: simulates at full rate, renders at a lower rate.
+    kHidden,      // Minimized or hidden: simulates slowly without effects, doesn't render.
+    kPaused,      // Paused: blocks on events, renders only when asked to.
+  };
+
+  // Handles queued events.
   void ProcessEvents();
+  void ProcessEvent(const SDL_Event& sdl_event);
+  // Subscribes to the game's own actions, e.g. pause or full screen.
+  void SubscribeToInput();
+
+  // Idle state matching the current pause, focus and visibility flags.
+  IdleState GetIdleState() const;
+  // Switches to GetIdleState() if it changed.
+  void UpdateIdleState();
+
+  // Advances the game.
+  void Simulate(float dt);
+
+  // Whether the game fits in a GameState: not in multi-ball mode, where
+  // saving, loading and rewinding are off.
+  bool CanSaveState() const { return world_.balls.GetCount() <= GameState::kMaxBalls; }
+  // Copies the game, see GameState. Returns false if there are too many balls
+  // to save.
+  bool SaveState(GameState& state) const;
+  void RestoreState(const GameState& state);
+  void SaveStateFile(const char* file_name) const;
+  // Returns false if the file can't be read, or during network play.
+  bool LoadStateFile(const char* file_name);
+
+  // Records the tick just simulated for rewinding.
+  void RecordRewind();
+  // While rewinding, goes back in time instead of simulating. Playing again
+  // forgets the ticks rewound.
+  void StartRewind();
+  void Rewind();
+  void StopRewind();
+
+  // Halves or doubles the time scale, between kMinTimeScale and kMaxTimeScale.
+  void ChangeTimeScale(bool faster);
+
+  // Publishes a snapshot of the game for rendering.
+  void PublishSnapshot();
+
+  // Draws and presents the latest snapshot. Returns false if no snapshot was
+  // published since the last frame.
+  bool RenderFrame();
+
+#ifdef __EMSCRIPTEN__
+  // One iteration of the browser's main loop: simulates, then renders.
   void Draw();
-  void DrawFPS();
-  void DrawGLScene();
+  // Simulates real_time seconds of the clock at the time scale.
+  void SimulateFor(double real_time);
+#else
+  // Handles events and simulates at a fixed rate, on the main thread.
+  void SimulationLoop();
+  // Owns the GL context and renders snapshots, on its own thread.
+  void RenderLoop();
+  // Blocks the render thread until a snapshot is published or the game ends.
+  void WaitForSnapshot();
+#endif
+
+  void DrawGLScene(const SceneSnapshot& snapshot);
+  void DrawHud(const SceneSnapshot& snapshot, const glm::mat4& view, const glm::mat4& projection);
+  void DrawPerformanceOverlay(const SceneSnapshot& snapshot);
   void InitGL();
+#ifndef __EMSCRIPTEN__
+  // Network play, if GLPONG_NET asks for it.
+  std::unique_ptr<NetPlay> CreateNetPlay();
+#endif
   void UpdateScene(float t);
 
+  std::unique_ptr<AudioMixer> audio_;  // Outlives the objects playing sounds.
+  World world_;                        // Outlives the systems.
+  InputRouter input_;                  // Outlives the subscribers.
+  JobSystem jobs_;                     // Runs the scene updates.
   SceneManager scene_;
-  std::shared_ptr<Board> board_;
-  std::shared_ptr<Firework> firework_;
-  std::shared_ptr<Ball> ball_;
+  std::unique_ptr<Board> board_;
+  std::unique_ptr<Firework> firework_;
+  std::unique_ptr<PaddleSystem> paddles_;
+  std::unique_ptr<BallSystem> balls_;
+  std::unique_ptr<ObstacleSystem> obstacles_;  // Only with a layout.
+  std::unique_ptr<NetPlay> net_play_;  // Only in network play.
+  bool is_firework_running_ = false;
+  RewindBuffer rewind_;
+  GameState rewind_state_{};  // Reused to record.
+  bool is_rewinding_ = false;  // While Backspace is held.
+  int rewind_tick_ = 0;
+  std::unique_ptr<FrameUniforms> frame_uniforms_;
+  std::unique_ptr<ShaderLibrary> shader_library_;
+  std::unique_ptr<Hud> hud_;
+  std::unique_ptr<TextureLoader> texture_loader_;  // Until every texture is uploaded.
+  GameClock& clock_;
+  TripleBuffer<SceneSnapshot> snapshots_;
   SDL_Window* sdl_window_;
   SDL_GLContext gl_context_;
   GLuint particle_texture_;
   GLuint star_texture_;
-  bool game_is_still_running_ = true;  // main loop variable
-  bool is_active_ = true;              // whether or not the window is active
-  Uint32 prev_ticks_;
-  Uint32 last_draw_ticks_;
+  std::atomic<bool> game_is_still_running_{true};  // main loop variable
+  int refresh_rate_ = 60;                          // Hz
+  int simulation_frequency_ = 60;                  // Hz
+  double start_time_ = 0.0;                        // Milliseconds.
+
+  // Simulation thread state, copied into snapshots.
+  bool is_active_ = true;  // Toggled with Pause.
+  bool has_focus_ = true;
+  bool is_visible_ = true;  // Neither minimized nor hidden.
+  IdleState idle_state_ = IdleState::kActive;
+  bool is_frame_requested_ = false;  // Something to redraw while paused.
+  int ticks_since_snapshot_ = 0;
+  float update_time_ = 0.0f;  // Milliseconds spent in the last Simulate().
+  float update_critical_path_ = 0.0f;  // Milliseconds.
+  double prev_time_ = 0.0;   // Of the clock, at the last Draw().
+  double time_scale_ = 1.0;  // From GLPONG_TIME_SCALE, changed with [ and ].
+  LightingMode lighting_mode_ = LightingMode::kBaked;  // Toggled with F3.
+  bool show_performance_overlay_ = false;              // Toggled with F2.
+  bool measure_latency_ = false;                       // Toggled with F4.
+  bool show_prediction_ = false;                       // Toggled with F6.
+  glm::ivec2 viewport_size_{0, 0};
+
+#ifndef __EMSCRIPTEN__
+  // Wakes the render thread up.
+  std::mutex snapshot_mutex_;
+  std::condition_variable snapshot_published_;
+  bool has_new_snapshot_ = false;
+#endif
+
+  // Render thread state.
+  glm::ivec2 current_viewport_size_{0, 0};
+  std::array<std::unique_ptr<HudLayer>, 2> score_layers_;  // Right, left player.
+  std::array<int, 2> hud_scores_ = {};                     // Right, left player.
+  int hud_score_revision_ = -1;
+  std::unique_ptr<FramePacer> frame_pacer_;
+  float render_time_ = 0.0f;  // Milliseconds submitting the last frame.
+  bool has_presented_ = false;
+  LatencyHistogram input_latency_{"Input to swap latency"};
 };
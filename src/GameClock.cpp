@@ -0,0 +1,58 @@
+#include "GameClock.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// Late by more than this, in seconds, ticks restart from now.
+constexpr double kMaxTickDelay = 0.25;
+
+SystemClock::SystemClock()
+    : origin_(SDL_GetPerformanceCounter()),
+      seconds_per_count_(1.0 / SDL_GetPerformanceFrequency()) {}
+
+double SystemClock::GetTime() const {
+  return (SDL_GetPerformanceCounter() - origin_) * seconds_per_count_;
+}
+
+void SystemClock::SleepUntil(double time) {
+  const double wait = time - GetTime();
+  if (wait > 0.0) std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+}
+
+bool SystemClock::WaitEventUntil(double time) {
+  const int milliseconds = static_cast<int>(std::floor((time - GetTime()) * 1000.0));
+  if (milliseconds <= 0) return false;
+  return SDL_WaitEventTimeout(nullptr, milliseconds) != 0;
+}
+
+void TickPacer::ScheduleNext(double tick_length, double time_scale) {
+  next_tick_ += tick_length / time_scale;
+  const double now = clock_.GetTime();
+  if (now - next_tick_ > kMaxTickDelay) next_tick_ = now;
+}
+
+void TickPacer::WaitForNextTick(const std::function<bool()>& on_events) {
+  // Waiting for events is only accurate to a millisecond: sleep the rest.
+  while (next_tick_ - clock_.GetTime() >= 0.001) {
+    if (!clock_.WaitEventUntil(next_tick_)) continue;
+    if (!on_events()) {
+      Restart();
+      return;
+    }
+  }
+  clock_.SleepUntil(next_tick_);
+}
+
+double ParseTimeScale(const char* text) {
+  if (std::strcmp(text, "max") == 0) return kUnlimitedTimeScale;
+  char* end;
+  const double scale = std::strtod(text, &end);
+  if (end == text || *end != '\0' || !(scale > 0.0))
+    throw std::runtime_error("Time scale must be a positive number or max: " + std::string(text));
+  return scale;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+// Where the game loop takes the time from, and how it waits for it. Times are
+// in seconds, from an arbitrary origin.
+class GameClock {
+ public:
+  virtual ~GameClock() = default;
+
+  virtual double GetTime() const = 0;
+
+  // Blocks until time.
+  virtual void SleepUntil(double time) = 0;
+
+  // Blocks until time, or until an SDL event is queued. Returns whether one
+  // is. Only accurate to about a millisecond.
+  virtual bool WaitEventUntil(double time) = 0;
+};
+
+// SDL's high resolution counter, sub-microsecond on common platforms.
+class SystemClock : public GameClock {
+ public:
+  SystemClock();
+
+  double GetTime() const override;
+  void SleepUntil(double time) override;
+  bool WaitEventUntil(double time) override;
+
+ private:
+  Uint64 origin_;  // Counts, so that times keep their precision.
+  double seconds_per_count_;
+};
+
+// Time that only goes by when told to: waiting returns at once, at the time
+// waited for. A game on it runs as fast as it can, and its loop can be stepped
+// by hand.
+class FakeClock : public GameClock {
+ public:
+  explicit FakeClock(double time = 0.0) : time_(time) {}
+
+  void Advance(double seconds) { time_ += seconds; }
+
+  double GetTime() const override { return time_; }
+  void SleepUntil(double time) override { time_ = std::max(time_, time); }
+  bool WaitEventUntil(double time) override {
+    SleepUntil(time);
+    return false;
+  }
+
+ private:
+  double time_;
+};
+
+// How fast the game goes by against its clock: below 1 in slow motion, above
+// 1 fast-forwarded. Ticks keep their length, only their pace changes, so a
+// game plays the same at any scale.
+constexpr double kMinTimeScale = 1.0 / 8.0;
+constexpr double kMaxTimeScale = 8.0;
+// Each tick right after the last one.
+constexpr double kUnlimitedTimeScale = std::numeric_limits<double>::infinity();
+
+// A positive number, or "max" for kUnlimitedTimeScale. Throws
+// std::runtime_error otherwise.
+double ParseTimeScale(const char* text);
+
+// Deadlines of a loop ticking at a steady rate on a clock, paced by the time
+// scale: as fast as possible, each tick follows the last. After a long stall
+// (suspended machine, debugger) it restarts from now instead of catching up.
+class TickPacer {
+ public:
+  explicit TickPacer(GameClock& clock) : clock_(clock), next_tick_(clock.GetTime()) {}
+
+  double GetNextTick() const { return next_tick_; }
+
+  // The next tick is due now.
+  void Restart() { next_tick_ = clock_.GetTime(); }
+
+  // Schedules the next tick, a tick_length of game time after the last one.
+  void ScheduleNext(double tick_length, double time_scale);
+
+  // Blocks until the next tick. Until then, on_events is called as soon as
+  // SDL events are queued; it returns false to tick right away instead.
+  void WaitForNextTick(const std::function<bool()>& on_events);
+
+ private:
+  GameClock& clock_;
+  double next_tick_;
+};
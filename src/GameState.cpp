@@ -0,0 +1,156 @@
+#include "GameState.h"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "World.h"
+
+constexpr uint32_t kGameStateMagic = 0x53504c47;  // "GLPS"
+
+namespace {
+// Fields are written one by one, without the padding of the structures.
+template <typename T>
+void Write(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool Read(std::istream& in, T& value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+}  // namespace
+
+bool SaveWorld(const World& world, GameState& state) {
+  if (world.balls.GetCount() > GameState::kMaxBalls) return false;
+
+  const std::vector<Entity>& balls = world.balls.GetEntities();
+  state.ball_count = static_cast<int32_t>(balls.size());
+  for (size_t i = 0; i < balls.size(); ++i) {
+    const Ball& ball = world.balls[i];
+    GameState::BallState& saved = state.balls[i];
+    saved.position = ball.position;
+    saved.speed = ball.speed;
+    saved.predicted_y = ball.predicted_y;
+    saved.trajectory_revision = ball.trajectory_revision;
+    if (const BallTrail* trail = world.trails.Find(balls[i])) saved.trail = trail->particles;
+  }
+
+  for (const Paddle& paddle : world.paddles) {
+    GameState::PaddleState& saved = state.paddles[paddle.is_left ? 0 : 1];
+    saved.is_left = paddle.is_left;
+    saved.y = paddle.y;
+    saved.speed = paddle.speed;
+    saved.illuminate = paddle.illuminate;
+    saved.time_since_last_input = paddle.time_since_last_input;
+    saved.ai_trajectory_revision = paddle.ai_trajectory_revision;
+    saved.ai_target_y = paddle.ai_target_y;
+    saved.ai_reaction_time = paddle.ai_reaction_time;
+  }
+  return true;
+}
+
+void RestoreWorld(const GameState& state, World& world) {
+  const std::vector<Entity>& balls = world.balls.GetEntities();
+  const size_t ball_count = std::min<size_t>(balls.size(), state.ball_count);
+  for (size_t i = 0; i < ball_count; ++i) {
+    Ball& ball = world.balls[i];
+    const GameState::BallState& saved = state.balls[i];
+    ball.position = saved.position;
+    ball.speed = saved.speed;
+    ball.predicted_y = saved.predicted_y;
+    ball.trajectory_revision = saved.trajectory_revision;
+    if (BallTrail* trail = world.trails.Find(balls[i])) trail->particles = saved.trail;
+  }
+
+  for (Paddle& paddle : world.paddles) {
+    const GameState::PaddleState& saved = state.paddles[paddle.is_left ? 0 : 1];
+    paddle.y = saved.y;
+    paddle.speed = saved.speed;
+    paddle.illuminate = saved.illuminate;
+    paddle.time_since_last_input = saved.time_since_last_input;
+    paddle.ai_trajectory_revision = saved.ai_trajectory_revision;
+    paddle.ai_target_y = saved.ai_target_y;
+    paddle.ai_reaction_time = saved.ai_reaction_time;
+  }
+}
+
+void WriteGameState(std::ostream& out, const GameState& state) {
+  Write(out, kGameStateMagic);
+  Write(out, kGameStateVersion);
+
+  Write(out, state.ball_count);
+  for (int i = 0; i < state.ball_count; ++i) {
+    const GameState::BallState& ball = state.balls[i];
+    Write(out, ball.position);
+    Write(out, ball.speed);
+    Write(out, ball.predicted_y);
+    Write(out, ball.trajectory_revision);
+    for (const TrailParticle& particle : ball.trail) {
+      Write(out, particle.life);
+      Write(out, particle.fade);
+      Write(out, particle.pos);
+    }
+  }
+  for (const GameState::PaddleState& paddle : state.paddles) {
+    Write(out, static_cast<uint8_t>(paddle.is_left));
+    Write(out, paddle.y);
+    Write(out, paddle.speed);
+    Write(out, paddle.illuminate);
+    Write(out, paddle.time_since_last_input);
+    Write(out, paddle.ai_trajectory_revision);
+    Write(out, paddle.ai_target_y);
+    Write(out, paddle.ai_reaction_time);
+  }
+  Write(out, state.board.left_score);
+  Write(out, state.board.right_score);
+  Write(out, state.board.illuminate_left_border);
+  Write(out, state.board.illuminate_right_border);
+  Write(out, static_cast<uint8_t>(state.board.is_game_over));
+  Write(out, state.ball_random_state);
+  Write(out, state.paddle_random_state);
+  Write(out, state.obstacle_time);
+}
+
+bool ReadGameState(std::istream& in, GameState& state) {
+  uint32_t magic, version;
+  if (!Read(in, magic) || magic != kGameStateMagic || !Read(in, version) || version < 1 ||
+      version > kGameStateVersion)
+    return false;
+
+  GameState read;
+  if (!Read(in, read.ball_count) || read.ball_count < 0 ||
+      read.ball_count > GameState::kMaxBalls)
+    return false;
+  for (int i = 0; i < read.ball_count; ++i) {
+    GameState::BallState& ball = read.balls[i];
+    if (!Read(in, ball.position) || !Read(in, ball.speed) || !Read(in, ball.predicted_y) ||
+        !Read(in, ball.trajectory_revision))
+      return false;
+    for (TrailParticle& particle : ball.trail) {
+      if (!Read(in, particle.life) || !Read(in, particle.fade) || !Read(in, particle.pos))
+        return false;
+    }
+  }
+  for (GameState::PaddleState& paddle : read.paddles) {
+    uint8_t is_left;
+    if (!Read(in, is_left) || !Read(in, paddle.y) || !Read(in, paddle.speed) ||
+        !Read(in, paddle.illuminate) || !Read(in, paddle.time_since_last_input) ||
+        !Read(in, paddle.ai_trajectory_revision) || !Read(in, paddle.ai_target_y) ||
+        !Read(in, paddle.ai_reaction_time))
+      return false;
+    paddle.is_left = is_left;
+  }
+  uint8_t is_game_over;
+  if (!Read(in, read.board.left_score) || !Read(in, read.board.right_score) ||
+      !Read(in, read.board.illuminate_left_border) ||
+      !Read(in, read.board.illuminate_right_border) || !Read(in, is_game_over) ||
+      !Read(in, read.ball_random_state) || !Read(in, read.paddle_random_state))
+    return false;
+  read.board.is_game_over = is_game_over;
+  if (version >= 2 && !Read(in, read.obstacle_time)) return false;
+
+  state = read;
+  return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <iosfwd>
+#include <type_traits>
+
+#include "Components.h"
+
+struct World;
+
+// State of a game, flattened: the ball with its trail, the paddles and the
+// board, and the generators of the systems. Plain data, so saving, restoring
+// and forking a game is a copy of about a kilobyte.
+//
+// Wall-clock times, e.g. of the last input, and the display state aren't part
+// of it.
+struct GameState {
+  static constexpr int kMaxBalls = 1;
+
+  struct BallState {
+    glm::vec2 position{0.0f, 0.0f};
+    glm::vec2 speed{0.0f, 0.0f};
+    float predicted_y = 0.0f;
+    uint32_t trajectory_revision = 0;
+    std::array<TrailParticle, BallTrail::kParticleCount> trail = {};
+  };
+
+  struct PaddleState {
+    bool is_left = true;
+    float y = 0.0f;
+    float speed = 0.0f;
+    float illuminate = 0.0f;
+    float time_since_last_input = 0.0f;
+    uint32_t ai_trajectory_revision = 0;
+    float ai_target_y = 0.0f;
+    float ai_reaction_time = 0.0f;
+  };
+
+  struct BoardState {
+    int32_t left_score = 0;
+    int32_t right_score = 0;
+    float illuminate_left_border = 0.0f;
+    float illuminate_right_border = 0.0f;
+    bool is_game_over = false;
+  };
+
+  int32_t ball_count = 0;
+  std::array<BallState, kMaxBalls> balls;
+  std::array<PaddleState, 2> paddles;  // Left, right.
+  BoardState board;
+  uint64_t ball_random_state = 1;    // BallSystem's generator.
+  uint64_t paddle_random_state = 1;  // PaddleSystem's generator.
+  double obstacle_time = 0.0;        // Where the moving obstacles are, in seconds.
+};
+
+static_assert(std::is_trivially_copyable_v<GameState>);
+
+// Copies the balls, their trails and the paddles of the world. Returns false
+// if the world has more balls than a GameState holds.
+bool SaveWorld(const World& world, GameState& state);
+
+// Copies the balls and paddles back into the entities of the world, which
+// must be the ones the state was saved from, or alike.
+void RestoreWorld(const GameState& state, World& world);
+
+// Binary file format, in the byte order of the machine, starting with a
+// version. Files of older versions can be read; fields they lack keep their
+// defaults.
+constexpr uint32_t kGameStateVersion = 2;
+
+void WriteGameState(std::ostream& out, const GameState& state);
+
+// Returns false for other files, newer versions or truncated files.
+bool ReadGameState(std::istream& in, GameState& state);
@@ -0,0 +1,340 @@
+#include "Hud.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "ShaderLibrary.h"
+#include "VertexFormat.h"
+
+namespace {
+// Atlas cell, in texels.
+constexpr int kCellWidth = 32;
+constexpr int kCellHeight = 48;
+// Half thickness of a segment, and distance over which the field goes from
+// inside (1) to outside (0).
+constexpr float kSegmentRadius = 2.0f;
+constexpr float kFieldSpread = 8.0f;
+
+/*  Segments:   a
+ *            f   b
+ *              g
+ *            e   c
+ *              d    .
+ */
+enum Segment {
+  kA = 1 << 0,
+  kB = 1 << 1,
+  kC = 1 << 2,
+  kD = 1 << 3,
+  kE = 1 << 4,
+  kF = 1 << 5,
+  kG = 1 << 6,
+  kDot = 1 << 7,
+  kColon = 1 << 8,
+  kSolid = 1 << 9,
+};
+
+struct Glyph {
+  char character;
+  int segments;
+};
+
+// Upper and lower case letters are both drawn with the only form that fits on
+// seven segments.
+constexpr std::array<Glyph, 30> kGlyphs = {{
+    {'0', kA | kB | kC | kD | kE | kF},
+    {'1', kB | kC},
+    {'2', kA | kB | kG | kE | kD},
+    {'3', kA | kB | kG | kC | kD},
+    {'4', kF | kG | kB | kC},
+    {'5', kA | kF | kG | kC | kD},
+    {'6', kA | kF | kG | kE | kC | kD},
+    {'7', kA | kB | kC},
+    {'8', kA | kB | kC | kD | kE | kF | kG},
+    {'9', kA | kB | kC | kD | kF | kG},
+    {'A', kA | kB | kC | kE | kF | kG},
+    {'B', kF | kE | kD | kC | kG},
+    {'C', kA | kF | kE | kD},
+    {'D', kB | kC | kD | kE | kG},
+    {'E', kA | kF | kG | kE | kD},
+    {'F', kA | kF | kG | kE},
+    {'H', kF | kE | kG | kB | kC},
+    {'J', kB | kC | kD},
+    {'L', kF | kE | kD},
+    {'N', kE | kG | kC},
+    {'O', kE | kG | kC | kD},
+    {'P', kA | kB | kF | kG | kE},
+    {'R', kE | kG},
+    {'T', kF | kE | kD | kG},
+    {'U', kF | kE | kD | kC | kB},
+    {'Y', kF | kG | kB | kC | kD},
+    {'-', kG},
+    {'.', kDot},
+    {':', kColon},
+    {'\0', kSolid},
+}};
+constexpr int kSolidGlyph = kGlyphs.size() - 1;
+
+int FindGlyph(char character) {
+  character = static_cast<char>(toupper(static_cast<unsigned char>(character)));
+  if (character == 'S') character = '5';
+  if (character == 'I') character = '1';
+  for (int i = 0; i < kSolidGlyph; ++i)
+    if (kGlyphs[i].character == character) return i;
+  return -1;
+}
+
+float DistanceToSegment(glm::vec2 p, glm::vec2 a, glm::vec2 b) {
+  glm::vec2 ab = b - a;
+  float t = glm::clamp(glm::dot(p - a, ab) / std::max(glm::dot(ab, ab), 1e-6f), 0.0f, 1.0f);
+  return glm::length(p - (a + t * ab));
+}
+
+// Signed distance field of all glyphs, one cell per glyph, left to right.
+std::vector<GLubyte> GenerateAtlas() {
+  struct Stroke {
+    int segment;
+    glm::vec2 from, to;
+  };
+  static const Stroke kStrokes[] = {
+      {kA, {9, 6}, {23, 6}},     {kB, {26, 9}, {26, 21}},  {kC, {26, 27}, {26, 39}},
+      {kD, {9, 42}, {23, 42}},   {kE, {6, 27}, {6, 39}},   {kF, {6, 9}, {6, 21}},
+      {kG, {9, 24}, {23, 24}},   {kDot, {29, 42}, {29, 42}}, {kColon, {16, 16}, {16, 16}},
+      {kColon, {16, 32}, {16, 32}},
+  };
+
+  const int atlas_width = kCellWidth * kGlyphs.size();
+  std::vector<GLubyte> texels(atlas_width * kCellHeight);
+  for (int glyph = 0; glyph < static_cast<int>(kGlyphs.size()); ++glyph) {
+    const int segments = kGlyphs[glyph].segments;
+    for (int y = 0; y < kCellHeight; ++y) {
+      for (int x = 0; x < kCellWidth; ++x) {
+        float value = 1.0f;
+        if (!(segments & kSolid)) {
+          float distance = kFieldSpread;
+          glm::vec2 p(x + 0.5f, y + 0.5f);
+          for (const auto& stroke : kStrokes)
+            if (segments & stroke.segment)
+              distance = std::min(distance, DistanceToSegment(p, stroke.from, stroke.to));
+          value = 0.5f + (kSegmentRadius - distance) / (2.0f * kFieldSpread);
+        }
+        texels[y * atlas_width + glyph * kCellWidth + x] = PackUnorm8(value);
+      }
+    }
+  }
+  return texels;
+}
+}  // namespace
+
+HudLayer::HudLayer(DrawFunction draw) : draw_(std::move(draw)) {}
+
+HudLayer::~HudLayer() {
+  if (framebuffer_) glDeleteFramebuffers(1, &framebuffer_);
+  if (texture_) glDeleteTextures(1, &texture_);
+}
+
+Hud::Hud(ShaderLibrary& shaders)
+    : shader_(shaders.Get(GetHudShaderSource())),
+      layer_shader_(shaders.Get(GetHudLayerShaderSource())) {
+  // The programs are only used by the HUD: most uniforms are set once.
+  canvas_size_uniform_ = shader_->GetUniform<glm::vec2>("canvasSize");
+  shader_->Use();
+  shader_->SetUniform(canvas_size_uniform_, glm::vec2(kCanvasWidth, kCanvasHeight));
+  shader_->SetUniform(shader_->GetUniform<float>("glyphCount"), float(kGlyphs.size()));
+  shader_->SetUniform(shader_->GetUniform<int>("glyphAtlas"), 0);
+
+  layer_rect_uniform_ = layer_shader_->GetUniform<glm::vec4>("layerRect");
+  layer_shader_->Use();
+  layer_shader_->SetUniform(layer_shader_->GetUniform<glm::vec2>("canvasSize"),
+                            glm::vec2(kCanvasWidth, kCanvasHeight));
+  layer_shader_->SetUniform(layer_shader_->GetUniform<int>("layerTexture"), 0);
+
+  // Glyph atlas.
+  std::vector<GLubyte> atlas = GenerateAtlas();
+  glGenTextures(1, &atlas_texture_);
+  glBindTexture(GL_TEXTURE_2D, atlas_texture_);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, kCellWidth * kGlyphs.size(), kCellHeight, 0, GL_RED,
+               GL_UNSIGNED_BYTE, atlas.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // One quad, instanced per glyph.
+  static const GLfloat kCorners[] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f};
+  static const VertexLayout kCornerLayout(2 * sizeof(GLfloat),
+                                          {{kPositionAttribute, 2, GL_FLOAT, GL_FALSE, 0}});
+  static const VertexLayout kInstanceLayout(
+      sizeof(Instance),
+      {
+          {kRectAttribute, 4, GL_FLOAT, GL_FALSE, offsetof(Instance, rect), 1},
+          {kGlyphAttribute, 1, GL_FLOAT, GL_FALSE, offsetof(Instance, glyph), 1},
+          {kColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Instance, color), 1},
+      });
+
+  glGenVertexArrays(1, &vao_);
+  glGenBuffers(1, &corner_vbo_);
+  glGenBuffers(1, &instance_vbo_);
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, corner_vbo_);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(kCorners), kCorners, GL_STATIC_DRAW);
+  kCornerLayout.Apply();
+  glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+  kInstanceLayout.Apply();
+
+  // Layers are a single non-instanced quad.
+  glGenVertexArrays(1, &layer_vao_);
+  glBindVertexArray(layer_vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, corner_vbo_);
+  kCornerLayout.Apply();
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+}
+
+Hud::~Hud() {
+  if (vao_) glDeleteVertexArrays(1, &vao_);
+  if (layer_vao_) glDeleteVertexArrays(1, &layer_vao_);
+  if (corner_vbo_) glDeleteBuffers(1, &corner_vbo_);
+  if (instance_vbo_) glDeleteBuffers(1, &instance_vbo_);
+  if (atlas_texture_) glDeleteTextures(1, &atlas_texture_);
+}
+
+void Hud::AddText(const std::string& text, const glm::vec2& top_left, float height,
+                  const glm::vec4& color) {
+  const glm::vec2 size(height * kCellWidth / kCellHeight, height);
+  glm::vec2 position = top_left;
+  for (char character : text) {
+    int glyph = FindGlyph(character);
+    if (glyph >= 0) AddGlyph(glyph, position, size, color);
+    position.x += size.x;
+  }
+}
+
+float Hud::MeasureText(const std::string& text, float height) {
+  return text.size() * height * kCellWidth / kCellHeight;
+}
+
+void Hud::AddRect(const glm::vec2& top_left, const glm::vec2& size, const glm::vec4& color) {
+  AddGlyph(kSolidGlyph, top_left, size, color);
+}
+
+void Hud::AddLayer(HudLayer& layer, const glm::vec2& top_left, const glm::vec2& size) {
+  layers_.push_back({&layer, top_left, size});
+}
+
+void Hud::SetViewportSize(int width, int height) { viewport_size_ = glm::ivec2(width, height); }
+
+void Hud::AddGlyph(int glyph, const glm::vec2& top_left, const glm::vec2& size,
+                   const glm::vec4& color) {
+  instances_.push_back({{top_left.x, top_left.y, size.x, size.y},
+                        float(glyph),
+                        {PackUnorm8(color.r), PackUnorm8(color.g), PackUnorm8(color.b),
+                         PackUnorm8(color.a)}});
+}
+
+void Hud::Render() {
+  if (instances_.empty() && layers_.empty()) return;
+
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_CULL_FACE);
+  glEnable(GL_BLEND);
+  // Color is blended as usual, and alpha accumulates coverage so that layer
+  // textures end up with premultiplied alpha.
+  glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+  if (!layers_.empty()) {
+    // Redraw out of date layers, keeping aside what was queued for this frame.
+    std::vector<Instance> queued_instances;
+    queued_instances.swap(instances_);
+    const glm::vec2 pixels_per_unit =
+        glm::vec2(viewport_size_) / glm::vec2(kCanvasWidth, kCanvasHeight);
+    for (const auto& queued : layers_) {
+      glm::ivec2 texture_size = glm::max(glm::ivec2(glm::ceil(queued.size * pixels_per_unit)),
+                                         glm::ivec2(1));
+      if (queued.layer->is_dirty_ || texture_size != queued.layer->texture_size_)
+        RenderLayerTexture(*queued.layer, queued.size, texture_size);
+    }
+    instances_.swap(queued_instances);
+
+    // Composite them.
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glActiveTexture(GL_TEXTURE0);
+    layer_shader_->Use();
+    glBindVertexArray(layer_vao_);
+    for (const auto& queued : layers_) {
+      glBindTexture(GL_TEXTURE_2D, queued.layer->texture_);
+      layer_shader_->SetUniform(layer_rect_uniform_, glm::vec4(queued.top_left, queued.size));
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    glBindVertexArray(0);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    layers_.clear();
+  }
+
+  DrawInstances(glm::vec2(kCanvasWidth, kCanvasHeight));
+
+  glDisable(GL_BLEND);
+  glEnable(GL_CULL_FACE);
+  glEnable(GL_DEPTH_TEST);
+}
+
+void Hud::RenderLayerTexture(HudLayer& layer, const glm::vec2& size,
+                             const glm::ivec2& texture_size) {
+  if (!layer.texture_) {
+    glGenTextures(1, &layer.texture_);
+    glGenFramebuffers(1, &layer.framebuffer_);
+  }
+  glBindTexture(GL_TEXTURE_2D, layer.texture_);
+  if (texture_size != layer.texture_size_) {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texture_size.x, texture_size.y, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.texture_,
+                           0);
+    layer.texture_size_ = texture_size;
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  GLfloat clear_color[4];
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+  glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer_);
+  glViewport(0, 0, texture_size.x, texture_size.y);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  layer.draw_(*this, size);
+  DrawInstances(size);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glViewport(0, 0, viewport_size_.x, viewport_size_.y);
+  glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+  layer.is_dirty_ = false;
+}
+
+void Hud::DrawInstances(const glm::vec2& canvas_size) {
+  if (instances_.empty()) return;
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, atlas_texture_);
+  shader_->Use();
+  shader_->SetUniform(canvas_size_uniform_, canvas_size);
+
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+  // Orphan the previous buffer rather than waiting for it.
+  glBufferData(GL_ARRAY_BUFFER, instances_.size() * sizeof(Instance), instances_.data(),
+               GL_STREAM_DRAW);
+  glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances_.size());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+
+  instances_.clear();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <functional>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+class Hud;
+class ShaderLibrary;
+
+// HUD content that rarely changes, such as the scores. It is drawn into a
+// texture only after Invalidate(), and composited with a single quad on the
+// other frames.
+class HudLayer {
+ public:
+  // Draws the content with the usual Hud calls, in layer coordinates: (0, 0)
+  // is the top left of the layer and size its bottom right.
+  using DrawFunction = std::function<void(Hud& hud, const glm::vec2& size)>;
+
+  explicit HudLayer(DrawFunction draw);
+  ~HudLayer();
+
+  HudLayer(const HudLayer&) = delete;
+  HudLayer& operator=(const HudLayer&) = delete;
+
+  // Redraw the content the next time the layer is rendered.
+  void Invalidate() { is_dirty_ = true; }
+
+ private:
+  friend class Hud;
+
+  DrawFunction draw_;
+  bool is_dirty_ = true;
+  GLuint texture_ = 0;
+  GLuint framebuffer_ = 0;
+  glm::ivec2 texture_size_{0, 0};
+};
+
+// Screen-space text and rectangles, drawn with a single instanced draw call.
+//
+// Glyphs are seven-segment characters stored as a signed distance field, so
+// they stay sharp at any size. Coordinates are in canvas units: a virtual
+// kCanvasWidth x kCanvasHeight screen with the origin at the top left.
+class Hud {
+ public:
+  static constexpr float kCanvasWidth = 800.0f;
+  static constexpr float kCanvasHeight = 600.0f;
+
+  Hud(ShaderLibrary& shaders);
+  ~Hud();
+
+  // Queues a string. Characters that can't be displayed on seven segments are
+  // left blank.
+  void AddText(const std::string& text, const glm::vec2& top_left, float height,
+               const glm::vec4& color);
+
+  // Width of a string drawn by AddText().
+  static float MeasureText(const std::string& text, float height);
+
+  // Queues a filled rectangle.
+  void AddRect(const glm::vec2& top_left, const glm::vec2& size, const glm::vec4& color);
+
+  // Queues a cached layer, drawn below text and rectangles. The layer must
+  // outlive the next Render().
+  void AddLayer(HudLayer& layer, const glm::vec2& top_left, const glm::vec2& size);
+
+  // Size of the default framebuffer, in pixels. Layers are cached at this
+  // resolution.
+  void SetViewportSize(int width, int height);
+
+  // Draws and clears everything queued so far.
+  void Render();
+
+ private:
+  struct Instance {
+    GLfloat rect[4];  // left, top, width, height
+    GLfloat glyph;
+    GLubyte color[4];
+  };
+
+  struct QueuedLayer {
+    HudLayer* layer;
+    glm::vec2 top_left;
+    glm::vec2 size;
+  };
+
+  void AddGlyph(int glyph, const glm::vec2& top_left, const glm::vec2& size,
+                const glm::vec4& color);
+
+  // Redraws the content of a layer into its texture.
+  void RenderLayerTexture(HudLayer& layer, const glm::vec2& size, const glm::ivec2& texture_size);
+
+  // Draws the queued instances on a canvas of the given size.
+  void DrawInstances(const glm::vec2& canvas_size);
+
+  std::shared_ptr<Shader> shader_;
+  Uniform<glm::vec2> canvas_size_uniform_;
+  std::shared_ptr<Shader> layer_shader_;
+  Uniform<glm::vec4> layer_rect_uniform_;
+  GLuint atlas_texture_ = 0;
+  GLuint vao_ = 0;
+  GLuint corner_vbo_ = 0;
+  GLuint instance_vbo_ = 0;
+  GLuint layer_vao_ = 0;
+  std::vector<Instance> instances_;
+  std::vector<QueuedLayer> layers_;
+  glm::ivec2 viewport_size_{static_cast<int>(kCanvasWidth), static_cast<int>(kCanvasHeight)};
+};
@@ -24,6 +24,9 @@
 #include <SDL2/SDL_events.h>
 #include <glm/glm.hpp>
 
+#include "JobSystem.h"
+#include "SceneSnapshot.h"
+
 class IObject {
  public:
 
@@ -31,24 +34,31 @@ class IObject {
   // Constructors
   virtual ~IObject() {};
 
+  // Attributes
+  /** Name of the object in tools, such as the job graph.
+   */
+  virtual const char* GetName() const = 0;
+
+  /** What Update() reads and writes besides the object itself. Updates that
+   * don't touch the same data may run at the same time, on other threads.
+   */
+  virtual JobAccess GetUpdateAccess() const { return {}; }
+
   // Operations
   /** Update the object.
    * @param fTime    Time elapsed between two updates.
    */
   virtual void Update(float fTime) = 0;
 
-  /** Render the object.
+  /** Copy what the object needs to be rendered into a snapshot.
+   * Called on the simulation thread, after Update().
    */
-  virtual void Render(const glm::mat4& view, const glm::mat4& model,
-                      const glm::mat4& projection) const = 0;
+  virtual void Snapshot(SceneSnapshot& snapshot) const = 0;
 
-  /** Process event.
-   * The object receive an event to process.
-   * If he has processed this event and it should not be processed by
-   * any other object, then it return true.
-   *
-   * @param event  The SDL event to process.
-   * @return True if the message has been processed.
+  /** Render the object.
+   * Called on the render thread, which owns the GL context. Only the snapshot
+   * may be read for state that changes during the game.
    */
-  virtual bool ProcessEvent(const SDL_Event& event) = 0;
+  virtual void Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4& view,
+                      const glm::mat4& projection) const = 0;
 };
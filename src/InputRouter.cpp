@@ -0,0 +1,199 @@
+#include "InputRouter.h"
+
+#include <algorithm>
+#include <iostream>
+
+InputRouter::InputRouter() {
+  BindKey(SDLK_a, Action::kLeftPaddleUp);
+  BindKey(SDLK_LSHIFT, Action::kLeftPaddleUp);
+  BindKey(SDLK_q, Action::kLeftPaddleDown);
+  BindKey(SDLK_LCTRL, Action::kLeftPaddleDown);
+  BindKey(SDLK_UP, Action::kRightPaddleUp);
+  BindKey(SDLK_DOWN, Action::kRightPaddleDown);
+  BindKey(SDLK_ESCAPE, Action::kQuit);
+  BindKey(SDLK_F1, Action::kToggleFullscreen);
+  BindKey(SDLK_F2, Action::kTogglePerformanceOverlay);
+  BindKey(SDLK_F3, Action::kToggleLighting);
+  BindKey(SDLK_F4, Action::kToggleLatency);
+  BindKey(SDLK_PAUSE, Action::kPause);
+  BindKey(SDLK_F5, Action::kDumpJobGraph);
+  BindKey(SDLK_F6, Action::kTogglePrediction);
+  BindKey(SDLK_F7, Action::kSaveState);
+  BindKey(SDLK_F8, Action::kLoadState);
+  BindKey(SDLK_BACKSPACE, Action::kRewind);
+  BindKey(SDLK_LEFTBRACKET, Action::kSlowDown);
+  BindKey(SDLK_RIGHTBRACKET, Action::kSpeedUp);
+
+  // Each player holds a half of the screen: its top moves up, its bottom down.
+  BindTouchRegion(0.0f, 0.0f, 0.5f, 0.5f, Action::kLeftPaddleUp);
+  BindTouchRegion(0.0f, 0.5f, 0.5f, 1.0f, Action::kLeftPaddleDown);
+  BindTouchRegion(0.5f, 0.0f, 1.0f, 0.5f, Action::kRightPaddleUp);
+  BindTouchRegion(0.5f, 0.5f, 1.0f, 1.0f, Action::kRightPaddleDown);
+
+  BindGamepadButton(0, SDL_CONTROLLER_BUTTON_DPAD_UP, Action::kLeftPaddleUp);
+  BindGamepadButton(0, SDL_CONTROLLER_BUTTON_DPAD_DOWN, Action::kLeftPaddleDown);
+  BindGamepadButton(1, SDL_CONTROLLER_BUTTON_DPAD_UP, Action::kRightPaddleUp);
+  BindGamepadButton(1, SDL_CONTROLLER_BUTTON_DPAD_DOWN, Action::kRightPaddleDown);
+  for (int gamepad = 0; gamepad < kMaxGamepads; ++gamepad)
+    BindGamepadButton(gamepad, SDL_CONTROLLER_BUTTON_START, Action::kPause);
+}
+
+void InputRouter::Subscribe(Action action, Handler handler) {
+  handlers_[static_cast<int>(action)].push_back(std::move(handler));
+}
+
+bool InputRouter::Dispatch(const SDL_Event& event) {
+  switch (event.type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP: {
+      const bool is_pressed = event.type == SDL_KEYDOWN;
+      const bool is_repeat = event.key.repeat != 0;
+      if (is_pressed && !is_repeat) Notify(Action::kAnyPress, true, false, event.key.timestamp);
+      const int index = GetKeyIndex(event.key.keysym.sym);
+      if (index >= 0) Notify(key_actions_[index], is_pressed, is_repeat, event.key.timestamp);
+      return true;
+    }
+
+    case SDL_MOUSEBUTTONDOWN:
+      Notify(Action::kAnyPress, true, false, event.button.timestamp);
+      return true;
+    case SDL_MOUSEBUTTONUP:
+      return true;
+
+    case SDL_FINGERDOWN:
+      Notify(Action::kAnyPress, true, false, event.tfinger.timestamp);
+      DispatchFinger(event.tfinger, true);
+      return true;
+    case SDL_FINGERMOTION:
+      DispatchFinger(event.tfinger, true);
+      return true;
+    case SDL_FINGERUP:
+      DispatchFinger(event.tfinger, false);
+      return true;
+
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP: {
+      const bool is_pressed = event.type == SDL_CONTROLLERBUTTONDOWN;
+      if (is_pressed) Notify(Action::kAnyPress, true, false, event.cbutton.timestamp);
+      const int slot = GetGamepadSlot(event.cbutton.which);
+      if (slot >= 0 && event.cbutton.button < SDL_CONTROLLER_BUTTON_MAX)
+        Notify(button_actions_[slot][event.cbutton.button], is_pressed, false,
+               event.cbutton.timestamp);
+      return true;
+    }
+    case SDL_CONTROLLERDEVICEADDED:
+      OpenGamepad(event.cdevice.which);
+      return true;
+    case SDL_CONTROLLERDEVICEREMOVED:
+      CloseGamepad(event.cdevice.which);
+      return true;
+  }
+  return false;
+}
+
+void InputRouter::BindKey(SDL_Keycode key, Action action) {
+  const int index = GetKeyIndex(key);
+  if (index >= 0 && action != Action::kAnyPress) key_actions_[index] = action;
+}
+
+void InputRouter::BindGamepadButton(int gamepad, SDL_GameControllerButton button, Action action) {
+  if (gamepad < 0 || gamepad >= kMaxGamepads || button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX ||
+      action == Action::kAnyPress)
+    return;
+  button_actions_[gamepad][button] = action;
+}
+
+void InputRouter::BindTouchRegion(float left, float top, float right, float bottom,
+                                  Action action) {
+  if (action == Action::kAnyPress) return;
+  // Cells whose center is in the region.
+  for (int row = 0; row < kTouchGridSize; ++row) {
+    const float y = (row + 0.5f) / kTouchGridSize;
+    if (y < top || y >= bottom) continue;
+    for (int column = 0; column < kTouchGridSize; ++column) {
+      const float x = (column + 0.5f) / kTouchGridSize;
+      if (x >= left && x < right) touch_actions_[row * kTouchGridSize + column] = action;
+    }
+  }
+}
+
+void InputRouter::Unbind(Action action) {
+  std::replace(key_actions_.begin(), key_actions_.end(), action, Action::kNone);
+  for (auto& actions : button_actions_)
+    std::replace(actions.begin(), actions.end(), action, Action::kNone);
+  std::replace(touch_actions_.begin(), touch_actions_.end(), action, Action::kNone);
+}
+
+int InputRouter::GetKeyIndex(SDL_Keycode key) {
+  if (key & SDLK_SCANCODE_MASK) {
+    const int scancode = key & ~SDLK_SCANCODE_MASK;
+    return scancode < SDL_NUM_SCANCODES ? kCharacterKeyCount + scancode : -1;
+  }
+  return key >= 0 && key < kCharacterKeyCount ? key : -1;
+}
+
+void InputRouter::Notify(Action action, bool is_pressed, bool is_repeat, Uint32 timestamp) const {
+  if (action == Action::kNone) return;
+  const InputAction input = {action, is_pressed, is_repeat, timestamp};
+  for (const Handler& handler : handlers_[static_cast<int>(action)]) handler(input);
+}
+
+void InputRouter::DispatchFinger(const SDL_TouchFingerEvent& finger, bool is_down) {
+  const Action action = is_down ? GetTouchAction(finger.x, finger.y) : Action::kNone;
+  auto held = std::find_if(finger_actions_.begin(), finger_actions_.end(),
+                           [&](const auto& entry) { return entry.first == finger.fingerId; });
+  const Action previous = held != finger_actions_.end() ? held->second : Action::kNone;
+
+  if (action == previous) {
+    // A finger moving within its region holds the action, like a key repeat.
+    Notify(action, true, true, finger.timestamp);
+    return;
+  }
+  Notify(previous, false, false, finger.timestamp);
+  Notify(action, true, false, finger.timestamp);
+
+  if (action == Action::kNone)
+    finger_actions_.erase(held);
+  else if (held != finger_actions_.end())
+    held->second = action;
+  else
+    finger_actions_.emplace_back(finger.fingerId, action);
+}
+
+Action InputRouter::GetTouchAction(float x, float y) const {
+  const int column = std::clamp(static_cast<int>(x * kTouchGridSize), 0, kTouchGridSize - 1);
+  const int row = std::clamp(static_cast<int>(y * kTouchGridSize), 0, kTouchGridSize - 1);
+  return touch_actions_[row * kTouchGridSize + column];
+}
+
+void InputRouter::OpenGamepad(int device_index) {
+  if (!SDL_IsGameController(device_index) ||
+      GetGamepadSlot(SDL_JoystickGetDeviceInstanceID(device_index)) >= 0)
+    return;
+  auto slot = std::find(gamepads_.begin(), gamepads_.end(), nullptr);
+  if (slot == gamepads_.end()) return;
+  *slot = SDL_GameControllerOpen(device_index);
+  if (!*slot) {
+    std::cerr << "Gamepad can't be opened: " << SDL_GetError() << std::endl;
+    return;
+  }
+  const char* name = SDL_GameControllerName(*slot);
+  std::cout << "Gamepad " << slot - gamepads_.begin() + 1 << ": " << (name ? name : "unknown")
+            << std::endl;
+}
+
+void InputRouter::CloseGamepad(SDL_JoystickID id) {
+  const int slot = GetGamepadSlot(id);
+  if (slot < 0) return;
+  SDL_GameControllerClose(gamepads_[slot]);
+  gamepads_[slot] = nullptr;
+}
+
+int InputRouter::GetGamepadSlot(SDL_JoystickID id) const {
+  for (int slot = 0; slot < kMaxGamepads; ++slot) {
+    if (gamepads_[slot] &&
+        SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(gamepads_[slot])) == id)
+      return slot;
+  }
+  return -1;
+}
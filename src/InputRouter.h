@@ -0,0 +1,114 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// What the player asks for, whatever the device.
+enum class Action : uint8_t {
+  kNone,
+  kLeftPaddleUp,
+  kLeftPaddleDown,
+  kRightPaddleUp,
+  kRightPaddleDown,
+  kQuit,
+  kToggleFullscreen,
+  kTogglePerformanceOverlay,
+  kToggleLighting,
+  kToggleLatency,
+  kPause,
+  kDumpJobGraph,
+  kTogglePrediction,
+  kSaveState,
+  kLoadState,
+  kRewind,  // Held.
+  kSlowDown,
+  kSpeedUp,
+  // Any key, mouse button, touch or gamepad button pressed, bound or not.
+  // Can't be bound.
+  kAnyPress,
+};
+
+constexpr int kActionCount = static_cast<int>(Action::kAnyPress) + 1;
+
+// An action starting or ending.
+struct InputAction {
+  Action action;
+  bool is_pressed;
+  bool is_repeat;    // A key held down, pressed again by the keyboard.
+  Uint32 timestamp;  // SDL ticks of the event.
+};
+
+// Turns SDL input events into actions, and calls only the handlers subscribed
+// to them.
+//
+// Keys, gamepad buttons and regions of the touch screen are bound to actions
+// through flat tables, so that an event finds its action in O(1) whatever the
+// number of bindings. Bindings can change at any time, e.g. from an options
+// screen.
+class InputRouter {
+ public:
+  using Handler = std::function<void(const InputAction&)>;
+
+  static constexpr int kMaxGamepads = 2;
+
+  // With the default bindings: A/Q or Shift/Ctrl for the left paddle, arrows
+  // for the right one, a half of the touch screen each, and the D-pad of the
+  // first and second gamepads. Gamepads stay open until SDL_Quit().
+  InputRouter();
+
+  InputRouter(const InputRouter&) = delete;
+  InputRouter& operator=(const InputRouter&) = delete;
+
+  // Handlers are called in the order of subscription, from Dispatch().
+  void Subscribe(Action action, Handler handler);
+
+  // Routes an input event. Returns false for other events, e.g. window ones.
+  bool Dispatch(const SDL_Event& event);
+
+  // Binding to Action::kNone unbinds.
+  void BindKey(SDL_Keycode key, Action action);
+  void BindGamepadButton(int gamepad, SDL_GameControllerButton button, Action action);
+  // Binds the touch screen between two corners, in normalized coordinates
+  // ((0, 0) is the top-left corner), rounded to a grid of
+  // kTouchGridSize x kTouchGridSize cells.
+  void BindTouchRegion(float left, float top, float right, float bottom, Action action);
+  // Removes every binding to the action.
+  void Unbind(Action action);
+
+ private:
+  static constexpr int kTouchGridSize = 8;
+  // Keycodes are either characters or scancodes with SDLK_SCANCODE_MASK.
+  static constexpr int kCharacterKeyCount = 256;
+  static constexpr int kKeyTableSize = kCharacterKeyCount + SDL_NUM_SCANCODES;
+
+  // Index in key_actions_, or -1 for keys that can't be bound.
+  static int GetKeyIndex(SDL_Keycode key);
+
+  void Notify(Action action, bool is_pressed, bool is_repeat, Uint32 timestamp) const;
+
+  void DispatchFinger(const SDL_TouchFingerEvent& finger, bool is_down);
+  Action GetTouchAction(float x, float y) const;
+
+  void OpenGamepad(int device_index);
+  void CloseGamepad(SDL_JoystickID id);
+  // Slot of the gamepad, or -1 if it wasn't opened.
+  int GetGamepadSlot(SDL_JoystickID id) const;
+
+  std::array<std::vector<Handler>, kActionCount> handlers_;
+
+  std::array<Action, kKeyTableSize> key_actions_ = {};
+  std::array<std::array<Action, SDL_CONTROLLER_BUTTON_MAX>, kMaxGamepads> button_actions_ = {};
+  std::array<Action, kTouchGridSize * kTouchGridSize> touch_actions_ = {};
+
+  // Action held by each finger on the screen, released when it lifts or
+  // slides to another region.
+  std::vector<std::pair<SDL_FingerID, Action>> finger_actions_;
+
+  // Gamepads by slot, in the order they were connected.
+  std::array<SDL_GameController*, kMaxGamepads> gamepads_ = {};
+};
@@ -0,0 +1,69 @@
+#include "InstancedParticleShader.h"
+
+#include <cstddef>
+
+#include "ShaderLibrary.h"
+#include "VertexFormat.h"
+
+InstancedParticleShader::InstancedParticleShader(ShaderLibrary& shaders, GLuint texture)
+    : texture_(texture), shader_(shaders.Get(GetInstancedParticleShaderSource())) {
+  // One quad as a triangle strip, instanced per particle.
+  static const GLfloat kCorners[] = {0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f};
+  static const VertexLayout kCornerLayout(2 * sizeof(GLfloat),
+                                          {{kPositionAttribute, 2, GL_FLOAT, GL_FALSE, 0}});
+  // The center and the size follow each other.
+  static const VertexLayout kInstanceLayout(
+      sizeof(Particle),
+      {
+          {kCenterAttribute, 4, GL_FLOAT, GL_FALSE, offsetof(Particle, center), 1},
+          {kColorAttribute, 3, GL_FLOAT, GL_FALSE, offsetof(Particle, color), 1},
+      });
+
+  shader_->Use();
+  shader_->SetUniform(shader_->GetUniform<int>("particleTexture"), 0);
+  model_uniform_ = shader_->GetUniform<glm::mat4>("model");
+
+  glGenVertexArrays(1, &vao_);
+  glGenBuffers(1, &corner_vbo_);
+  glGenBuffers(1, &instance_vbo_);
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, corner_vbo_);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(kCorners), kCorners, GL_STATIC_DRAW);
+  kCornerLayout.Apply();
+  glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+  kInstanceLayout.Apply();
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+InstancedParticleShader::~InstancedParticleShader() {
+  if (vao_) glDeleteVertexArrays(1, &vao_);
+  if (corner_vbo_) glDeleteBuffers(1, &corner_vbo_);
+  if (instance_vbo_) glDeleteBuffers(1, &instance_vbo_);
+}
+
+void InstancedParticleShader::Render(const glm::mat4& model,
+                                     const std::vector<Particle>& particles) const {
+  if (particles.empty()) return;
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_ONE, GL_ONE);
+  glDisable(GL_DEPTH_TEST);
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, texture_);
+
+  shader_->Use();
+  shader_->SetUniform(model_uniform_, model);
+
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+  // Orphan the previous buffer rather than waiting for it.
+  glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(Particle), particles.data(),
+               GL_STREAM_DRAW);
+  glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, particles.size());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+
+  glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "ParticleKernels.h"
+#include "Shader.h"
+
+class ShaderLibrary;
+
+// Same particles as ParticleShader, drawn as one quad instanced per particle:
+// the particles are uploaded as they are, 28 bytes each, and the vertex
+// shader places the corners. For the many small particles of the ball trails.
+class InstancedParticleShader {
+ public:
+  using Particle = BillboardParticle;
+
+  InstancedParticleShader(ShaderLibrary& shaders, GLuint texture);
+
+  ~InstancedParticleShader();
+
+  // The camera and the orientation of the billboards come from the per-frame
+  // uniform block.
+  void Render(const glm::mat4& model, const std::vector<Particle>& particles) const;
+
+ private:
+  GLuint texture_;
+  std::shared_ptr<Shader> shader_;
+  Uniform<glm::mat4> model_uniform_;
+  GLuint vao_ = 0;
+  GLuint corner_vbo_ = 0;
+  GLuint instance_vbo_ = 0;
+};
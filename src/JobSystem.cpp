@@ -0,0 +1,203 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+int JobGraph::Add(std::string name, std::function<void()> function, const JobAccess& access) {
+  const int job = static_cast<int>(jobs_.size());
+  jobs_.push_back({std::move(name), std::move(function), {}, {}, {}});
+  pending_.reset();
+
+  for (const void* resource : access.reads) {
+    ResourceState& state = resources_[resource];
+    if (state.writer >= 0) AddDependency(state.writer, job);
+  }
+  for (const void* resource : access.writes) {
+    ResourceState& state = resources_[resource];
+    if (state.writer >= 0) AddDependency(state.writer, job);
+    for (int reader : state.readers) AddDependency(reader, job);
+    state.writer = job;
+    state.readers.clear();
+  }
+  // After the writes, so that a job reading what it writes doesn't wait for
+  // itself.
+  for (const void* resource : access.reads) {
+    ResourceState& state = resources_[resource];
+    if (state.writer != job) state.readers.push_back(job);
+  }
+  return job;
+}
+
+void JobGraph::Clear() {
+  jobs_.clear();
+  resources_.clear();
+  pending_.reset();
+}
+
+void JobGraph::AddDependency(int predecessor, int successor) {
+  std::vector<int>& predecessors = jobs_[successor].predecessors;
+  if (predecessor == successor ||
+      std::find(predecessors.begin(), predecessors.end(), predecessor) != predecessors.end())
+    return;
+  predecessors.push_back(predecessor);
+  jobs_[predecessor].successors.push_back(successor);
+}
+
+std::vector<int> JobGraph::GetCriticalPath() const {
+  // Jobs only depend on earlier ones: the order of addition is topological.
+  std::vector<float> path_times(jobs_.size());
+  std::vector<int> previous(jobs_.size(), -1);
+  int last = -1;
+  for (int job = 0; job < static_cast<int>(jobs_.size()); ++job) {
+    float start = 0.0f;
+    for (int predecessor : jobs_[job].predecessors) {
+      if (path_times[predecessor] > start) {
+        start = path_times[predecessor];
+        previous[job] = predecessor;
+      }
+    }
+    path_times[job] = start + (jobs_[job].timing.end - jobs_[job].timing.start);
+    if (last < 0 || path_times[job] > path_times[last]) last = job;
+  }
+
+  std::vector<int> path;
+  for (int job = last; job >= 0; job = previous[job]) path.push_back(job);
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+float JobGraph::GetCriticalPathTime() const {
+  float time = 0.0f;
+  for (int job : GetCriticalPath()) time += jobs_[job].timing.end - jobs_[job].timing.start;
+  return time;
+}
+
+float JobGraph::GetTotalTime() const {
+  float time = 0.0f;
+  for (const Job& job : jobs_) time += job.timing.end - job.timing.start;
+  return time;
+}
+
+void JobGraph::WriteDot(std::ostream& out) const {
+  const std::vector<int> critical_path = GetCriticalPath();
+  auto is_critical = [&](int job) {
+    return std::find(critical_path.begin(), critical_path.end(), job) != critical_path.end();
+  };
+
+  out << "digraph jobs {\n  rankdir=LR;\n  node [shape=box];\n";
+  out << "  label=\"critical path " << GetCriticalPathTime() << " ms, total " << GetTotalTime()
+      << " ms\";\n";
+  for (int job = 0; job < static_cast<int>(jobs_.size()); ++job) {
+    const Timing& timing = jobs_[job].timing;
+    out << "  job" << job << " [label=\"" << jobs_[job].name << "\\n"
+        << timing.end - timing.start << " ms, thread " << timing.thread << "\"";
+    if (is_critical(job)) out << ", color=red";
+    out << "];\n";
+  }
+  for (int job = 0; job < static_cast<int>(jobs_.size()); ++job) {
+    for (int successor : jobs_[job].successors) {
+      out << "  job" << job << " -> job" << successor;
+      if (is_critical(job) && is_critical(successor)) out << " [color=red]";
+      out << ";\n";
+    }
+  }
+  out << "}\n";
+}
+
+JobSystem::JobSystem(int worker_count) {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+  worker_count = 0;
+#endif
+  for (int thread = 0; thread <= worker_count; ++thread)
+    queues_.push_back(std::make_unique<Queue>());
+  for (int thread = 1; thread <= worker_count; ++thread)
+    workers_.emplace_back(&JobSystem::WorkerLoop, this, thread);
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  run_started_.notify_all();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+void JobSystem::Run(JobGraph& graph) {
+  const int job_count = static_cast<int>(graph.jobs_.size());
+  if (job_count == 0) return;
+  if (!graph.pending_) graph.pending_ = std::make_unique<std::atomic<int>[]>(job_count);
+  for (int job = 0; job < job_count; ++job)
+    graph.pending_[job].store(graph.jobs_[job].predecessors.size(), std::memory_order_relaxed);
+
+  graph_ = &graph;
+  run_start_ = std::chrono::steady_clock::now();
+  remaining_jobs_.store(job_count, std::memory_order_relaxed);
+  // The workers steal the jobs ready from the start.
+  for (int job = 0; job < job_count; ++job)
+    if (graph.jobs_[job].predecessors.empty()) Push(0, job);
+
+  if (!workers_.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++run_count_;
+    }
+    run_started_.notify_all();
+  }
+  while (remaining_jobs_.load(std::memory_order_acquire) > 0)
+    if (!RunOneJob(0)) std::this_thread::yield();
+}
+
+void JobSystem::WorkerLoop(int thread) {
+  uint64_t run_count = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      run_started_.wait(lock, [&] { return is_stopping_ || run_count_ != run_count; });
+      if (is_stopping_) return;
+      run_count = run_count_;
+    }
+    // Runs are short, a tick's worth of work: spin until the end of this one.
+    while (remaining_jobs_.load(std::memory_order_acquire) > 0)
+      if (!RunOneJob(thread)) std::this_thread::yield();
+  }
+}
+
+bool JobSystem::RunOneJob(int thread) {
+  int job = -1;
+  {
+    Queue& queue = *queues_[thread];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.jobs.empty()) {
+      job = queue.jobs.back();
+      queue.jobs.pop_back();
+    }
+  }
+  for (size_t i = 1; job < 0 && i < queues_.size(); ++i) {
+    Queue& victim = *queues_[(thread + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      job = victim.jobs.front();
+      victim.jobs.pop_front();
+    }
+  }
+  if (job < 0) return false;
+
+  using Milliseconds = std::chrono::duration<float, std::milli>;
+  JobGraph::Job& current = graph_->jobs_[job];
+  current.timing.thread = thread;
+  current.timing.start = Milliseconds(std::chrono::steady_clock::now() - run_start_).count();
+  current.function();
+  current.timing.end = Milliseconds(std::chrono::steady_clock::now() - run_start_).count();
+
+  for (int successor : current.successors)
+    if (graph_->pending_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+      Push(thread, successor);
+  remaining_jobs_.fetch_sub(1, std::memory_order_release);
+  return true;
+}
+
+void JobSystem::Push(int thread, int job) {
+  Queue& queue = *queues_[thread];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  queue.jobs.push_back(job);
+}
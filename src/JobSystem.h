@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// What a job reads and writes, as the addresses of the objects it touches.
+struct JobAccess {
+  std::vector<const void*> reads;
+  std::vector<const void*> writes;
+};
+
+// Jobs and their dependencies, built once and run by JobSystem as often as
+// needed, e.g. every tick.
+//
+// Jobs are added in the order a single thread would run them. A job depends
+// on every earlier one writing what it reads or writes, or reading what it
+// writes, so that running the graph in parallel gives the serial result.
+class JobGraph {
+ public:
+  // Time of a job in the last run, in milliseconds from its start.
+  struct Timing {
+    float start = 0.0f;
+    float end = 0.0f;
+    int thread = 0;  // 0 is the thread calling Run(), then the workers.
+  };
+
+  // Returns the index of the job.
+  int Add(std::string name, std::function<void()> function, const JobAccess& access);
+  void Clear();
+
+  size_t GetSize() const { return jobs_.size(); }
+
+  // Tooling, for the last run.
+  const Timing& GetTiming(int job) const { return jobs_[job].timing; }
+  // Chain of dependent jobs that took the longest: no thread count could run
+  // the graph faster.
+  std::vector<int> GetCriticalPath() const;
+  float GetCriticalPathTime() const;
+  // Time of all jobs added up: the run time on a single thread.
+  float GetTotalTime() const;
+  // Graphviz graph of the jobs with their times and threads, and the critical
+  // path in red.
+  void WriteDot(std::ostream& out) const;
+
+ private:
+  friend class JobSystem;
+
+  struct Job {
+    std::string name;
+    std::function<void()> function;
+    std::vector<int> predecessors;
+    std::vector<int> successors;
+    Timing timing;
+  };
+
+  // Last writer of a resource, and the readers since.
+  struct ResourceState {
+    int writer = -1;
+    std::vector<int> readers;
+  };
+
+  void AddDependency(int predecessor, int successor);
+
+  std::vector<Job> jobs_;
+  std::unordered_map<const void*, ResourceState> resources_;
+  // Predecessors not finished yet, per job, during a run.
+  std::unique_ptr<std::atomic<int>[]> pending_;
+};
+
+// Runs job graphs on worker threads and the calling thread.
+//
+// Each thread has a queue of ready jobs. It pushes the jobs its own jobs made
+// ready, and runs them newest first while their data is in its cache. Threads
+// out of work steal the oldest jobs of the others.
+class JobSystem {
+ public:
+  // Without workers, graphs run serially on the calling thread.
+  explicit JobSystem(int worker_count);
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // Runs every job of the graph and returns once they are all done. Jobs run
+  // at most once at a time: don't call from a job.
+  void Run(JobGraph& graph);
+
+  int GetWorkerCount() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<int> jobs;
+  };
+
+  void WorkerLoop(int thread);
+  // Runs the thread's newest job, or one stolen from another thread. Returns
+  // false if there was none.
+  bool RunOneJob(int thread);
+  void Push(int thread, int job);
+
+  std::vector<std::unique_ptr<Queue>> queues_;  // By thread.
+  std::vector<std::thread> workers_;
+
+  JobGraph* graph_ = nullptr;
+  std::chrono::steady_clock::time_point run_start_;
+  std::atomic<int> remaining_jobs_{0};
+
+  // Wakes the workers for a run.
+  std::mutex mutex_;
+  std::condition_variable run_started_;
+  uint64_t run_count_ = 0;
+  bool is_stopping_ = false;
+};
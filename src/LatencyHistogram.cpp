@@ -0,0 +1,34 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <iostream>
+
+void LatencyHistogram::Add(int milliseconds) {
+  milliseconds = std::max(milliseconds, 0);
+  ++buckets_[std::min(milliseconds / kBucketWidth, kBucketCount - 1)];
+  ++count_;
+  sum_ += milliseconds;
+  max_ = std::max(max_, milliseconds);
+  if (count_ == kReportSize) Report();
+}
+
+void LatencyHistogram::Report() {
+  std::cout << name_ << ": " << count_ << " samples, mean " << sum_ / count_ << " ms, max " << max_
+            << " ms" << std::endl;
+  int largest = *std::max_element(buckets_.begin(), buckets_.end());
+  int last = kBucketCount - 1;
+  while (last > 0 && buckets_[last] == 0) --last;
+  for (int i = 0; i <= last; ++i) {
+    std::string label = std::to_string(i * kBucketWidth);
+    if (i == kBucketCount - 1)
+      label += "+";
+    else
+      label += "-" + std::to_string((i + 1) * kBucketWidth - 1);
+    label.resize(7, ' ');
+    std::cout << "  " << label << " ms |" << std::string(buckets_[i] * 40 / largest, '#') << " "
+              << buckets_[i] << std::endl;
+  }
+
+  buckets_.fill(0);
+  count_ = sum_ = max_ = 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+// Histogram of latencies in milliseconds, printed to stdout every kReportSize
+// samples.
+class LatencyHistogram {
+ public:
+  explicit LatencyHistogram(const std::string& name) : name_(name) {}
+
+  void Add(int milliseconds);
+
+ private:
+  static constexpr int kBucketWidth = 4;   // Milliseconds.
+  static constexpr int kBucketCount = 25;  // The last one counts everything above.
+  static constexpr int kReportSize = 50;
+
+  void Report();
+
+  std::string name_;
+  std::array<int, kBucketCount> buckets_ = {};
+  int count_ = 0;
+  int sum_ = 0;
+  int max_ = 0;
+};
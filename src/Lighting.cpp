@@ -0,0 +1,41 @@
+#include "Lighting.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include "ShaderLibrary.h"
+#include "VertexFormat.h"
+
+void BakeLighting(std::vector<LitVertex>& vertices, const glm::mat4& modelview) {
+  const glm::mat3 normal_matrix(modelview);
+  for (auto& vertex : vertices) {
+    // Same as the dynamic fragment shader, once per vertex.
+    glm::vec3 position(glm::unpackHalf1x16(vertex.position[0]),
+                       glm::unpackHalf1x16(vertex.position[1]),
+                       glm::unpackHalf1x16(vertex.position[2]));
+    glm::vec3 eye_position(modelview * glm::vec4(position, 1.0f));
+    glm::vec3 normal = glm::normalize(
+        normal_matrix * glm::vec3(glm::unpackSnorm3x10_1x2(vertex.normal)));
+    float diffuse = glm::max(glm::dot(normal, glm::normalize(kLightPosition - eye_position)), 0.0f);
+    vertex.light = PackHalf(kLightAmbient + kLightDiffuse * diffuse);
+  }
+}
+
+LitMaterial::LitMaterial(ShaderLibrary& shaders) {
+  const ShaderSource* sources[] = {&GetBakedLitShaderSource(), &GetLitShaderSource()};
+  for (int mode = 0; mode < 2; ++mode) {
+    Program& program = programs_[mode];
+    program.shader = shaders.Get(*sources[mode]);
+    program.model_uniform = program.shader->GetUniform<glm::mat4>("model");
+    program.color_uniform = program.shader->GetUniform<glm::vec3>("objectColor");
+  }
+}
+
+void LitMaterial::Use(LightingMode mode, const glm::mat4& model) const {
+  current_ = &programs_[static_cast<int>(mode)];
+  current_->shader->Use();
+  current_->shader->SetUniform(current_->model_uniform, model);
+}
+
+void LitMaterial::SetColor(const glm::vec3& color) const {
+  current_->shader->SetUniform(current_->color_uniform, color);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "Shader.h"
+
+class ShaderLibrary;
+struct LitVertex;
+
+// The scene's single white light, in eye space.
+constexpr glm::vec3 kLightPosition(30.0f, 50.0f, -100.0f);
+constexpr float kLightAmbient = 0.5f;
+constexpr float kLightDiffuse = 1.0f;
+
+// How the board and paddles are lit.
+enum class LightingMode {
+  // Per-vertex lighting computed once at load time: no lighting math per
+  // pixel, for fill-rate limited renderers.
+  kBaked,
+  // Per-pixel lighting computed every frame.
+  kDynamic,
+};
+
+// Computes the light of each vertex into LitVertex::light. The camera and light
+// don't move, so this is exact for static geometry and a close approximation
+// for geometry that only slides a little, like the paddles.
+void BakeLighting(std::vector<LitVertex>& vertices, const glm::mat4& modelview);
+
+// Programs drawing LitVertex geometry with a flat color, in either lighting
+// mode.
+class LitMaterial {
+ public:
+  explicit LitMaterial(ShaderLibrary& shaders);
+
+  // Makes the program of a lighting mode current, with an object's model
+  // matrix.
+  void Use(LightingMode mode, const glm::mat4& model) const;
+
+  // Color of what's drawn next, for the program last passed to Use().
+  void SetColor(const glm::vec3& color) const;
+
+ private:
+  struct Program {
+    std::shared_ptr<Shader> shader;
+    Uniform<glm::mat4> model_uniform;
+    Uniform<glm::vec3> color_uniform;
+  };
+
+  Program programs_[2];  // Indexed by LightingMode.
+  mutable const Program* current_ = nullptr;
+};
@@ -0,0 +1,78 @@
+#include "MatchState.h"
+
+#include <cstring>
+#include <glm/glm.hpp>
+
+#include "PongPhysics.h"
+#include "Random.h"
+
+static void Serve(MatchState& state, bool from_left) {
+  glm::vec2 position(state.ball_x, state.ball_y), speed;
+  ServeBall(position, speed, from_left, NextServeAngle(state.random_state));
+  state.ball_x = position.x;
+  state.ball_y = position.y;
+  state.ball_speed_x = speed.x;
+  state.ball_speed_y = speed.y;
+}
+
+static float GetPaddleSpeed(uint8_t input) {
+  if ((input & kInputUp) && !(input & kInputDown)) return kPaddleSpeed;
+  if ((input & kInputDown) && !(input & kInputUp)) return -kPaddleSpeed;
+  return 0.0f;
+}
+
+void ResetMatch(MatchState& state, uint64_t seed) {
+  state = MatchState();
+  state.random_state = SplitMix64(seed) | 1;
+  Serve(state, NextRandom(state.random_state) < 0.5f);
+}
+
+uint8_t StepMatch(MatchState& state, const uint8_t inputs[2], float dt) {
+  ++state.tick;
+  float left_speed = GetPaddleSpeed(inputs[0]);
+  float right_speed = GetPaddleSpeed(inputs[1]);
+  StepPaddle(state.left_y, left_speed, dt);
+  StepPaddle(state.right_y, right_speed, dt);
+
+  glm::vec2 position(state.ball_x, state.ball_y);
+  glm::vec2 speed(state.ball_speed_x, state.ball_speed_y);
+  const uint8_t events = StepBall(position, speed, &state.left_y, &state.right_y, dt);
+  state.ball_x = position.x;
+  state.ball_y = position.y;
+  state.ball_speed_x = speed.x;
+  state.ball_speed_y = speed.y;
+  if (!(events & (kBallPassedLeft | kBallPassedRight))) return events;
+
+  // Scored and served again on the side the ball passed, like in the game.
+  const bool passed_left = events & kBallPassedLeft;
+  int32_t& score = passed_left ? state.left_score : state.right_score;
+  score = AddPoint(score);
+  if (IsMatchWon(state.left_score, state.right_score) ||
+      IsMatchWon(state.right_score, state.left_score)) {
+    state.left_score = 0;
+    state.right_score = 0;
+  }
+  Serve(state, passed_left);
+  return events;
+}
+
+uint64_t HashMatch(const MatchState& state) {
+  // FNV-1a over the fields, leaving the padding out.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  auto add = [&hash](const auto& field) {
+    unsigned char bytes[sizeof(field)];
+    std::memcpy(bytes, &field, sizeof(field));
+    for (unsigned char byte : bytes) hash = (hash ^ byte) * 0x100000001b3ull;
+  };
+  add(state.random_state);
+  add(state.tick);
+  add(state.ball_x);
+  add(state.ball_y);
+  add(state.ball_speed_x);
+  add(state.ball_speed_y);
+  add(state.left_y);
+  add(state.right_y);
+  add(state.left_score);
+  add(state.right_score);
+  return hash;
+}
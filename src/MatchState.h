@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+// A two-player match reduced to what decides its future: plain data, saved and
+// restored by copy, stepped by fixed ticks from the players' inputs only. Two
+// machines running the same build step it identically, which network play
+// relies on.
+struct MatchState {
+  uint64_t random_state = 1;  // Serves, see NextRandom().
+  uint32_t tick = 0;          // Ticks played.
+  float ball_x = 0.0f;
+  float ball_y = 0.0f;
+  float ball_speed_x = 0.0f;
+  float ball_speed_y = 0.0f;
+  float left_y = 0.0f;
+  float right_y = 0.0f;
+  int32_t left_score = 0;
+  int32_t right_score = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<MatchState>);
+
+// What a player holds during a tick, as flags.
+enum PlayerInput : uint8_t {
+  kInputUp = 1 << 0,
+  kInputDown = 1 << 1,
+};
+
+// Starts a match, the ball served at random.
+void ResetMatch(MatchState& state, uint64_t seed);
+
+// Plays a tick of dt seconds with the inputs of the left and right players.
+// Returns BallEvent flags. A won match starts over, like in PongEnv.
+uint8_t StepMatch(MatchState& state, const uint8_t inputs[2], float dt);
+
+// Hash of every field, to compare the states of two machines.
+uint64_t HashMatch(const MatchState& state);
@@ -0,0 +1,113 @@
+#include "NetPlay.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "AudioMixer.h"
+#include "Board.h"
+#include "PaddleSystem.h"
+#include "PongPhysics.h"
+
+// After a stall, ticks are not caught up beyond this.
+constexpr int kMaxTicksPerUpdate = 3;
+
+constexpr Action kPaddleActions[] = {Action::kLeftPaddleUp, Action::kLeftPaddleDown,
+                                     Action::kRightPaddleUp, Action::kRightPaddleDown};
+
+NetPlay::NetPlay(World& world, Board& board, AudioMixer& audio, InputRouter& input,
+                 std::unique_ptr<UdpTransport> transport, bool is_left, uint64_t seed,
+                 int input_delay)
+    : world_(world),
+      board_(board),
+      audio_(audio),
+      transport_(std::move(transport)),
+      session_(*transport_, is_left, seed, 1.0f / kTickRate, input_delay) {
+  for (int bit = 0; bit < 4; ++bit) {
+    input.Subscribe(kPaddleActions[bit],
+                    [this, bit](const InputAction& action) { OnInput(bit, action); });
+  }
+  for (Ball& ball : world_.balls) ball.is_networked = true;
+  for (Paddle& paddle : world_.paddles) paddle.is_networked = true;
+  ApplyState();
+}
+
+NetPlay::~NetPlay() {
+  const RollbackStats& stats = session_.GetStats();
+  const int update_count = std::max(update_count_, 1);
+  std::cout << "Network match: " << stats.tick_count << " ticks, " << stats.rollback_count
+            << " rollbacks, " << stats.stall_count << " ticks waiting for the other player"
+            << std::endl;
+  std::cout << "Re-simulation per frame: "
+            << double(stats.total_resimulated_ticks) / update_count << " ticks, "
+            << stats.total_resimulation_time / update_count << " ms on average; "
+            << stats.max_resimulated_ticks << " ticks, " << stats.max_resimulation_time
+            << " ms at most" << std::endl;
+}
+
+JobAccess NetPlay::GetUpdateAccess() const {
+  return {{}, {&world_.balls, &world_.paddles, &board_, &audio_}};
+}
+
+void NetPlay::Update(float dt) {
+  ++update_count_;
+  resimulated_ticks_ = 0;
+  resimulation_time_ = 0.0f;
+  const float tick_time = 1.0f / kTickRate;
+  time_ = std::min(time_ + dt, kMaxTicksPerUpdate * tick_time);
+  for (; time_ >= tick_time; time_ -= tick_time) {
+    // While waiting for the other player, the tick is skipped.
+    if (!session_.AdvanceTick(GetInput())) continue;
+    const RollbackStats& stats = session_.GetStats();
+    resimulated_ticks_ += stats.resimulated_ticks;
+    resimulation_time_ += stats.resimulation_time;
+    PlayEvents(session_.GetEvents());
+  }
+  ApplyState();
+}
+
+void NetPlay::Snapshot(SceneSnapshot& snapshot) const {
+  snapshot.resimulated_ticks = resimulated_ticks_;
+  snapshot.resimulation_time = resimulation_time_;
+}
+
+void NetPlay::OnInput(int action_bit, const InputAction& input) {
+  if (input.is_pressed)
+    held_actions_ |= 1 << action_bit;
+  else
+    held_actions_ &= ~(1 << action_bit);
+}
+
+uint8_t NetPlay::GetInput() const {
+  // Up or down of either side.
+  const uint8_t up_actions = 1 << 0 | 1 << 2;
+  const uint8_t down_actions = 1 << 1 | 1 << 3;
+  return (held_actions_ & up_actions ? kInputUp : 0) |
+         (held_actions_ & down_actions ? kInputDown : 0);
+}
+
+void NetPlay::PlayEvents(uint8_t events) {
+  const MatchState& state = session_.GetState();
+  if (events & kBallWallBounce) audio_.Play(Sound::kWallBounce, 0.6f, Board::GetPan(state.ball_x));
+  for (Paddle& paddle : world_.paddles) {
+    if (events & (paddle.is_left ? kBallLeftPaddleHit : kBallRightPaddleHit)) {
+      PaddleSystem::Illuminate(paddle);
+      audio_.Play(Sound::kPaddleHit, 1.0f,
+                  Board::GetPan(paddle.is_left ? Board::GetLeft() : Board::GetRight()));
+    }
+  }
+  if (events & kBallPassedLeft) board_.ShowPoint(true);
+  if (events & kBallPassedRight) board_.ShowPoint(false);
+}
+
+void NetPlay::ApplyState() {
+  const MatchState& state = session_.GetState();
+  for (Ball& ball : world_.balls) {
+    ball.position = {state.ball_x, state.ball_y};
+    ball.speed = {state.ball_speed_x, state.ball_speed_y};
+  }
+  for (Paddle& paddle : world_.paddles) {
+    paddle.y = paddle.is_left ? state.left_y : state.right_y;
+    paddle.speed = 0.0f;  // Not extrapolated: a rollback may move it back.
+  }
+  board_.SetScores(state.left_score, state.right_score);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "IObject.h"
+#include "InputRouter.h"
+#include "RollbackSession.h"
+#include "UdpTransport.h"
+#include "World.h"
+
+class AudioMixer;
+class Board;
+
+// Match against a player on another machine: the local player moves a
+// paddle, with the keys of either side, and the match follows a
+// RollbackSession. The paddles and balls of the world are marked as networked:
+// their systems leave them to this object and only draw them.
+//
+// Scores go on from match to match: network matches don't end with a firework,
+// which each player could skip at a different time.
+class NetPlay : public IObject {
+ public:
+  // Ticks per second of the network match, whatever the simulation rate.
+  static constexpr int kTickRate = 60;
+
+  NetPlay(World& world, Board& board, AudioMixer& audio, InputRouter& input,
+          std::unique_ptr<UdpTransport> transport, bool is_left, uint64_t seed, int input_delay);
+  // Prints the statistics of the match.
+  virtual ~NetPlay();
+
+  // Implementation of IObject.
+  const char* GetName() const override { return "netplay"; }
+
+  // Moves the balls and paddles, and scores.
+  JobAccess GetUpdateAccess() const override;
+
+  // Plays the ticks due.
+  void Update(float dt) override;
+
+  // Copy the cost of the rollbacks.
+  void Snapshot(SceneSnapshot& snapshot) const override;
+
+  // Drawn by the other objects.
+  void Render(const SceneSnapshot&, const glm::mat4&, const glm::mat4&,
+              const glm::mat4&) const override {}
+
+ private:
+  void OnInput(int action_bit, const InputAction& input);
+  // PlayerInput of the keys held.
+  uint8_t GetInput() const;
+  // Sounds and lights of a tick.
+  void PlayEvents(uint8_t events);
+  // Copies the match into the world.
+  void ApplyState();
+
+  World& world_;
+  Board& board_;
+  AudioMixer& audio_;
+  std::unique_ptr<UdpTransport> transport_;
+  RollbackSession session_;
+  uint8_t held_actions_ = 0;  // Paddle actions, as bits.
+  float time_ = 0.0f;         // Not played yet, in seconds.
+
+  // Of the last update, for the performance overlay.
+  int resimulated_ticks_ = 0;
+  float resimulation_time_ = 0.0f;  // Milliseconds.
+  int update_count_ = 0;
+};
@@ -0,0 +1,222 @@
+#include "ObstacleField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Obstacles per leaf of the hierarchy.
+constexpr uint32_t kLeafSize = 4;
+// Deep enough for any balanced hierarchy of 32-bit indices.
+constexpr int kMaxDepth = 64;
+
+namespace {
+// Times when a point moving from origin by motion is in the box, from enter to
+// exit. axis is the one of the face entered, -1 if it starts inside along
+// both. Returns false if it isn't in the box between 0 and max_time.
+bool CrossBox(const glm::vec2& origin, const glm::vec2& motion, const glm::vec2& min,
+              const glm::vec2& max, float max_time, float& enter, int& axis) {
+  enter = -std::numeric_limits<float>::infinity();
+  float exit = std::numeric_limits<float>::infinity();
+  axis = -1;
+  for (int i = 0; i < 2; ++i) {
+    if (motion[i] == 0.0f) {
+      if (origin[i] < min[i] || origin[i] > max[i]) return false;
+      continue;
+    }
+    const float inverse = 1.0f / motion[i];
+    float low = (min[i] - origin[i]) * inverse;
+    float high = (max[i] - origin[i]) * inverse;
+    if (low > high) std::swap(low, high);
+    if (low > enter) {
+      enter = low;
+      axis = i;
+    }
+    exit = std::min(exit, high);
+  }
+  return enter <= exit && exit >= 0.0f && enter <= max_time;
+}
+
+std::runtime_error LayoutError(int line, const std::string& message) {
+  return std::runtime_error("Obstacle layout, line " + std::to_string(line) + ": " + message);
+}
+}  // namespace
+
+ObstacleField::ObstacleField(std::vector<Obstacle> obstacles) : obstacles_(std::move(obstacles)) {
+  std::vector<glm::vec2> mins, maxes;
+  mins.reserve(obstacles_.size());
+  maxes.reserve(obstacles_.size());
+  for (size_t i = 0; i < obstacles_.size(); ++i) {
+    Obstacle& obstacle = obstacles_[i];
+    obstacle.base_center = obstacle.center;
+    if (obstacle.period > 0.0f) moving_.push_back(static_cast<int>(i));
+    // Wherever it moves.
+    const glm::vec2 extent = glm::abs(obstacle.motion) + (obstacle.shape == Obstacle::Shape::kWall
+                                                              ? obstacle.half_size
+                                                              : glm::vec2(obstacle.radius));
+    mins.push_back(obstacle.center - extent);
+    maxes.push_back(obstacle.center + extent);
+    indices_.push_back(static_cast<uint32_t>(i));
+  }
+  if (obstacles_.empty()) return;
+  nodes_.reserve(2 * obstacles_.size() / kLeafSize + 1);
+  nodes_.push_back({});
+  Build(0, 0, static_cast<uint32_t>(indices_.size()), mins, maxes);
+}
+
+void ObstacleField::Build(uint32_t node, uint32_t begin, uint32_t end,
+                          const std::vector<glm::vec2>& mins,
+                          const std::vector<glm::vec2>& maxes) {
+  glm::vec2 min(std::numeric_limits<float>::max());
+  glm::vec2 max(-std::numeric_limits<float>::max());
+  for (uint32_t i = begin; i < end; ++i) {
+    min = glm::min(min, mins[indices_[i]]);
+    max = glm::max(max, maxes[indices_[i]]);
+  }
+  if (end - begin <= kLeafSize) {
+    nodes_[node] = {min, max, begin, end - begin};
+    return;
+  }
+
+  // Halves of the obstacles, split across the longer side by their centers.
+  const int axis = max.x - min.x >= max.y - min.y ? 0 : 1;
+  const uint32_t middle = begin + (end - begin) / 2;
+  std::nth_element(indices_.begin() + begin, indices_.begin() + middle, indices_.begin() + end,
+                   [&](uint32_t a, uint32_t b) {
+                     return mins[a][axis] + maxes[a][axis] < mins[b][axis] + maxes[b][axis];
+                   });
+  const uint32_t children = static_cast<uint32_t>(nodes_.size());
+  nodes_.resize(nodes_.size() + 2);
+  nodes_[node] = {min, max, children, 0};
+  Build(children, begin, middle, mins, maxes);
+  Build(children + 1, middle, end, mins, maxes);
+}
+
+void ObstacleField::SetTime(double time) {
+  constexpr double kTwoPi = 2.0 * 3.14159265358979323846;
+  for (int index : moving_) {
+    Obstacle& obstacle = obstacles_[index];
+    obstacle.center = obstacle.base_center +
+                      obstacle.motion * float(std::sin(kTwoPi * time / obstacle.period));
+  }
+}
+
+std::optional<ObstacleHit> ObstacleField::Sweep(const glm::vec2& position,
+                                                const glm::vec2& motion, float radius) const {
+  std::optional<ObstacleHit> hit;
+  if (nodes_.empty()) return hit;
+
+  // Depth first, skipping the boxes the ball misses or reaches after the
+  // nearest hit so far.
+  uint32_t stack[kMaxDepth];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0) {
+    const Node& node = nodes_[stack[--stack_size]];
+    float enter;
+    int axis;
+    if (!CrossBox(position, motion, node.min - radius, node.max + radius, hit ? hit->time : 1.0f,
+                  enter, axis))
+      continue;
+    if (node.count > 0) {
+      for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        SweepObstacle(indices_[i], position, motion, radius, hit);
+      continue;
+    }
+    // The child nearer along the motion first: its hits cut the other short.
+    const Node& first = nodes_[node.first];
+    const Node& second = nodes_[node.first + 1];
+    const bool is_second_nearer =
+        glm::dot(second.min + second.max - first.min - first.max, motion) < 0.0f;
+    stack[stack_size++] = node.first + (is_second_nearer ? 0 : 1);
+    stack[stack_size++] = node.first + (is_second_nearer ? 1 : 0);
+  }
+  return hit;
+}
+
+std::optional<ObstacleHit> ObstacleField::SweepEveryObstacle(const glm::vec2& position,
+                                                             const glm::vec2& motion,
+                                                             float radius) const {
+  std::optional<ObstacleHit> hit;
+  for (size_t i = 0; i < obstacles_.size(); ++i)
+    SweepObstacle(static_cast<int>(i), position, motion, radius, hit);
+  return hit;
+}
+
+void ObstacleField::SweepObstacle(int index, const glm::vec2& position, const glm::vec2& motion,
+                                  float radius, std::optional<ObstacleHit>& hit) const {
+  const Obstacle& obstacle = obstacles_[index];
+  const float max_time = hit ? hit->time : 1.0f;
+  if (obstacle.shape == Obstacle::Shape::kWall) {
+    // The wall grown by the radius, with square corners.
+    float enter;
+    int axis;
+    const glm::vec2 half_size = obstacle.half_size + radius;
+    if (!CrossBox(position, motion, obstacle.center - half_size, obstacle.center + half_size,
+                  max_time, enter, axis) ||
+        enter < 0.0f)
+      return;
+    glm::vec2 normal(0.0f);
+    normal[axis] = motion[axis] > 0.0f ? -1.0f : 1.0f;
+    hit = ObstacleHit{enter, normal, index};
+  } else {
+    // Where the center of the ball comes within both radii.
+    const glm::vec2 offset = position - obstacle.center;
+    const float distance = obstacle.radius + radius;
+    const float b = glm::dot(offset, motion);
+    const float c = glm::dot(offset, offset) - distance * distance;
+    if (c < 0.0f || b >= 0.0f) return;  // Inside, or moving away.
+    const float a = glm::dot(motion, motion);
+    const float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) return;
+    const float time = (-b - std::sqrt(discriminant)) / a;
+    if (time > max_time) return;
+    hit = ObstacleHit{time, glm::normalize(offset + motion * time), index};
+  }
+}
+
+std::vector<Obstacle> ReadObstacleLayout(std::istream& in) {
+  std::vector<Obstacle> obstacles;
+  std::string line;
+  for (int line_number = 1; std::getline(in, line); ++line_number) {
+    std::istringstream fields(line);
+    std::string shape;
+    if (!(fields >> shape) || shape[0] == '#') continue;
+
+    Obstacle obstacle;
+    if (shape == "wall") {
+      glm::vec2 size;
+      if (!(fields >> obstacle.center.x >> obstacle.center.y >> size.x >> size.y))
+        throw LayoutError(line_number, "expected wall <x> <y> <width> <height>");
+      if (size.x <= 0.0f || size.y <= 0.0f)
+        throw LayoutError(line_number, "walls need a width and a height");
+      obstacle.half_size = size * 0.5f;
+    } else if (shape == "bumper") {
+      obstacle.shape = Obstacle::Shape::kBumper;
+      if (!(fields >> obstacle.center.x >> obstacle.center.y >> obstacle.radius))
+        throw LayoutError(line_number, "expected bumper <x> <y> <radius>");
+      if (obstacle.radius <= 0.0f) throw LayoutError(line_number, "bumpers need a radius");
+    } else {
+      throw LayoutError(line_number, "unknown obstacle " + shape);
+    }
+
+    if (fields >> obstacle.motion.x) {
+      if (!(fields >> obstacle.motion.y >> obstacle.period) || obstacle.period <= 0.0f)
+        throw LayoutError(line_number, "expected a motion <x> <y> and a period in seconds");
+    }
+    std::string rest;
+    if (fields.clear(), fields >> rest)
+      throw LayoutError(line_number, "unexpected " + rest);
+    obstacles.push_back(obstacle);
+  }
+  return obstacles;
+}
+
+std::vector<Obstacle> LoadObstacleLayout(const char* file_name) {
+  std::ifstream file(file_name);
+  if (!file) throw std::runtime_error("Obstacle layout can't be opened: " + std::string(file_name));
+  return ReadObstacleLayout(file);
+}
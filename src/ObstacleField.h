@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <iosfwd>
+#include <optional>
+#include <vector>
+
+// Static or moving obstacle of the board, which balls bounce off.
+struct Obstacle {
+  enum class Shape : uint8_t {
+    kWall,    // Box of half_size around its center.
+    kBumper,  // Disc of radius around its center.
+  };
+
+  Shape shape = Shape::kWall;
+  glm::vec2 center{0.0f, 0.0f};  // Where it is now, see ObstacleField::SetTime().
+  glm::vec2 half_size{0.0f, 0.0f};
+  float radius = 0.0f;
+  // Moving obstacles go back and forth between base_center - motion and
+  // base_center + motion, over period seconds. Static ones have no period.
+  glm::vec2 base_center{0.0f, 0.0f};
+  glm::vec2 motion{0.0f, 0.0f};
+  float period = 0.0f;
+};
+
+// First obstacle in the way of a ball.
+struct ObstacleHit {
+  float time;        // Fraction of the motion before touching it.
+  glm::vec2 normal;  // Of its surface, toward the ball.
+  int obstacle;      // Index in ObstacleField::GetObstacles().
+};
+
+// Obstacles in a bounding volume hierarchy, so that finding those in the way
+// of a ball costs about the logarithm of their number. Moving obstacles are
+// bounded by the whole of their motion, so the hierarchy is built once and
+// only their centers change.
+class ObstacleField {
+ public:
+  explicit ObstacleField(std::vector<Obstacle> obstacles);
+
+  const std::vector<Obstacle>& GetObstacles() const { return obstacles_; }
+
+  // Moves the moving obstacles to where they are at time, in seconds.
+  void SetTime(double time);
+
+  // First obstacle that a ball of radius hits moving from position by motion,
+  // if any. Obstacles the ball is already in, e.g. pushed there by a moving
+  // one, let it out.
+  std::optional<ObstacleHit> Sweep(const glm::vec2& position, const glm::vec2& motion,
+                                   float radius) const;
+
+  // Same as Sweep(), testing every obstacle, for comparison.
+  std::optional<ObstacleHit> SweepEveryObstacle(const glm::vec2& position,
+                                                const glm::vec2& motion, float radius) const;
+
+  int GetNodeCount() const { return static_cast<int>(nodes_.size()); }
+
+ private:
+  // Box around obstacles: leaves hold count of them from first in indices_,
+  // inner nodes have their two children at first and first + 1.
+  struct Node {
+    glm::vec2 min;
+    glm::vec2 max;
+    uint32_t first;
+    uint32_t count;  // 0 for inner nodes.
+  };
+
+  // Builds the subtree of node over indices_[begin, end).
+  void Build(uint32_t node, uint32_t begin, uint32_t end,
+             const std::vector<glm::vec2>& mins, const std::vector<glm::vec2>& maxes);
+  // Keeps hit if the obstacle is hit earlier.
+  void SweepObstacle(int index, const glm::vec2& position, const glm::vec2& motion, float radius,
+                     std::optional<ObstacleHit>& hit) const;
+
+  std::vector<Obstacle> obstacles_;
+  std::vector<int> moving_;  // Indices of the moving obstacles.
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> indices_;  // Of obstacles, by leaf.
+};
+
+// Reads a layout: one obstacle per line, in board units, with optional motion.
+//   wall <x> <y> <width> <height> [<motion x> <motion y> <period>]
+//   bumper <x> <y> <radius> [<motion x> <motion y> <period>]
+// Lines starting with # are comments. Throws std::runtime_error on errors.
+std::vector<Obstacle> ReadObstacleLayout(std::istream& in);
+std::vector<Obstacle> LoadObstacleLayout(const char* file_name);
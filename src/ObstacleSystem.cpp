@@ -0,0 +1,72 @@
+#include "ObstacleSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Particles outlining the obstacles, about as far apart as they are wide.
+constexpr float kParticleSpacing = 1.5f;
+constexpr float kParticleSize = 1.2f;
+constexpr int kMaxParticlesPerSide = 64;
+constexpr float kObstacleZ = -2.0f;  // In the plane of the balls.
+
+ObstacleSystem::ObstacleSystem(ShaderLibrary& shaders, GLuint texture,
+                               std::vector<Obstacle> obstacles)
+    : field_(std::move(obstacles)), shader_(shaders, texture) {}
+
+void ObstacleSystem::Update(float dt) {
+  time_ += dt;
+  field_.SetTime(time_);
+}
+
+void ObstacleSystem::Snapshot(SceneSnapshot& snapshot) const {
+  const glm::vec3 wall_color(0.2f, 0.4f, 1.0f);
+  const glm::vec3 bumper_color(1.0f, 0.5f, 0.1f);
+  for (const Obstacle& obstacle : field_.GetObstacles()) {
+    if (obstacle.shape == Obstacle::Shape::kWall) {
+      // Along the edges of the box.
+      const glm::vec2 size = 2.0f * obstacle.half_size;
+      const glm::ivec2 counts(
+          std::clamp(int(std::ceil(size.x / kParticleSpacing)), 1, kMaxParticlesPerSide),
+          std::clamp(int(std::ceil(size.y / kParticleSpacing)), 1, kMaxParticlesPerSide));
+      const glm::vec2 corner = obstacle.center - obstacle.half_size;
+      for (int i = 0; i <= counts.x; ++i) {
+        const float x = corner.x + size.x * i / counts.x;
+        snapshot.obstacle_particles.push_back(
+            {glm::vec3(x, corner.y, kObstacleZ), kParticleSize, wall_color});
+        snapshot.obstacle_particles.push_back(
+            {glm::vec3(x, corner.y + size.y, kObstacleZ), kParticleSize, wall_color});
+      }
+      for (int i = 1; i < counts.y; ++i) {
+        const float y = corner.y + size.y * i / counts.y;
+        snapshot.obstacle_particles.push_back(
+            {glm::vec3(corner.x, y, kObstacleZ), kParticleSize, wall_color});
+        snapshot.obstacle_particles.push_back(
+            {glm::vec3(corner.x + size.x, y, kObstacleZ), kParticleSize, wall_color});
+      }
+    } else {
+      // A glow, ringed.
+      snapshot.obstacle_particles.push_back(
+          {glm::vec3(obstacle.center, kObstacleZ), obstacle.radius, bumper_color * 0.5f});
+      const float circumference = 2.0f * 3.14159265f * obstacle.radius;
+      const int count = std::clamp(int(std::ceil(circumference / kParticleSpacing)), 6,
+                                   kMaxParticlesPerSide);
+      for (int i = 0; i < count; ++i) {
+        const float angle = 2.0f * 3.14159265f * i / count;
+        const glm::vec2 position =
+            obstacle.center + obstacle.radius * glm::vec2(std::cos(angle), std::sin(angle));
+        snapshot.obstacle_particles.push_back(
+            {glm::vec3(position, kObstacleZ), kParticleSize, bumper_color});
+      }
+    }
+  }
+}
+
+void ObstacleSystem::Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4&,
+                            const glm::mat4&) const {
+  shader_.Render(model, snapshot.obstacle_particles);
+}
+
+void ObstacleSystem::Restore(const GameState& state) {
+  time_ = state.obstacle_time;
+  field_.SetTime(time_);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+#include "GameState.h"
+#include "IObject.h"
+#include "InstancedParticleShader.h"
+#include "ObstacleField.h"
+
+class ShaderLibrary;
+
+// Moves and draws the obstacles of the board. The balls bounce off them, see
+// BallSystem::SetObstacles().
+class ObstacleSystem : public IObject {
+ public:
+  ObstacleSystem(ShaderLibrary& shaders, GLuint texture, std::vector<Obstacle> obstacles);
+
+  const ObstacleField& GetField() const { return field_; }
+
+  // Implementation of IObject.
+  const char* GetName() const override { return "obstacles"; }
+
+  JobAccess GetUpdateAccess() const override { return {{}, {&field_}}; }
+
+  // Moves the moving obstacles.
+  void Update(float dt) override;
+
+  // Copy the particles outlining the obstacles.
+  void Snapshot(SceneSnapshot& snapshot) const override;
+
+  void Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4& view,
+              const glm::mat4& projection) const override;
+
+  // Save or restore where the moving obstacles are.
+  void Save(GameState& state) const { state.obstacle_time = time_; }
+  void Restore(const GameState& state);
+
+ private:
+  ObstacleField field_;
+  double time_ = 0.0;  // Seconds.
+  InstancedParticleShader shader_;
+};
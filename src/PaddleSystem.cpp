@@ -0,0 +1,330 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Copyright (c) 2003 Werner BEROUX
+ * Mail: werner@beroux.com
+ * Web : www.beroux.com
+ */
+
+#include "PaddleSystem.h"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+#include "Board.h"
+#include "PongPhysics.h"
+#include "Shader.h"
+#include "ShaderLibrary.h"
+#include "VertexFormat.h"
+
+constexpr float kPaddleBevel = 4.0f;
+constexpr float kPaddleIlluminate = 0.5f;
+constexpr float kPaddleIlluminateFade = 0.3f;
+// Without input for this long, in seconds, the AI plays.
+constexpr float kAiIdleTime = 8.0f;
+// Reaction time, in seconds, and aim error, in paddle heights, of the weakest
+// AI. Both shrink to 0 for the strongest.
+constexpr float kAiMaxReactionTime = 0.5f;
+constexpr float kAiMaxError = 1.5f;
+// Offset from the center of the paddle the strongest AI hits with.
+constexpr float kAiMaxAim = 0.35f;
+// An event older than this is applied as if it had just happened.
+constexpr float kMaxInputAge = 0.1f;
+
+using SteadyClock = std::chrono::steady_clock;
+
+// Paddle's center can't leave the board.
+static float ClampPosition(float y) {
+  return std::clamp(y, Board::GetBottom() + PaddleSystem::GetHeight() / 2.0f,
+                    Board::GetTop() - PaddleSystem::GetHeight() / 2.0f);
+}
+
+std::vector<LitVertex> PaddleSystem::MakeVertices(bool is_left) {
+  std::vector<LitVertex> vertices;
+  if (is_left) {
+    vertices.insert(
+        vertices.end(),
+        {
+            // Front face
+            {{Board::GetLeft(), GetHeight() / 2.0f, -kPaddleBevel}, {0.0f, 0.0f, -1.0f}},
+            {{Board::GetLeft(), -GetHeight() / 2.0f, -kPaddleBevel}, {0.0f, 0.0f, -1.0f}},
+            {{Board::GetLeft() - GetWidth(), GetHeight() / 2.0f, -kPaddleBevel},
+             {0.0f, 0.0f, -1.0f}},
+            {{Board::GetLeft() - GetWidth(), -GetHeight() / 2.0f, -kPaddleBevel},
+             {0.0f, 0.0f, -1.0f}},
+            // Left face
+            {{Board::GetLeft() - GetWidth(), GetHeight() / 2.0f, -kPaddleBevel},
+             {-1.0f, 0.0f, 0.0f}},
+            {{Board::GetLeft() - GetWidth(), -GetHeight() / 2.0f, -kPaddleBevel},
+             {-1.0f, 0.0f, 0.0f}},
+            {{Board::GetLeft() - GetWidth(), GetHeight() / 2.0f, 0}, {-1.0f, 0.0f, 0.0f}},
+            {{Board::GetLeft() - GetWidth(), -GetHeight() / 2.0f, 0}, {-1.0f, 0.0f, 0.0f}},
+            // Bottom face
+            {{Board::GetLeft(), -GetHeight() / 2.0f, -kPaddleBevel}, {0.0f, -1.0f, 0.0f}},
+            {{Board::GetLeft(), -GetHeight() / 2.0f, 0}, {0.0f, -1.0f, 0.0f}},
+            {{Board::GetLeft() - GetWidth(), -GetHeight() / 2.0f, -kPaddleBevel},
+             {0.0f, -1.0f, 0.0f}},
+            {{Board::GetLeft() - GetWidth(), -GetHeight() / 2.0f, 0}, {0.0f, -1.0f, 0.0f}},
+        });
+  } else {
+    vertices.insert(
+        vertices.end(),
+        {
+            // Front face
+            {{Board::GetRight() + GetWidth(), GetHeight() / 2.0f, -kPaddleBevel},
+             {0.0f, 0.0f, -1.0f}},
+            {{Board::GetRight() + GetWidth(), -GetHeight() / 2.0f, -kPaddleBevel},
+             {0.0f, 0.0f, -1.0f}},
+            {{Board::GetRight(), GetHeight() / 2.0f, -kPaddleBevel}, {0.0f, 0.0f, -1.0f}},
+            {{Board::GetRight(), -GetHeight() / 2.0f, -kPaddleBevel}, {0.0f, 0.0f, -1.0f}},
+            // Right face
+            {{Board::GetRight() + GetWidth(), GetHeight() / 2.0f, 0}, {1.0f, 0.0f, 0.0f}},
+            {{Board::GetRight() + GetWidth(), -GetHeight() / 2.0f, 0}, {1.0f, 0.0f, 0.0f}},
+            {{Board::GetRight() + GetWidth(), GetHeight() / 2.0f, -kPaddleBevel},
+             {1.0f, 0.0f, 0.0f}},
+            {{Board::GetRight() + GetWidth(), -GetHeight() / 2.0f, -kPaddleBevel},
+             {1.0f, 0.0f, 0.0f}},
+            // Bottom face
+            {{Board::GetRight() + GetWidth(), -GetHeight() / 2.0f, -kPaddleBevel},
+             {0.0f, -1.0f, 0.0f}},
+            {{Board::GetRight() + GetWidth(), -GetHeight() / 2.0f, 0}, {0.0f, -1.0f, 0.0f}},
+            {{Board::GetRight(), -GetHeight() / 2.0f, -kPaddleBevel}, {0.0f, -1.0f, 0.0f}},
+            {{Board::GetRight(), -GetHeight() / 2.0f, 0}, {0.0f, -1.0f, 0.0f}},
+        });
+  }
+  return vertices;
+}
+
+PaddleSystem::PaddleSystem(ShaderLibrary& shaders, World& world, InputRouter& input,
+                           const glm::mat4& view)
+    : world_(world), material_(shaders), gen_(std::random_device()()) {
+  for (bool is_left : {false, true}) {
+    input.Subscribe(is_left ? Action::kLeftPaddleUp : Action::kRightPaddleUp,
+                    [this, is_left](const InputAction& action) {
+                      OnInput(is_left, kPaddleSpeed, action);
+                    });
+    input.Subscribe(is_left ? Action::kLeftPaddleDown : Action::kRightPaddleDown,
+                    [this, is_left](const InputAction& action) {
+                      OnInput(is_left, -kPaddleSpeed, action);
+                    });
+  }
+
+  glGenVertexArrays(2, vaos_.data());
+  glGenBuffers(2, vbos_.data());
+  for (bool is_left : {false, true}) {
+    std::vector<LitVertex> vertices = MakeVertices(is_left);
+    vertex_counts_[is_left] = vertices.size();
+
+    // Baked at the middle of the board: paddles move too little, relative to
+    // the distance of the light, for it to show.
+    BakeLighting(vertices, view);
+
+    glBindVertexArray(vaos_[is_left]);
+    glBindBuffer(GL_ARRAY_BUFFER, vbos_[is_left]);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(LitVertex), vertices.data(),
+                 GL_STATIC_DRAW);
+    LitVertex::Layout().Apply();
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+}
+
+Entity PaddleSystem::Spawn(bool is_left) {
+  Entity entity = world_.Create();
+  Paddle& paddle = world_.paddles.Add(entity);
+  paddle.is_left = is_left;
+  PublishMotion(paddle, paddle.y, SteadyClock::now());
+  return entity;
+}
+
+void PaddleSystem::Restore(const GameState& state) {
+  gen_.SetState(state.paddle_random_state);
+  const SteadyClock::time_point now = SteadyClock::now();
+  for (Paddle& paddle : world_.paddles) PublishMotion(paddle, paddle.y, now);
+}
+
+void PaddleSystem::SetPaused(bool paused) {
+  if (paused == is_paused_) return;
+  is_paused_ = paused;
+  // The pause isn't time an input could have moved the paddles for.
+  const Uint32 ticks = SDL_GetTicks();
+  const SteadyClock::time_point now = SteadyClock::now();
+  for (Paddle& paddle : world_.paddles) {
+    paddle.last_update_ticks = ticks;
+    PublishMotion(paddle, paddle.y, now);
+  }
+}
+
+void PaddleSystem::SetTimeScale(double scale) {
+  time_scale_ = std::isinf(scale) ? 0.0f : static_cast<float>(scale);
+  const SteadyClock::time_point now = SteadyClock::now();
+  for (Paddle& paddle : world_.paddles) PublishMotion(paddle, paddle.y, now);
+}
+
+void PaddleSystem::TrackBall(Entity ball) {
+  for (Paddle& paddle : world_.paddles) paddle.ball = ball;
+}
+
+PaddleSystem::~PaddleSystem() {
+  glDeleteVertexArrays(2, vaos_.data());
+  glDeleteBuffers(2, vbos_.data());
+}
+
+JobAccess PaddleSystem::GetUpdateAccess() const {
+  return {{&world_.balls}, {&world_.paddles}};
+}
+
+void PaddleSystem::Update(float dt) {
+  for (Paddle& paddle : world_.paddles) {
+    if (!paddle.is_networked) {
+      paddle.time_since_last_input += dt;
+
+      const Ball* ball = world_.balls.Find(paddle.ball);
+      if (ball && paddle.time_since_last_input > kAiIdleTime) UpdateAi(paddle, *ball, dt);
+
+      // Update paddle position.
+      StepPaddle(paddle.y, paddle.speed, dt);
+    }
+
+    // Fade hightlight.
+    if (paddle.illuminate > 0.0f)
+      paddle.illuminate -= kPaddleIlluminateFade * dt;
+    else
+      paddle.illuminate = 0.0f;
+  }
+
+  const Uint32 ticks = SDL_GetTicks();
+  const SteadyClock::time_point now = SteadyClock::now();
+  for (Paddle& paddle : world_.paddles) {
+    paddle.last_update_ticks = ticks;
+    PublishMotion(paddle, paddle.y, now);
+  }
+}
+
+void PaddleSystem::UpdateAi(Paddle& paddle, const Ball& ball, float dt) {
+  if (paddle.ai_trajectory_revision != ball.trajectory_revision) {
+    // The ball was served or hit. The weaker the AI, the later it reacts and
+    // the farther from the ball it aims.
+    paddle.ai_trajectory_revision = ball.trajectory_revision;
+    const float weakness = 1.0f - ai_difficulty_;
+    paddle.ai_reaction_time = weakness * kAiMaxReactionTime;
+    const bool is_ball_coming = paddle.is_left == (ball.speed.x > 0.0f);
+    if (is_ball_coming) {
+      std::uniform_real_distribution<float> error(-1.0f, 1.0f);
+      // Off-center hits send the ball back at steeper angles.
+      std::uniform_real_distribution<float> aim(-kAiMaxAim, kAiMaxAim);
+      paddle.ai_target_y =
+          ball.predicted_y +
+          (weakness * kAiMaxError * error(gen_) + ai_difficulty_ * aim(gen_)) * GetHeight();
+    } else {
+      paddle.ai_target_y = 0.0f;  // Waits in the middle.
+    }
+  }
+
+  if (paddle.ai_reaction_time > 0.0f || dt <= 0.0f) {
+    paddle.ai_reaction_time -= dt;
+    paddle.speed = 0.0f;
+    return;
+  }
+  // Stops on the target rather than around it.
+  paddle.speed = std::clamp((paddle.ai_target_y - paddle.y) / dt, -kPaddleSpeed, kPaddleSpeed);
+}
+
+void PaddleSystem::ApplyInput(Paddle& paddle, float speed, Uint32 timestamp) {
+  // Key repeats and finger motions mostly confirm the current direction.
+  if (speed == paddle.speed) return;
+
+  // The next update moves the paddle at the new speed for the whole time since
+  // the last one. Correct for the part of it before the input, in game time.
+  float before_input =
+      std::clamp(time_scale_ * static_cast<Sint32>(timestamp - paddle.last_update_ticks) / 1000.0f,
+                 0.0f, kMaxInputAge);
+  float input_y = ClampPosition(paddle.y + paddle.speed * before_input);
+  paddle.y += (paddle.speed - speed) * before_input;
+  paddle.speed = speed;
+  paddle.last_input_timestamp = timestamp;
+
+  // Show it without waiting for the next update.
+  float input_age = std::clamp(static_cast<Sint32>(SDL_GetTicks() - timestamp) / 1000.0f, 0.0f,
+                               kMaxInputAge);
+  PublishMotion(paddle, input_y,
+                SteadyClock::now() - std::chrono::duration_cast<SteadyClock::duration>(
+                                         std::chrono::duration<float>(input_age)));
+}
+
+void PaddleSystem::PublishMotion(Paddle& paddle, float y, SteadyClock::time_point time) {
+  PaddleMotion& motion = paddle.latch->motion.GetWriteBuffer();
+  motion.y = y;
+  motion.speed = is_paused_ ? 0.0f : paddle.speed;
+  motion.time = time;
+  motion.time_scale = time_scale_;
+  motion.input_timestamp = paddle.last_input_timestamp;
+  paddle.latch->motion.Publish();
+}
+
+Uint32 PaddleSystem::TakeDrawnInputTimestamp(PaddleLatch& latch) {
+  const PaddleMotion& motion = latch.motion.GetReadBuffer();
+  if (motion.input_timestamp == latch.reported_input_timestamp) return 0;
+  latch.reported_input_timestamp = motion.input_timestamp;
+  return motion.input_timestamp;
+}
+
+void PaddleSystem::Snapshot(SceneSnapshot& snapshot) const {
+  for (const Paddle& paddle : world_.paddles)
+    snapshot.paddles.push_back({paddle.is_left, paddle.y, paddle.illuminate, paddle.latch.get()});
+}
+
+void PaddleSystem::Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4&,
+                          const glm::mat4&) const {
+  for (const SceneSnapshot::PaddleState& state : snapshot.paddles) {
+    // Late latch: rather than the snapshot's position, use the latest motion
+    // published, extrapolated to now. Input that arrived after the snapshot is
+    // shown this frame.
+    state.latch->motion.Acquire();
+    const PaddleMotion& motion = state.latch->motion.GetReadBuffer();
+    const float elapsed = std::chrono::duration<float>(SteadyClock::now() - motion.time).count();
+    float y = ClampPosition(motion.y + motion.speed * motion.time_scale * elapsed);
+
+    // Camera and light come from the per-frame uniform block.
+    material_.Use(snapshot.lighting_mode, glm::translate(model, glm::vec3(0.0f, y, 0.0f)));
+    material_.SetColor(glm::vec3(state.illuminate, 1.0f, state.illuminate));
+
+    glBindVertexArray(vaos_[state.is_left]);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, vertex_counts_[state.is_left]);
+  }
+  glBindVertexArray(0);
+}
+
+void PaddleSystem::OnInput(bool is_left, float speed, const InputAction& input) {
+  for (Paddle& paddle : world_.paddles) {
+    if (paddle.is_left != is_left || paddle.is_networked) continue;
+    paddle.time_since_last_input = 0.0f;
+    if (is_paused_) {
+      if (!input.is_pressed) paddle.speed = 0.0f;
+      continue;
+    }
+    // Releasing either direction stops the paddle.
+    ApplyInput(paddle, input.is_pressed ? speed : 0.0f, input.timestamp);
+  }
+}
+
+void PaddleSystem::Illuminate(Paddle& paddle) { paddle.illuminate = kPaddleIlluminate; }
@@ -0,0 +1,133 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Copyright (c) 2003 Werner BEROUX
+ * Mail: werner@beroux.com
+ * Web : www.beroux.com
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <random>
+#include <vector>
+
+#include "GameState.h"
+#include "IObject.h"
+#include "InputRouter.h"
+#include "Lighting.h"
+#include "PongPhysics.h"
+#include "Random.h"
+#include "Shader.h"
+#include "VertexFormat.h"
+#include "World.h"
+
+class ShaderLibrary;
+
+// Simulates and draws every paddle of the world.
+class PaddleSystem : public IObject {
+ public:
+  // Constructor. Static lighting is baked for the given camera view. Players
+  // move the paddles through the actions of the input router.
+  PaddleSystem(ShaderLibrary& shaders, World& world, InputRouter& input, const glm::mat4& view);
+  virtual ~PaddleSystem();
+
+  // Adds a paddle in front of the left or right border.
+  Entity Spawn(bool is_left);
+
+  // Makes the AI of every paddle follow a ball.
+  void TrackBall(Entity ball);
+
+  // While paused, no update runs: the paddles are shown still, and ignore
+  // presses. Releases still stop them for when play resumes.
+  void SetPaused(bool paused);
+
+  // Seconds of the game per real second, so that inputs and the late latch
+  // of the render thread place the paddles in game time. As fast as
+  // possible, the paddles are shown where the last update left them.
+  void SetTimeScale(double scale);
+
+  // From 0, slow and clumsy, to 1, quick and aiming at the paddle edges.
+  void SetAiDifficulty(float difficulty) { ai_difficulty_ = std::clamp(difficulty, 0.0f, 1.0f); }
+
+  // Save or restore the generator of the AI. The paddles are saved with the
+  // world.
+  void Save(GameState& state) const { state.paddle_random_state = gen_.GetState(); }
+  // Also shows the paddles where they were restored.
+  void Restore(const GameState& state);
+
+  // Implementation of IObject.
+  const char* GetName() const override { return "paddles"; }
+
+  // The AI follows the balls.
+  JobAccess GetUpdateAccess() const override;
+
+  // Update the paddles.
+  void Update(float fTime) override;
+
+  // Copy the positions and illuminations.
+  void Snapshot(SceneSnapshot& snapshot) const override;
+
+  // Render the paddles.
+  void Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4& view,
+              const glm::mat4& projection) const override;
+
+  // Attributes
+  static constexpr float GetWidth() { return kPaddleWidth; }
+
+  static constexpr float GetHeight() { return kPaddleHeight; }
+
+  // Illuminate paddle.
+  static void Illuminate(Paddle& paddle);
+
+  // Render thread: if the last frame drawn showed an input of the paddle the
+  // previous ones didn't, returns its SDL timestamp (ms), else 0. For latency
+  // measurement.
+  static Uint32 TakeDrawnInputTimestamp(PaddleLatch& latch);
+
+  // Implementation
+ private:
+  static std::vector<LitVertex> MakeVertices(bool is_left);
+
+  // Moves the paddle toward where the ball will cross its line.
+  void UpdateAi(Paddle& paddle, const Ball& ball, float dt);
+
+  // Moves the paddles of a side at a speed while the action is pressed.
+  void OnInput(bool is_left, float speed, const InputAction& input);
+
+  // Changes the speed as of an event's timestamp rather than as of the last
+  // update.
+  void ApplyInput(Paddle& paddle, float speed, Uint32 timestamp);
+
+  void PublishMotion(Paddle& paddle, float y, std::chrono::steady_clock::time_point time);
+
+  World& world_;
+  // Geometry of the right and left paddles.
+  std::array<GLuint, 2> vaos_ = {};
+  std::array<GLuint, 2> vbos_ = {};
+  std::array<int, 2> vertex_counts_ = {};
+  LitMaterial material_;
+  float ai_difficulty_ = 0.5f;
+  bool is_paused_ = false;
+  float time_scale_ = 1.0f;  // 0 as fast as possible.
+  Xorshift64 gen_;
+};
@@ -0,0 +1,252 @@
+#include "ParticleKernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <future>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+static_assert(offsetof(BillboardParticle, size) == sizeof(glm::vec3),
+              "The size must follow the center");
+static_assert(sizeof(BillboardVertex) == 20, "Unexpected billboard vertex size");
+
+namespace {
+constexpr float kFadeLife = 0.2f;
+
+size_t PadToLanes(size_t count) {
+  return (count + ParticleArrays::kLanes - 1) / ParticleArrays::kLanes * ParticleArrays::kLanes;
+}
+
+uint32_t PackColor(const glm::vec3& color) {
+  auto pack = [](float value) {
+    return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+  };
+  // Little-endian, like WebAssembly and the desktop targets: r is the first byte.
+  return pack(color.r) | pack(color.g) << 8 | pack(color.b) << 16 | 0xff000000u;
+}
+
+void SetTexcoord(BillboardVertex& vertex, uint8_t u, uint8_t v) {
+  vertex.texcoord[0] = u;
+  vertex.texcoord[1] = v;
+  vertex.padding[0] = vertex.padding[1] = 0;
+}
+}  // namespace
+
+ParticleArrays::ParticleArrays(size_t count)
+    : count(count),
+      x(PadToLanes(count)),
+      y(PadToLanes(count)),
+      z(PadToLanes(count)),
+      speed_x(PadToLanes(count)),
+      speed_y(PadToLanes(count)),
+      speed_z(PadToLanes(count)),
+      life(PadToLanes(count)),
+      initial_life(PadToLanes(count)),
+      size(PadToLanes(count)),
+      initial_size(PadToLanes(count)),
+      weight(PadToLanes(count)),
+      r(PadToLanes(count)),
+      g(PadToLanes(count)),
+      b(PadToLanes(count)),
+      initial_r(PadToLanes(count)),
+      initial_g(PadToLanes(count)),
+      initial_b(PadToLanes(count)),
+      active(PadToLanes(count)) {}
+
+void ParticleArrays::SetPosition(size_t i, const glm::vec3& position) {
+  x[i] = position.x;
+  y[i] = position.y;
+  z[i] = position.z;
+}
+
+void ParticleArrays::SetSpeed(size_t i, const glm::vec3& speed) {
+  speed_x[i] = speed.x;
+  speed_y[i] = speed.y;
+  speed_z[i] = speed.z;
+}
+
+void ParticleArrays::SetColor(size_t i, const glm::vec3& color) {
+  r[i] = initial_r[i] = color.r;
+  g[i] = initial_g[i] = color.g;
+  b[i] = initial_b[i] = color.b;
+}
+
+void UpdateParticlesScalar(ParticleArrays& p, size_t begin, size_t end, float dt, bool drag) {
+  for (size_t i = begin; i < end; ++i) {
+    if (!p.active[i]) continue;
+
+    const float life = p.life[i] / p.initial_life[i];
+    const float step = drag ? life * life * dt : dt;
+    p.x[i] += p.speed_x[i] * step;
+    p.y[i] += p.speed_y[i] * step;
+    p.z[i] += p.speed_z[i] * step;
+    p.speed_y[i] -= p.weight[i] * dt;
+    p.size[i] = p.initial_size[i] * life * life;
+    if (life < kFadeLife) {
+      const float alpha = life * 5.0f;
+      p.r[i] = p.initial_r[i] * alpha;
+      p.g[i] = p.initial_g[i] * alpha;
+      p.b[i] = p.initial_b[i] * alpha;
+    }
+    p.life[i] -= dt;
+  }
+}
+
+#ifdef __wasm_simd128__
+void UpdateParticlesSimd(ParticleArrays& p, size_t begin, size_t end, float dt, bool drag) {
+  assert(begin % ParticleArrays::kLanes == 0 && end % ParticleArrays::kLanes == 0);
+  const v128_t dt4 = wasm_f32x4_splat(dt);
+  const v128_t fade_life = wasm_f32x4_splat(kFadeLife);
+  const v128_t five = wasm_f32x4_splat(5.0f);
+
+  for (size_t i = begin; i < end; i += ParticleArrays::kLanes) {
+    const v128_t active = wasm_v128_load(&p.active[i]);
+    if (!wasm_v128_any_true(active)) continue;
+
+    // Inactive lanes are computed too, but never stored.
+    auto store = [](float* values, v128_t value, v128_t mask) {
+      wasm_v128_store(values, wasm_v128_bitselect(value, wasm_v128_load(values), mask));
+    };
+    const v128_t life4 = wasm_v128_load(&p.life[i]);
+    const v128_t life = wasm_f32x4_div(life4, wasm_v128_load(&p.initial_life[i]));
+    const v128_t life2 = wasm_f32x4_mul(life, life);
+    const v128_t step = drag ? wasm_f32x4_mul(life2, dt4) : dt4;
+    const v128_t speed_y = wasm_v128_load(&p.speed_y[i]);
+    store(&p.x[i], wasm_f32x4_add(wasm_v128_load(&p.x[i]),
+                                  wasm_f32x4_mul(wasm_v128_load(&p.speed_x[i]), step)),
+          active);
+    store(&p.y[i], wasm_f32x4_add(wasm_v128_load(&p.y[i]), wasm_f32x4_mul(speed_y, step)),
+          active);
+    store(&p.z[i], wasm_f32x4_add(wasm_v128_load(&p.z[i]),
+                                  wasm_f32x4_mul(wasm_v128_load(&p.speed_z[i]), step)),
+          active);
+    store(&p.speed_y[i],
+          wasm_f32x4_sub(speed_y, wasm_f32x4_mul(wasm_v128_load(&p.weight[i]), dt4)), active);
+    store(&p.size[i], wasm_f32x4_mul(wasm_v128_load(&p.initial_size[i]), life2), active);
+
+    const v128_t fade = wasm_v128_and(active, wasm_f32x4_lt(life, fade_life));
+    if (wasm_v128_any_true(fade)) {
+      const v128_t alpha = wasm_f32x4_mul(life, five);
+      store(&p.r[i], wasm_f32x4_mul(wasm_v128_load(&p.initial_r[i]), alpha), fade);
+      store(&p.g[i], wasm_f32x4_mul(wasm_v128_load(&p.initial_g[i]), alpha), fade);
+      store(&p.b[i], wasm_f32x4_mul(wasm_v128_load(&p.initial_b[i]), alpha), fade);
+    }
+    store(&p.life[i], wasm_f32x4_sub(life4, dt4), active);
+  }
+}
+#else
+void UpdateParticlesSimd(ParticleArrays& p, size_t begin, size_t end, float dt, bool drag) {
+  UpdateParticlesScalar(p, begin, end, dt, drag);
+}
+#endif
+
+void UpdateParticles(ParticleArrays& particles, float dt, bool drag) {
+  UpdateParticlesSimd(particles, 0, particles.active.size(), dt, drag);
+}
+
+void UpdateParticlesParallel(ParticleArrays& particles, float dt, bool drag, int thread_count) {
+  const size_t padded_count = particles.active.size();
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+  thread_count = 1;
+#endif
+  if (thread_count <= 1 || padded_count < thread_count * ParticleArrays::kLanes) {
+    UpdateParticles(particles, dt, drag);
+    return;
+  }
+
+  // Ranges of whole SIMD groups, so that no two threads share a group.
+  const size_t group_count = padded_count / ParticleArrays::kLanes;
+  auto range_begin = [&](int range) {
+    return group_count * range / thread_count * ParticleArrays::kLanes;
+  };
+  std::vector<std::future<void>> ranges;
+  ranges.reserve(thread_count - 1);
+  for (int range = 1; range < thread_count; ++range) {
+    ranges.push_back(std::async(std::launch::async, [&, range] {
+      UpdateParticlesSimd(particles, range_begin(range), range_begin(range + 1), dt, drag);
+    }));
+  }
+  UpdateParticlesSimd(particles, 0, range_begin(1), dt, drag);
+  for (auto& range : ranges) range.get();
+}
+
+void ExpandBillboardsScalar(const BillboardParticle* particles, size_t count,
+                            const glm::vec3& right, const glm::vec3& up,
+                            BillboardVertex* vertices) {
+  for (size_t i = 0; i < count; ++i) {
+    const BillboardParticle& particle = particles[i];
+    const uint32_t color = PackColor(particle.color);
+    const glm::vec3 corners[4] = {
+        particle.center + (-right + up) * particle.size,
+        particle.center + (-right - up) * particle.size,
+        particle.center + (right + up) * particle.size,
+        particle.center + (right - up) * particle.size,
+    };
+    for (int j = 0; j < 4; ++j) {
+      vertices[j].position = corners[j];
+      std::memcpy(vertices[j].color, &color, sizeof(color));
+    }
+    SetTexcoord(vertices[0], 0, 255);
+    SetTexcoord(vertices[1], 0, 0);
+    SetTexcoord(vertices[2], 255, 255);
+    SetTexcoord(vertices[3], 255, 0);
+    vertices += 4;
+  }
+}
+
+#ifdef __wasm_simd128__
+void ExpandBillboardsSimd(const BillboardParticle* particles, size_t count, const glm::vec3& right,
+                          const glm::vec3& up, BillboardVertex* vertices) {
+  const v128_t right4 = wasm_f32x4_make(right.x, right.y, right.z, 0.0f);
+  const v128_t up4 = wasm_f32x4_make(up.x, up.y, up.z, 0.0f);
+  // Texture coordinates and padding of the 4 corners.
+  constexpr uint32_t kTexcoords[4] = {0xff00, 0x0000, 0xffff, 0x00ff};
+
+  for (size_t i = 0; i < count; ++i) {
+    const BillboardParticle& particle = particles[i];
+    // The center in the first 3 lanes, the size in the last one.
+    const v128_t center = wasm_v128_load(&particle.center);
+    const v128_t size = wasm_i32x4_shuffle(center, center, 3, 3, 3, 3);
+    const v128_t scaled_right = wasm_f32x4_mul(right4, size);
+    const v128_t scaled_up = wasm_f32x4_mul(up4, size);
+    const v128_t left = wasm_f32x4_sub(center, scaled_right);
+    const v128_t right_side = wasm_f32x4_add(center, scaled_right);
+    const v128_t corners[4] = {
+        wasm_f32x4_add(left, scaled_up),
+        wasm_f32x4_sub(left, scaled_up),
+        wasm_f32x4_add(right_side, scaled_up),
+        wasm_f32x4_sub(right_side, scaled_up),
+    };
+
+    // The last lane of each corner becomes the color that follows the position.
+    const uint32_t color = PackColor(particle.color);
+    for (int j = 0; j < 4; ++j) {
+      wasm_v128_store(&vertices[j], wasm_i32x4_replace_lane(corners[j], 3, color));
+      std::memcpy(vertices[j].texcoord, &kTexcoords[j], sizeof(kTexcoords[j]));
+    }
+    vertices += 4;
+  }
+}
+#else
+void ExpandBillboardsSimd(const BillboardParticle* particles, size_t count, const glm::vec3& right,
+                          const glm::vec3& up, BillboardVertex* vertices) {
+  ExpandBillboardsScalar(particles, count, right, up, vertices);
+}
+#endif
+
+void ExpandBillboards(const BillboardParticle* particles, size_t count, const glm::vec3& right,
+                      const glm::vec3& up, BillboardVertex* vertices) {
+  ExpandBillboardsSimd(particles, count, right, up, vertices);
+}
+
+bool HasSimdParticleKernels() {
+#ifdef __wasm_simd128__
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Hot loops of the particle effects, with a portable scalar version and a
+// WebAssembly SIMD128 one (built with -msimd128). The plain names pick the
+// fastest version available.
+
+// Particle drawn as a camera-facing quad.
+struct BillboardParticle {
+  glm::vec3 center;
+  float size;  // Follows the center: SIMD kernels load both at once.
+  glm::vec3 color;
+};
+
+// Vertex of a billboard quad, 20 bytes.
+struct BillboardVertex {
+  glm::vec3 position;
+  uint8_t color[4];
+  uint8_t texcoord[2];
+  uint8_t padding[2];
+};
+
+// Particles stored as a structure of arrays, padded with inactive particles to
+// a multiple of kLanes so that kernels process kLanes particles at a time.
+struct ParticleArrays {
+  static constexpr size_t kLanes = 4;
+
+  explicit ParticleArrays(size_t count);
+
+  size_t GetCount() const { return count; }
+  glm::vec3 GetPosition(size_t i) const { return {x[i], y[i], z[i]}; }
+  glm::vec3 GetColor(size_t i) const { return {r[i], g[i], b[i]}; }
+  void SetPosition(size_t i, const glm::vec3& position);
+  void SetSpeed(size_t i, const glm::vec3& speed);
+  // Sets both the current and the initial color.
+  void SetColor(size_t i, const glm::vec3& color);
+
+  size_t count;
+  std::vector<float> x, y, z;
+  std::vector<float> speed_x, speed_y, speed_z;
+  std::vector<float> life, initial_life;
+  std::vector<float> size, initial_size;
+  std::vector<float> weight;
+  std::vector<float> r, g, b;
+  std::vector<float> initial_r, initial_g, initial_b;
+  std::vector<int32_t> active;  // 0 or ~0, a SIMD lane mask.
+};
+
+// Moves the active particles by dt under their weight, shrinks them and fades
+// them out over their last fifth of life. With drag, their speed decreases
+// with the square of their remaining life. Particles whose life drops below 0
+// are left active for the caller to recycle.
+void UpdateParticlesScalar(ParticleArrays& particles, size_t begin, size_t end, float dt,
+                           bool drag);
+void UpdateParticlesSimd(ParticleArrays& particles, size_t begin, size_t end, float dt, bool drag);
+void UpdateParticles(ParticleArrays& particles, float dt, bool drag);
+
+// Same as UpdateParticles(), split in contiguous ranges over thread_count
+// threads (the calling one included). Serial in builds without threads.
+void UpdateParticlesParallel(ParticleArrays& particles, float dt, bool drag, int thread_count);
+
+// Writes the 4 corners (top left, bottom left, top right, bottom right) of the
+// quad of each particle, facing the camera whose right and up vectors are
+// given.
+void ExpandBillboardsScalar(const BillboardParticle* particles, size_t count,
+                            const glm::vec3& right, const glm::vec3& up,
+                            BillboardVertex* vertices);
+void ExpandBillboardsSimd(const BillboardParticle* particles, size_t count, const glm::vec3& right,
+                          const glm::vec3& up, BillboardVertex* vertices);
+void ExpandBillboards(const BillboardParticle* particles, size_t count, const glm::vec3& right,
+                      const glm::vec3& up, BillboardVertex* vertices);
+
+// Whether the Simd kernels are vectorized in this build. They fall back to the
+// scalar ones otherwise.
+bool HasSimdParticleKernels();
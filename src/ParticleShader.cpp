@@ -3,80 +3,75 @@
 #include <glm/glm.hpp>
 #include <vector>
 
-namespace {
-const char* kParticleVertexShader = R"glsl(
-#version 300 es
-in vec3 aPos;
-in vec2 aTexCoord;
-in vec3 aColor;
-
-uniform mat4 modelview;
-uniform mat4 projection;
-
-out vec2 TexCoord;
-out vec3 ParticleColor;
-
-void main()
-{
-    gl_Position = projection * modelview * vec4(aPos, 1.0);
-    TexCoord = aTexCoord;
-    ParticleColor = aColor;
-}
-)glsl";
-
-const char* kParticleFragmentShader = R"glsl(
-#version 300 es
-precision mediump float;
-in vec2 TexCoord;
-in vec3 ParticleColor;
+#include "ShaderLibrary.h"
+#include "VertexFormat.h"
 
-uniform sampler2D particleTexture;
-
-out vec4 FragColor;
-
-void main()
-{
-    FragColor = texture(particleTexture, TexCoord) * vec4(ParticleColor, 1.0);
+namespace {
+// Two triangles (tl, bl, tr) and (tr, bl, br) per particle quad.
+template <typename Index>
+std::vector<Index> GenerateQuadIndices(int quad_count) {
+  std::vector<Index> indices;
+  indices.reserve(quad_count * 6);
+  for (int i = 0; i < quad_count; ++i) {
+    const Index first = static_cast<Index>(i * 4);
+    indices.insert(indices.end(), {first, Index(first + 1), Index(first + 2), Index(first + 2),
+                                   Index(first + 1), Index(first + 3)});
+  }
+  return indices;
 }
-)glsl";
 }  // namespace
 
-ParticleShader::ParticleShader(GLuint texture, int max_particle_count)
+ParticleShader::ParticleShader(ShaderLibrary& shaders, GLuint texture, int max_particle_count)
     : texture_(texture),
       max_particle_count_(max_particle_count),
-      shader_(kParticleVertexShader, kParticleFragmentShader) {
-  shader_.Use();
+      shader_(shaders.Get(GetParticleShaderSource())) {
+  static const VertexLayout kLayout(
+      sizeof(BillboardVertex),
+      {
+          {kPositionAttribute, 3, GL_FLOAT, GL_FALSE, offsetof(BillboardVertex, position)},
+          {kTexCoordAttribute, 2, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(BillboardVertex, texcoord)},
+          {kColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(BillboardVertex, color)},
+      });
+
+  shader_->Use();
+  shader_->SetUniform(shader_->GetUniform<int>("particleTexture"), 0);
+  model_uniform_ = shader_->GetUniform<glm::mat4>("model");
 
   glGenVertexArrays(1, &vao_);
   glGenBuffers(1, &vbo_);
+  glGenBuffers(1, &ebo_);
   glBindVertexArray(vao_);
   glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-  glBufferData(GL_ARRAY_BUFFER, max_particle_count * 6 * sizeof(ParticleVertex), nullptr,
+  glBufferData(GL_ARRAY_BUFFER, max_particle_count * 4 * sizeof(BillboardVertex), nullptr,
                GL_DYNAMIC_DRAW);
-  GLint posAttrib = shader_.GetAttributeLocation("aPos");
-  glEnableVertexAttribArray(posAttrib);
-  glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex),
-                        (void*)offsetof(ParticleVertex, position));
-  GLint texAttrib = shader_.GetAttributeLocation("aTexCoord");
-  glEnableVertexAttribArray(texAttrib);
-  glVertexAttribPointer(texAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex),
-                        (void*)offsetof(ParticleVertex, texcoord));
-  GLint colorAttrib = shader_.GetAttributeLocation("aColor");
-  glEnableVertexAttribArray(colorAttrib);
-  glVertexAttribPointer(colorAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex),
-                        (void*)offsetof(ParticleVertex, color));
+  kLayout.Apply();
+
+  // Quads never change topology, so the index buffer is static.
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+  if (max_particle_count * 4 <= 0x10000) {
+    index_type_ = GL_UNSIGNED_SHORT;
+    std::vector<GLushort> indices = GenerateQuadIndices<GLushort>(max_particle_count);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(),
+                 GL_STATIC_DRAW);
+  } else {
+    index_type_ = GL_UNSIGNED_INT;
+    std::vector<GLuint> indices = GenerateQuadIndices<GLuint>(max_particle_count);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(),
+                 GL_STATIC_DRAW);
+  }
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 ParticleShader::~ParticleShader() {
   if (vao_) glDeleteVertexArrays(1, &vao_);
   if (vbo_) glDeleteBuffers(1, &vbo_);
+  if (ebo_) glDeleteBuffers(1, &ebo_);
 }
 
 void ParticleShader::Render(const glm::mat4& model, const glm::mat4& view,
-                            const glm::mat4& projection,
                             const std::vector<Particle>& particles) const {
   assert(particles.size() <= max_particle_count_);
   if (particles.empty()) return;
@@ -85,26 +80,8 @@ void ParticleShader::Render(const glm::mat4& model, const glm::mat4& view,
   const glm::vec3 right(view[0][0], view[1][0], view[2][0]);
   const glm::vec3 up(view[0][1], view[1][1], view[2][1]);
 
-  std::vector<ParticleVertex> vertices;
-  vertices.reserve(particles.size() * 6);
-  for (const auto& part : particles) {
-    const glm::vec3 center = part.center;
-    const float size = part.size;
-    const glm::vec3 color = part.color;
-
-    const glm::vec3 tl = center + (-right + up) * size;
-    const glm::vec3 tr = center + (right + up) * size;
-    const glm::vec3 bl = center + (-right - up) * size;
-    const glm::vec3 br = center + (right - up) * size;
-
-    vertices.push_back({tl, {0, 1}, color});
-    vertices.push_back({bl, {0, 0}, color});
-    vertices.push_back({tr, {1, 1}, color});
-
-    vertices.push_back({tr, {1, 1}, color});
-    vertices.push_back({bl, {0, 0}, color});
-    vertices.push_back({br, {1, 0}, color});
-  }
+  vertices_.resize(particles.size() * 4);
+  ExpandBillboards(particles.data(), particles.size(), right, up, vertices_.data());
 
   glEnable(GL_BLEND);
   glBlendFunc(GL_ONE, GL_ONE);
@@ -113,15 +90,14 @@ void ParticleShader::Render(const glm::mat4& model, const glm::mat4& view,
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, texture_);
 
-  shader_.Use();
-  shader_.SetUniform("projection", projection);
-  shader_.SetUniform("modelview", model * view);
-  shader_.SetUniform("particleTexture", 0);
+  shader_->Use();
+  shader_->SetUniform(model_uniform_, model);
 
   glBindVertexArray(vao_);
   glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-  glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(ParticleVertex), vertices.data());
-  glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+  glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_.size() * sizeof(BillboardVertex),
+                  vertices_.data());
+  glDrawElements(GL_TRIANGLES, particles.size() * 6, index_type_, nullptr);
   glBindVertexArray(0);
 
   glEnable(GL_DEPTH_TEST);
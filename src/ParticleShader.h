@@ -3,33 +3,34 @@
 #include <memory>
 #include <vector>
 
+#include "ParticleKernels.h"
 #include "Shader.h"
 
+class ShaderLibrary;
+
 class ParticleShader {
  public:
-  struct Particle {
-    glm::vec3 center;
-    float size;
-    glm::vec3 color;
-  };
+  using Particle = BillboardParticle;
 
-  ParticleShader(GLuint texture, int max_particle_count);
+  ParticleShader(ShaderLibrary& shaders, GLuint texture, int max_particle_count);
 
   ~ParticleShader();
 
-  void Render(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+  // The view is only used to orient the billboards, the camera itself comes
+  // from the per-frame uniform block.
+  void Render(const glm::mat4& model, const glm::mat4& view,
               const std::vector<Particle>& particle) const;
 
  private:
-  struct ParticleVertex {
-    glm::vec3 position;
-    glm::vec2 texcoord;
-    glm::vec3 color;
-  };
-
   GLuint texture_;
   int max_particle_count_;
-  Shader shader_;
+  std::shared_ptr<Shader> shader_;
+  Uniform<glm::mat4> model_uniform_;
   GLuint vao_ = 0;
   GLuint vbo_ = 0;
+  GLuint ebo_ = 0;
+  GLenum index_type_ = GL_UNSIGNED_SHORT;
+  // 20 bytes instead of 32, and 4 vertices per particle instead of 6. Kept
+  // between frames to avoid allocations.
+  mutable std::vector<BillboardVertex> vertices_;
 };
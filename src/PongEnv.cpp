@@ -0,0 +1,134 @@
+#include "PongEnv.h"
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "PongPhysics.h"
+#include "Random.h"
+
+PongEnv::PongEnv(int env_count, float dt, int max_match_steps, int thread_count)
+    : env_count_(env_count),
+      dt_(dt),
+      max_match_steps_(max_match_steps),
+      ball_x_(env_count),
+      ball_y_(env_count),
+      ball_speed_x_(env_count),
+      ball_speed_y_(env_count),
+      left_y_(env_count),
+      right_y_(env_count),
+      left_score_(env_count),
+      right_score_(env_count),
+      step_count_(env_count),
+      random_state_(env_count, 1) {
+  thread_count = std::clamp(thread_count, 1, std::max(env_count, 1));
+  jobs_ = std::make_unique<JobSystem>(thread_count - 1);
+  // Ranges of matches touch separate data: the jobs are independent.
+  for (int range = 0; range < thread_count; ++range) {
+    const int begin = env_count * range / thread_count;
+    const int end = env_count * (range + 1) / thread_count;
+    step_graph_.Add("matches", [this, begin, end] { StepRange(begin, end); }, {});
+  }
+}
+
+void PongEnv::Reset(uint64_t seed, float* observations) {
+  for (int env = 0; env < env_count_; ++env) {
+    random_state_[env] = SplitMix64(seed + SplitMix64(env)) | 1;
+    ResetMatch(env);
+    Observe(env, observations + env * kObservationSize);
+  }
+}
+
+void PongEnv::Step(const int8_t* actions, float* observations, float* rewards, uint8_t* dones) {
+  actions_ = actions;
+  observations_ = observations;
+  rewards_ = rewards;
+  dones_ = dones;
+  jobs_->Run(step_graph_);
+}
+
+void PongEnv::ResetMatch(int env) {
+  left_y_[env] = 0.0f;
+  right_y_[env] = 0.0f;
+  left_score_[env] = 0;
+  right_score_[env] = 0;
+  step_count_[env] = 0;
+
+  glm::vec2 position(0.0f, 0.0f), speed;
+  Serve(env, NextRandom(random_state_[env]) < 0.5f, position, speed);
+  ball_x_[env] = position.x;
+  ball_y_[env] = position.y;
+  ball_speed_x_[env] = speed.x;
+  ball_speed_y_[env] = speed.y;
+}
+
+void PongEnv::Serve(int env, bool from_left, glm::vec2& position, glm::vec2& speed) {
+  ServeBall(position, speed, from_left, NextServeAngle(random_state_[env]));
+}
+
+void PongEnv::StepRange(int begin, int end) {
+  for (int env = begin; env < end; ++env) {
+    float left_speed = std::clamp<int>(actions_[2 * env], -1, 1) * kPaddleSpeed;
+    float right_speed = std::clamp<int>(actions_[2 * env + 1], -1, 1) * kPaddleSpeed;
+    StepPaddle(left_y_[env], left_speed, dt_);
+    StepPaddle(right_y_[env], right_speed, dt_);
+
+    glm::vec2 position(ball_x_[env], ball_y_[env]);
+    glm::vec2 speed(ball_speed_x_[env], ball_speed_y_[env]);
+    const uint8_t events = StepBall(position, speed, &left_y_[env], &right_y_[env], dt_);
+
+    float left_reward = 0.0f;
+    if (events & (kBallPassedLeft | kBallPassedRight)) {
+      const bool is_left_point = events & kBallPassedRight;
+      left_reward = is_left_point ? 1.0f : -1.0f;
+      // Scored on the side the ball passed, like Board::Score().
+      int& score = is_left_point ? right_score_[env] : left_score_[env];
+      score = AddPoint(score);
+      // The player who lost the point serves.
+      Serve(env, !is_left_point, position, speed);
+    }
+    ball_x_[env] = position.x;
+    ball_y_[env] = position.y;
+    ball_speed_x_[env] = speed.x;
+    ball_speed_y_[env] = speed.y;
+    rewards_[2 * env] = left_reward;
+    rewards_[2 * env + 1] = -left_reward;
+
+    uint8_t done = kRunning;
+    if (IsMatchWon(left_score_[env], right_score_[env]) ||
+        IsMatchWon(right_score_[env], left_score_[env]))
+      done = kMatchOver;
+    else if (++step_count_[env] == max_match_steps_)
+      done = kTruncated;
+    dones_[env] = done;
+    if (done != kRunning) ResetMatch(env);
+    Observe(env, observations_ + env * kObservationSize);
+  }
+}
+
+void PongEnv::Observe(int env, float* observation) const {
+  observation[kBallX] = ball_x_[env];
+  observation[kBallY] = ball_y_[env];
+  observation[kBallSpeedX] = ball_speed_x_[env];
+  observation[kBallSpeedY] = ball_speed_y_[env];
+  observation[kLeftPaddleY] = left_y_[env];
+  observation[kRightPaddleY] = right_y_[env];
+  observation[kLeftScore] = static_cast<float>(left_score_[env]);
+  observation[kRightScore] = static_cast<float>(right_score_[env]);
+}
+
+PongEnv* pong_env_create(int env_count, float dt, int max_match_steps, int thread_count) {
+  return new PongEnv(env_count, dt, max_match_steps, thread_count);
+}
+
+void pong_env_destroy(PongEnv* env) { delete env; }
+
+int pong_env_observation_size() { return PongEnv::kObservationSize; }
+
+void pong_env_reset(PongEnv* env, uint64_t seed, float* observations) {
+  env->Reset(seed, observations);
+}
+
+void pong_env_step(PongEnv* env, const int8_t* actions, float* observations, float* rewards,
+                   uint8_t* dones) {
+  env->Step(actions, observations, rewards, dones);
+}
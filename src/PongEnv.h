@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "JobSystem.h"
+
+// Headless matches for training paddle controllers, stepped together.
+//
+// Reset() and Step() write into buffers the caller owns, e.g. NumPy arrays,
+// without copies. Per match, in order:
+// - observations: kObservationSize floats, see Observation;
+// - actions: 2 int8, for the left then the right paddle: -1 down, 0 stop,
+//   1 up;
+// - rewards: 2 floats, for the left then the right player: 1 for winning a
+//   point, -1 for losing it;
+// - dones: 1 byte: 0, kMatchOver, or kTruncated.
+// A match that is done starts over within the same Step(): its observation is
+// the first of the next match, like in vectorized Gym environments.
+//
+// A point is won when the ball passes the opponent's paddle, and matches are
+// scored like the game: kLeftScore and kRightScore are the game's left and
+// right scores, the left one counting the balls that passed the left paddle,
+// so the points of the right player, and the other way round. The state is structure of arrays, so that a step is a
+// few loops over contiguous floats.
+class PongEnv {
+ public:
+  enum Observation {
+    kBallX,
+    kBallY,
+    kBallSpeedX,
+    kBallSpeedY,
+    kLeftPaddleY,
+    kRightPaddleY,
+    kLeftScore,
+    kRightScore,
+    kObservationSize,
+  };
+  enum Done : uint8_t { kRunning, kMatchOver, kTruncated };
+
+  // dt is the simulated time of a step, in seconds. Matches longer than
+  // max_match_steps are truncated, unless 0. Steps are split over
+  // thread_count threads, the calling one included.
+  PongEnv(int env_count, float dt = 1.0f / 60.0f, int max_match_steps = 0, int thread_count = 1);
+
+  int GetEnvCount() const { return env_count_; }
+
+  // Starts every match over. Matches are random, but the same for a seed.
+  void Reset(uint64_t seed, float* observations);
+
+  void Step(const int8_t* actions, float* observations, float* rewards, uint8_t* dones);
+
+ private:
+  void ResetMatch(int env);
+  // Serves at a random angle.
+  void Serve(int env, bool from_left, glm::vec2& position, glm::vec2& speed);
+  void StepRange(int begin, int end);
+  void Observe(int env, float* observation) const;
+
+  int env_count_;
+  float dt_;
+  int max_match_steps_;
+
+  // State, by match.
+  std::vector<float> ball_x_, ball_y_, ball_speed_x_, ball_speed_y_;
+  std::vector<float> left_y_, right_y_;
+  std::vector<int> left_score_, right_score_;
+  std::vector<int> step_count_;
+  std::vector<uint64_t> random_state_;
+
+  // Buffers of the running step.
+  const int8_t* actions_ = nullptr;
+  float* observations_ = nullptr;
+  float* rewards_ = nullptr;
+  uint8_t* dones_ = nullptr;
+
+  std::unique_ptr<JobSystem> jobs_;
+  JobGraph step_graph_;  // A job per range of matches.
+};
+
+// C interface, e.g. for Python's ctypes. See tools/pong_env.py.
+extern "C" {
+PongEnv* pong_env_create(int env_count, float dt, int max_match_steps, int thread_count);
+void pong_env_destroy(PongEnv* env);
+int pong_env_observation_size();
+void pong_env_reset(PongEnv* env, uint64_t seed, float* observations);
+void pong_env_step(PongEnv* env, const int8_t* actions, float* observations, float* rewards,
+                   uint8_t* dones);
+}
@@ -0,0 +1,127 @@
+#include "PongPhysics.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Part of the board covered by the balls at most.
+constexpr float kMaxBallCoverage = 0.15f;
+
+uint8_t StepBall(glm::vec2& position, glm::vec2& speed, const float* left_paddle_y,
+                 const float* right_paddle_y, float dt, float radius) {
+  uint8_t events = 0;
+  glm::vec2 new_position(position + speed * dt);
+  // Bounce top/bottom
+  if (new_position.y + radius > kBoardTop) {
+    speed.y = -speed.y;
+    new_position.y = 2.0f * (kBoardTop - radius) - new_position.y;
+    events |= kBallWallBounce;
+  } else if (new_position.y - radius < kBoardBottom) {
+    speed.y = -speed.y;
+    new_position.y = 2.0f * (kBoardBottom + radius) - new_position.y;
+    events |= kBallWallBounce;
+  }
+
+  if (new_position.x + radius > kBoardLeft - kPaddleWidth) {
+    // Left paddle collision detection.
+    // y = a*x + b
+    float a = speed.y / speed.x;
+    float b = position.y - a * position.x;
+    float y = a * (kBoardLeft - kPaddleWidth - radius) + b;
+
+    bool ball_is_touching_paddle_front_edge =
+        left_paddle_y && position.x + radius <= kBoardLeft - kPaddleWidth &&
+        y - radius <= *left_paddle_y + kPaddleHeight * 0.5f &&
+        y + radius >= *left_paddle_y - kPaddleHeight * 0.5f;
+    if (ball_is_touching_paddle_front_edge) {
+      // Bounce on the pad.
+      new_position.x = 2.0f * (kBoardLeft - kPaddleWidth - radius) - new_position.x;
+      double angle = (*left_paddle_y - new_position.y) / kPaddleHeight * kPi / 2.0f + kPi;
+
+      // Increase the ball's speed.
+      double new_speed = glm::length(speed) + kBallSpeedIncrease;
+      speed.x = float(cos(angle) * new_speed);
+      speed.y = float(sin(angle) * new_speed);
+      events |= kBallLeftPaddleHit;
+    } else if (new_position.x + radius > kBoardLeft) {
+      events |= kBallPassedLeft;
+    }
+  } else if (new_position.x - radius < kBoardRight + kPaddleWidth) {
+    // Right paddle collision detection.
+    // y = a*x + b
+    float a = speed.y / speed.x;
+    float b = position.y - a * position.x;
+    float y = a * (kBoardRight + kPaddleWidth + radius) + b;
+
+    bool ball_is_touching_paddle_front_edge =
+        right_paddle_y && position.x - radius >= kBoardRight + kPaddleWidth &&
+        y - radius <= *right_paddle_y + kPaddleHeight * 0.5f &&
+        y + radius >= *right_paddle_y - kPaddleHeight * 0.5f;
+    if (ball_is_touching_paddle_front_edge) {
+      // Bounce on the pad.
+      new_position.x = 2.0f * (kBoardRight + kPaddleWidth + radius) - new_position.x;
+      double angle = (new_position.y - *right_paddle_y) / kPaddleHeight * kPi / 2.0f;
+
+      // Increase the ball's speed.
+      double new_speed = glm::length(speed) + kBallSpeedIncrease;
+      speed.x = float(cos(angle) * new_speed);
+      speed.y = float(sin(angle) * new_speed);
+      events |= kBallRightPaddleHit;
+    } else if (new_position.x - radius < kBoardRight) {
+      events |= kBallPassedRight;
+    }
+  }
+
+  position = new_position;
+  return events;
+}
+
+void ServeBall(glm::vec2& position, glm::vec2& speed, bool from_left, float angle) {
+  if (from_left) {
+    angle += float(kPi);
+    position.x = kBoardLeft - kPaddleWidth;
+  } else {
+    position.x = kBoardRight + kPaddleWidth;
+  }
+  speed.x = std::cos(angle) * kBallSpeed;
+  speed.y = std::sin(angle) * kBallSpeed;
+}
+
+float GetBallRadius(int ball_count) {
+  const float board_area = (kBoardLeft - kBoardRight) * (kBoardTop - kBoardBottom);
+  const float radius = float(std::sqrt(kMaxBallCoverage * board_area / (kPi * ball_count)));
+  return std::min(kBallRadius, radius);
+}
+
+bool CollideBalls(glm::vec2& position_a, glm::vec2& speed_a, glm::vec2& position_b,
+                  glm::vec2& speed_b, float radius) {
+  const glm::vec2 offset = position_b - position_a;
+  const float distance_squared = glm::dot(offset, offset);
+  if (distance_squared >= 4.0f * radius * radius) return false;
+
+  // Balls on top of each other are split vertically.
+  const float distance = std::sqrt(distance_squared);
+  const glm::vec2 normal = distance > 0.0f ? offset / distance : glm::vec2(0.0f, 1.0f);
+  const glm::vec2 separation = normal * (radius - distance * 0.5f);
+  position_a -= separation;
+  position_b += separation;
+
+  const float approach_speed = glm::dot(speed_b - speed_a, normal);
+  if (approach_speed >= 0.0f) return false;
+  speed_a += normal * approach_speed;
+  speed_b -= normal * approach_speed;
+  return true;
+}
+
+void StepPaddle(float& y, float& speed, float dt) {
+  y += speed * dt;
+  if (y > kBoardTop - kPaddleHeight / 2.0f) {
+    y = kBoardTop - kPaddleHeight / 2.0f;
+    speed = 0.0f;
+  }
+  if (y < kBoardBottom + kPaddleHeight / 2.0f) {
+    y = kBoardBottom + kPaddleHeight / 2.0f;
+    speed = 0.0f;
+  }
+}
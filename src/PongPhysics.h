@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Random.h"
+
+// Rules of the game without graphics, sound or entities, shared by the
+// systems and by the headless training environment (PongEnv).
+
+// Board, in world units. The left border is at positive x.
+constexpr float kBoardTop = 48.0f;
+constexpr float kBoardBottom = -48.0f;
+constexpr float kBoardLeft = 64.0f;
+constexpr float kBoardRight = -64.0f;
+
+constexpr float kPaddleWidth = 6.0f;
+constexpr float kPaddleHeight = 20.0f;
+constexpr float kPaddleSpeed = 150.0f;
+
+constexpr float kBallRadius = 2.0f;
+constexpr float kBallSpeed = 110.0f;
+constexpr float kBallSpeedIncrease = 5.0f;
+// Serve angles, from the horizontal.
+constexpr float kBallMaxAngle = 3.14159265f / 3.0f;
+constexpr float kBallMinAngle = 3.14159265f / 7.0f;
+
+// What happened to a ball during a step, as a combination of flags.
+enum BallEvent : uint8_t {
+  kBallWallBounce = 1 << 0,
+  kBallLeftPaddleHit = 1 << 1,
+  kBallRightPaddleHit = 1 << 2,
+  kBallPassedLeft = 1 << 3,  // Missed by the left paddle: serve again.
+  kBallPassedRight = 1 << 4,
+};
+
+// Moves a ball for dt seconds, bouncing on the walls and on the paddles at
+// the given heights. A null paddle lets the ball through. Returns BallEvent
+// flags.
+uint8_t StepBall(glm::vec2& position, glm::vec2& speed, const float* left_paddle_y,
+                 const float* right_paddle_y, float dt, float radius = kBallRadius);
+
+// Radius of each of many balls: kBallRadius, or less so that they have room
+// to move.
+float GetBallRadius(int ball_count);
+
+// Bounces two balls of the same radius and mass off each other if they
+// overlap: they are pushed apart until they touch and, unless already moving
+// apart, exchange their speeds along the line between their centers. Returns
+// whether their speeds changed.
+bool CollideBalls(glm::vec2& position_a, glm::vec2& speed_a, glm::vec2& position_b,
+                  glm::vec2& speed_b, float radius);
+
+// Puts the ball in front of a paddle, going away from it at an angle from the
+// horizontal.
+void ServeBall(glm::vec2& position, glm::vec2& speed, bool from_left, float angle);
+
+// Uniform in [0, 1), from the state of a xorshift64* generator, which copies
+// with the rest of a match. Good enough for serves.
+inline float NextRandom(uint64_t& state) {
+  return (Xorshift64Star(state) >> 40) * (1.0f / (1 << 24));
+}
+
+// Serve angle, up or down, between kBallMinAngle and kBallMaxAngle.
+inline float NextServeAngle(uint64_t& random_state) {
+  const float angle = kBallMinAngle + NextRandom(random_state) * (kBallMaxAngle - kBallMinAngle);
+  return NextRandom(random_state) < 0.5f ? angle : -angle;
+}
+
+// Moves a paddle for dt seconds. It stops at the borders.
+void StepPaddle(float& y, float& speed, float dt);
+
+// Scores count like in tennis: 15, 30, 40, then by 10.
+inline int AddPoint(int score) { return score < 30 ? score + 15 : score + 10; }
+// A player wins with more than 40 and a lead of more than 10.
+inline bool IsMatchWon(int score, int other_score) {
+  return score > 40 && score - other_score > 10;
+}
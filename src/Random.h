@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// Small random generators, whose whole state is a word: it's saved, restored
+// and hashed with the rest of the game.
+
+// Spreads the bits of a seed, e.g. a match index, to start a generator.
+inline uint64_t SplitMix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// xorshift64*: advances the state, which must not be 0, and returns 64 bits.
+inline uint64_t Xorshift64Star(uint64_t& state) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545f4914f6cdd1dull;
+}
+
+// xorshift64* for the standard distributions, in place of std::mt19937 and
+// its 2.5 KB of state.
+class Xorshift64 {
+ public:
+  using result_type = uint64_t;
+
+  explicit Xorshift64(uint64_t seed = 0) : state_(SplitMix64(seed) | 1) {}
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+  result_type operator()() { return Xorshift64Star(state_); }
+
+  uint64_t GetState() const { return state_; }
+  void SetState(uint64_t state) { state_ = state ? state : 1; }
+
+ private:
+  uint64_t state_;
+};
@@ -0,0 +1,177 @@
+#include "RewindBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+
+namespace {
+using Words = std::array<uint32_t, sizeof(GameState) / sizeof(uint32_t)>;
+
+// Copies rather than casts, which compiles to the same loads.
+Words ToWords(const GameState& state) {
+  Words words;
+  std::memcpy(words.data(), &state, sizeof(state));
+  return words;
+}
+
+void PutVarint(std::vector<uint8_t>& out, uint32_t value) {
+  for (; value >= 0x80; value >>= 7) out.push_back(static_cast<uint8_t>(value | 0x80));
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+// Returns the end of the varint.
+uint8_t* PutVarint(uint8_t* out, uint32_t value) {
+  for (; value >= 0x80; value >>= 7) *out++ = static_cast<uint8_t>(value | 0x80);
+  *out++ = static_cast<uint8_t>(value);
+  return out;
+}
+
+uint32_t GetVarint(const uint8_t*& in) {
+  uint32_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    const uint8_t byte = *in++;
+    value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return value;
+  }
+}
+
+void ClearTrails(GameState& state) {
+  for (GameState::BallState& ball : state.balls) ball.trail = {};
+}
+}  // namespace
+
+RewindBuffer::RewindBuffer(size_t capacity) : data_(capacity) {
+  // Enough for a keyframe of varints of every word, whatever they hold, its
+  // size and its index.
+  assert(capacity >= sizeof(GameState) * 2 + sizeof(uint32_t) + sizeof(Keyframe));
+}
+
+void RewindBuffer::Record(const GameState& state) {
+  recorded_ = state;
+  ClearTrails(recorded_);
+  // The first tick kept must be a keyframe, even after the ticks are dropped.
+  const bool is_keyframe = IsEmpty() || end_tick_ % kKeyframeInterval == 0;
+  Encode(is_keyframe ? nullptr : &last_state_, recorded_);
+  Store(is_keyframe);
+  if (IsEmpty()) {
+    Encode(nullptr, recorded_);
+    Store(true);
+  }
+  last_state_ = recorded_;
+}
+
+bool RewindBuffer::Seek(int tick, GameState& state) const {
+  if (IsEmpty() || tick < GetFirstTick() || tick > GetLastTick()) return false;
+  Decode(tick, state);
+  for (GameState::BallState& ball : state.balls)
+    for (TrailParticle& particle : ball.trail) particle.life = -1.0f;
+  return true;
+}
+
+void RewindBuffer::Truncate(int tick) {
+  if (IsEmpty() || tick >= GetLastTick()) return;
+  if (tick < GetFirstTick()) {
+    Clear();
+    return;
+  }
+  while (keyframes_.back().tick > tick) keyframes_.pop_back();
+  write_position_ = Decode(tick, last_state_);
+  end_tick_ = tick + 1;
+}
+
+void RewindBuffer::Clear() {
+  keyframes_.clear();
+  end_tick_ = 0;
+  write_position_ = 0;
+}
+
+size_t RewindBuffer::GetUsedBytes() const {
+  if (IsEmpty()) return 0;
+  return write_position_ - keyframes_.front().position + GetIndexBytes(keyframes_.size());
+}
+
+void RewindBuffer::Encode(const GameState* previous, const GameState& state) {
+  // Not GameState{}, whose defaults aren't all zeros.
+  const Words previous_words = previous ? ToWords(*previous) : Words{};
+  const Words words = ToWords(state);
+  encoded_.clear();
+  uint32_t unchanged = 0;
+  for (int i = 0; i < kWordCount; ++i) {
+    const uint32_t changed_bits = previous_words[i] ^ words[i];
+    if (!changed_bits) {
+      ++unchanged;
+      continue;
+    }
+    PutVarint(encoded_, unchanged);
+    PutVarint(encoded_, changed_bits);
+    unchanged = 0;
+  }
+}
+
+void RewindBuffer::Store(bool is_keyframe) {
+  const uint64_t capacity = data_.size();
+  // Sizes are stored plus one: a 0 instead means the next tick is at the
+  // beginning of data_.
+  uint8_t prefix[5];
+  const uint32_t prefix_size =
+      PutVarint(prefix, static_cast<uint32_t>(encoded_.size()) + 1) - prefix;
+  const uint64_t size = prefix_size + encoded_.size();
+  // Ticks are contiguous: one that doesn't fit before the end of data_ starts
+  // over at its beginning.
+  uint64_t position = write_position_;
+  if (position % capacity + size > capacity) position += capacity - position % capacity;
+  // From the oldest tick to the end of this one, and the index with it.
+  auto needed_bytes = [&] {
+    return position + size - keyframes_.front().position +
+           GetIndexBytes(keyframes_.size() + is_keyframe);
+  };
+  while (!IsEmpty() && needed_bytes() > capacity) DropOldest();
+  if (IsEmpty() && !is_keyframe) return;  // Encoded again as a keyframe.
+
+  if (position != write_position_) data_[write_position_ % capacity] = 0;
+  std::copy(prefix, prefix + prefix_size, data_.begin() + position % capacity);
+  std::copy(encoded_.begin(), encoded_.end(), data_.begin() + position % capacity + prefix_size);
+  if (is_keyframe) keyframes_.push_back({position, end_tick_});
+  ++end_tick_;
+  write_position_ = position + size;
+}
+
+void RewindBuffer::DropOldest() {
+  // The deltas after a keyframe are of no use without it.
+  keyframes_.pop_front();
+}
+
+const uint8_t* RewindBuffer::ReadTick(uint64_t& position, uint32_t& size) const {
+  const uint8_t* in = data_.data() + position % data_.size();
+  if (*in == 0) {
+    position += data_.size() - position % data_.size();
+    in = data_.data();
+  }
+  const uint8_t* const start = in;
+  size = GetVarint(in) - 1;
+  position += (in - start) + size;
+  return in;
+}
+
+uint64_t RewindBuffer::Decode(int tick, GameState& state) const {
+  // The last keyframe at or before the tick.
+  const auto keyframe =
+      std::upper_bound(keyframes_.begin(), keyframes_.end(), tick,
+                       [](int tick, const Keyframe& keyframe) { return tick < keyframe.tick; }) -
+      1;
+
+  Words words = {};
+  uint64_t position = keyframe->position;
+  for (int i = keyframe->tick; i <= tick; ++i) {
+    uint32_t size;
+    const uint8_t* in = ReadTick(position, size);
+    const uint8_t* end = in + size;
+    for (uint32_t word = 0; in < end; ++word) {
+      word += GetVarint(in);
+      words[word] ^= GetVarint(in);
+    }
+  }
+  std::memcpy(static_cast<void*>(&state), words.data(), sizeof(state));
+  return position;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "GameState.h"
+
+// History of the last ticks of a game, within a fixed number of bytes, for
+// rewinding. Each tick is a GameState XORed with the one before, as varints of
+// the changed words and of the runs of unchanged ones; every kKeyframeInterval
+// ticks, a keyframe is XORed with nothing. A tick is read back from the
+// keyframe before it, so seeking anywhere costs at most an interval of deltas.
+//
+// Ticks follow each other in a ring, each after a varint of its size, so only
+// the keyframes are indexed, and the index counts against the capacity too.
+//
+// When full, the oldest ticks are dropped, a keyframe interval at a time.
+// Trails are left out: the particles of the states read back are burnt out, so
+// that they start over from the balls.
+class RewindBuffer {
+ public:
+  static constexpr int kKeyframeInterval = 60;
+
+  explicit RewindBuffer(size_t capacity);
+
+  // Appends the next tick.
+  void Record(const GameState& state);
+
+  // Reads a tick between GetFirstTick() and GetLastTick(). Returns false for
+  // other ticks.
+  bool Seek(int tick, GameState& state) const;
+
+  // Drops the ticks after this one: the next one recorded follows it.
+  void Truncate(int tick);
+
+  void Clear();
+
+  bool IsEmpty() const { return keyframes_.empty(); }
+  int GetFirstTick() const { return IsEmpty() ? end_tick_ : keyframes_.front().tick; }
+  int GetLastTick() const { return end_tick_ - 1; }
+  size_t GetCapacity() const { return data_.size(); }
+  // Bytes held by the ticks, including what's left unused where they wrap, and
+  // by the keyframe index.
+  size_t GetUsedBytes() const;
+
+ private:
+  static constexpr int kWordCount = sizeof(GameState) / sizeof(uint32_t);
+  static_assert(sizeof(GameState) % sizeof(uint32_t) == 0);
+
+  // Where a keyframe is in data_, as a position that keeps growing as data_
+  // wraps.
+  struct Keyframe {
+    uint64_t position;
+    int tick;
+  };
+
+  // Encodes the XOR of two states into encoded_, or the state alone for a
+  // keyframe.
+  void Encode(const GameState* previous, const GameState& state);
+  // Stores encoded_ after the last tick, dropping the oldest ones to make room.
+  void Store(bool is_keyframe);
+  void DropOldest();
+  // Bytes of the keyframe index with this many keyframes.
+  static size_t GetIndexBytes(size_t keyframe_count) { return keyframe_count * sizeof(Keyframe); }
+  // The changes of the tick at position, their size in size. Moves position
+  // past the tick.
+  const uint8_t* ReadTick(uint64_t& position, uint32_t& size) const;
+  // The state of a tick kept, trails left out. Returns the position after it.
+  uint64_t Decode(int tick, GameState& state) const;
+
+  std::vector<uint8_t> data_;
+  std::deque<Keyframe> keyframes_;
+  int end_tick_ = 0;  // After the last tick.
+  uint64_t write_position_ = 0;
+  GameState last_state_{};  // Last recorded, which the next tick is XORed with.
+  GameState recorded_{};    // Reused by Record().
+  std::vector<uint8_t> encoded_;
+};
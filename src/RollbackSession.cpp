@@ -0,0 +1,214 @@
+#include "RollbackSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "UdpTransport.h"
+
+// Datagram, in the byte order of the machines:
+//   magic, sender's tick, sender's advantage, ack, hash tick, hash,
+//   first input tick, input count, inputs (1 byte each).
+constexpr uint32_t kDatagramMagic = 0x4e504c47;  // "GLPN"
+constexpr size_t kMaxDatagramSize = 64 + 256;
+
+namespace {
+template <typename T>
+void Write(uint8_t*& out, const T& value) {
+  std::memcpy(out, &value, sizeof(value));
+  out += sizeof(value);
+}
+
+// Returns false past the end.
+template <typename T>
+bool Read(const uint8_t*& in, const uint8_t* end, T& value) {
+  if (end - in < static_cast<ptrdiff_t>(sizeof(value))) return false;
+  std::memcpy(&value, in, sizeof(value));
+  in += sizeof(value);
+  return true;
+}
+}  // namespace
+
+RollbackSession::RollbackSession(UdpTransport& transport, bool is_left, uint64_t seed,
+                                 float tick_time, int input_delay)
+    : transport_(transport),
+      local_index_(is_left ? 0 : 1),
+      tick_time_(tick_time),
+      // Inputs of the first ticks, before the delayed ones, are none for both
+      // players.
+      local_input_end_(input_delay),
+      remote_input_end_(input_delay),
+      remote_ack_(input_delay) {
+  ResetMatch(state_, seed);
+}
+
+bool RollbackSession::AdvanceTick(uint8_t local_input) {
+  events_ = 0;
+  stats_.resimulated_ticks = 0;
+  stats_.resimulation_time = 0.0f;
+  ReceiveDatagrams();
+  Rollback();
+  HashConfirmedStates();
+
+  // Predicting too far would make rollbacks long. Local inputs can't be
+  // overwritten before the remote player has them.
+  bool can_advance = state_.tick < remote_input_end_ + kMaxPrediction &&
+                     local_input_end_ - remote_ack_ < kHistorySize;
+  if (!can_advance) {
+    ++stats_.stall_count;
+  } else if (IsTooFarAhead()) {
+    can_advance = false;
+    ticks_since_sync_wait_ = 0;
+    ++stats_.sync_wait_count;
+  }
+
+  if (can_advance) {
+    inputs_[local_input_end_ % kHistorySize][local_index_] = local_input;
+    ++local_input_end_;
+    events_ = Simulate();
+    ++stats_.tick_count;
+    ++ticks_since_sync_wait_;
+  }
+  SendInputs();
+  return can_advance;
+}
+
+void RollbackSession::ReceiveDatagrams() {
+  uint8_t datagram[kMaxDatagramSize];
+  while (size_t size = transport_.Receive(datagram, sizeof(datagram)))
+    ReadDatagram(datagram, size);
+}
+
+void RollbackSession::ReadDatagram(const uint8_t* data, size_t size) {
+  const uint8_t* end = data + size;
+  uint32_t magic, tick, ack, first_tick;
+  int32_t advantage;
+  TickHash hash;
+  uint8_t input_count;
+  if (!Read(data, end, magic) || magic != kDatagramMagic || !Read(data, end, tick) ||
+      !Read(data, end, advantage) || !Read(data, end, ack) || !Read(data, end, hash.tick) ||
+      !Read(data, end, hash.hash) || !Read(data, end, first_tick) ||
+      !Read(data, end, input_count) || end - data < input_count)
+    return;
+
+  // Datagrams may arrive out of order.
+  if (tick >= remote_tick_) {
+    remote_tick_ = tick;
+    remote_advantage_ = advantage;
+  }
+  remote_ack_ = std::max(remote_ack_, std::min(ack, local_input_end_));
+  if (hash.tick) CheckHash(hash);
+
+  // Inputs follow those already received, unless some are missing.
+  if (first_tick > remote_input_end_) return;
+  for (uint32_t input_tick = first_tick; input_tick < first_tick + input_count; ++input_tick) {
+    const uint8_t input = data[input_tick - first_tick];
+    if (input_tick < remote_input_end_) continue;
+    // Too far ahead of the history, from a broken peer.
+    if (input_tick >= state_.tick + kHistorySize - kMaxPrediction) break;
+
+    uint8_t& played_input = inputs_[input_tick % kHistorySize][1 - local_index_];
+    if (input_tick < state_.tick && played_input != input)
+      rollback_tick_ = std::min(rollback_tick_, input_tick);
+    played_input = input;
+    remote_input_end_ = input_tick + 1;
+  }
+}
+
+void RollbackSession::Rollback() {
+  if (rollback_tick_ >= state_.tick) return;
+
+  const auto start = std::chrono::steady_clock::now();
+  const uint32_t end_tick = state_.tick;
+  state_ = saved_states_[rollback_tick_ % kHistorySize];
+  while (state_.tick < end_tick) Simulate();
+  const float time =
+      std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  const int tick_count = end_tick - rollback_tick_;
+  stats_.resimulated_ticks = tick_count;
+  stats_.resimulation_time = time;
+  ++stats_.rollback_count;
+  stats_.total_resimulated_ticks += tick_count;
+  stats_.total_resimulation_time += time;
+  stats_.max_resimulated_ticks = std::max(stats_.max_resimulated_ticks, tick_count);
+  stats_.max_resimulation_time = std::max(stats_.max_resimulation_time, time);
+  rollback_tick_ = kNoRollback;
+}
+
+uint8_t RollbackSession::Simulate() {
+  const uint32_t tick = state_.tick;
+  std::array<uint8_t, 2>& inputs = inputs_[tick % kHistorySize];
+  // The remote player keeps doing what they did last.
+  if (tick >= remote_input_end_) {
+    inputs[1 - local_index_] =
+        remote_input_end_ ? inputs_[(remote_input_end_ - 1) % kHistorySize][1 - local_index_] : 0;
+  }
+  saved_states_[tick % kHistorySize] = state_;
+  return StepMatch(state_, inputs.data(), tick_time_);
+}
+
+void RollbackSession::HashConfirmedStates() {
+  // States at the start of ticks whose inputs are all received.
+  const uint32_t confirmed_tick = std::min(state_.tick, remote_input_end_);
+  for (; next_hashed_tick_ <= confirmed_tick; next_hashed_tick_ += kHashInterval) {
+    const MatchState& state = next_hashed_tick_ == state_.tick
+                                  ? state_
+                                  : saved_states_[next_hashed_tick_ % kHistorySize];
+    TickHash& hash = local_hashes_[next_hashed_tick_ / kHashInterval % kHashHistorySize];
+    hash = {next_hashed_tick_, HashMatch(state)};
+    if (pending_remote_hash_.tick == hash.tick) CheckHash(pending_remote_hash_);
+  }
+}
+
+void RollbackSession::CheckHash(const TickHash& remote_hash) {
+  // Each hash comes in many datagrams.
+  if (remote_hash.tick <= last_checked_hash_tick_) return;
+  const TickHash& local_hash = local_hashes_[remote_hash.tick / kHashInterval % kHashHistorySize];
+  if (local_hash.tick != remote_hash.tick) {
+    // Checked once ours is known, unless a later one comes first.
+    if (remote_hash.tick > local_hash.tick && remote_hash.tick > pending_remote_hash_.tick)
+      pending_remote_hash_ = remote_hash;
+    return;
+  }
+
+  last_checked_hash_tick_ = remote_hash.tick;
+  ++stats_.checked_hash_count;
+  if (local_hash.hash != remote_hash.hash && stats_.desync_tick < 0) {
+    stats_.desync_tick = remote_hash.tick;
+    std::cerr << "Network match desynchronized at tick " << remote_hash.tick << std::endl;
+  }
+}
+
+bool RollbackSession::IsTooFarAhead() const {
+  // Both peers see each other late by the same latency: the difference of
+  // their views cancels it out.
+  const int32_t local_advantage = static_cast<int32_t>(state_.tick - remote_tick_);
+  return ticks_since_sync_wait_ >= kSyncWaitInterval &&
+         (local_advantage - remote_advantage_) / 2 >= 1;
+}
+
+void RollbackSession::SendInputs() {
+  const uint32_t first_tick = remote_ack_;
+  const uint8_t input_count = static_cast<uint8_t>(local_input_end_ - first_tick);
+  const TickHash& hash =
+      next_hashed_tick_ > kHashInterval
+          ? local_hashes_[(next_hashed_tick_ / kHashInterval - 1) % kHashHistorySize]
+          : TickHash();
+  const int32_t advantage = static_cast<int32_t>(state_.tick - remote_tick_);
+
+  uint8_t datagram[kMaxDatagramSize];
+  uint8_t* out = datagram;
+  Write(out, kDatagramMagic);
+  Write(out, state_.tick);
+  Write(out, advantage);
+  Write(out, remote_input_end_);
+  Write(out, hash.tick);
+  Write(out, hash.hash);
+  Write(out, first_tick);
+  Write(out, input_count);
+  for (uint32_t tick = first_tick; tick < local_input_end_; ++tick)
+    *out++ = inputs_[tick % kHistorySize][local_index_];
+  transport_.Send(datagram, out - datagram);
+}
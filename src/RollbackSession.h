@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "MatchState.h"
+
+class UdpTransport;
+
+struct RollbackStats {
+  // Of the last AdvanceTick().
+  int resimulated_ticks = 0;
+  float resimulation_time = 0.0f;  // Milliseconds.
+
+  // Since the start.
+  int tick_count = 0;
+  int rollback_count = 0;
+  int64_t total_resimulated_ticks = 0;
+  double total_resimulation_time = 0.0;  // Milliseconds.
+  int max_resimulated_ticks = 0;
+  float max_resimulation_time = 0.0f;  // Milliseconds.
+  int stall_count = 0;                 // Ticks waited for the remote player.
+  int sync_wait_count = 0;             // Ticks waited to let it catch up.
+  int checked_hash_count = 0;
+  int64_t desync_tick = -1;  // First tick whose states differed, or -1.
+};
+
+// A match against a player on another machine, with rollback like GGPO: the
+// remote player is predicted to hold the last input received from them, so
+// that the match never waits for the network. When an input turns out to be
+// different, the match goes back to the state saved before it and plays the
+// ticks since again, within the same AdvanceTick().
+//
+// Each peer sends every tick the inputs the other hasn't acknowledged yet, so
+// that the next datagram makes up for a lost one. Peers also send hashes of
+// the states they agree on, to detect desyncs.
+class RollbackSession {
+ public:
+  // Ticks the remote player may be predicted for. Beyond, the match waits.
+  static constexpr int kMaxPrediction = 12;
+
+  // Both peers must use the same seed and tick time. The local inputs are
+  // played input_delay ticks late: as much latency hidden without rollback,
+  // at the cost of responsiveness.
+  RollbackSession(UdpTransport& transport, bool is_left, uint64_t seed, float tick_time,
+                  int input_delay);
+
+  // Plays a tick with a PlayerInput of the local player, after playing again
+  // the ticks mispredicted. Returns false, dropping the input, when too far
+  // ahead of the remote player.
+  bool AdvanceTick(uint8_t local_input);
+
+  // At the start of the next tick.
+  const MatchState& GetState() const { return state_; }
+
+  // BallEvent flags of the tick played by the last AdvanceTick(). Ticks
+  // played again don't report theirs again.
+  uint8_t GetEvents() const { return events_; }
+
+  const RollbackStats& GetStats() const { return stats_; }
+
+ private:
+  static constexpr int kHistorySize = 64;  // Ticks of inputs and states kept.
+  static constexpr int kHashInterval = 30;  // Ticks between states hashed.
+  static constexpr int kHashHistorySize = 8;
+  // Ticks between waits for a remote player running behind.
+  static constexpr int kSyncWaitInterval = 10;
+  static constexpr uint32_t kNoRollback = std::numeric_limits<uint32_t>::max();
+
+  struct TickHash {
+    uint32_t tick = 0;
+    uint64_t hash = 0;
+  };
+
+  void ReceiveDatagrams();
+  void ReadDatagram(const uint8_t* data, size_t size);
+  // Plays again from the first tick predicted wrong.
+  void Rollback();
+  // Plays the tick of the state, predicting the remote input if it's not
+  // known yet. Returns BallEvent flags.
+  uint8_t Simulate();
+  // Hashes the states that can't change anymore.
+  void HashConfirmedStates();
+  void CheckHash(const TickHash& remote_hash);
+  // Whether the remote player runs behind enough to be waited for.
+  bool IsTooFarAhead() const;
+  void SendInputs();
+
+  UdpTransport& transport_;
+  int local_index_;  // In the inputs: 0 for the left player, 1 for the right one.
+  float tick_time_;
+  MatchState state_;
+
+  // By tick modulo kHistorySize: the state at the start of the tick, and the
+  // inputs it was played with, received or predicted.
+  std::array<MatchState, kHistorySize> saved_states_;
+  std::array<std::array<uint8_t, 2>, kHistorySize> inputs_ = {};
+  uint32_t local_input_end_;   // Local inputs are known before this tick,
+  uint32_t remote_input_end_;  // and remote ones before this one.
+  uint32_t remote_ack_;        // The remote player has our inputs before this tick.
+  uint32_t rollback_tick_ = kNoRollback;
+
+  // As of the remote player's last datagram.
+  uint32_t remote_tick_ = 0;
+  int32_t remote_advantage_ = 0;  // Its tick minus ours, as it sees them.
+  int ticks_since_sync_wait_ = 0;
+
+  std::array<TickHash, kHashHistorySize> local_hashes_ = {};  // By hash index.
+  uint32_t next_hashed_tick_ = kHashInterval;
+  TickHash pending_remote_hash_;  // Received before ours was known.
+  uint32_t last_checked_hash_tick_ = 0;
+
+  uint8_t events_ = 0;
+  RollbackStats stats_;
+};
@@ -9,33 +9,46 @@
 
 #include "SceneManager.h"
 
-#include <memory>
+#include <algorithm>
 
-SceneManager::SceneManager(void) {}
+SceneManager::SceneManager(JobSystem& jobs) : jobs_(jobs) {}
 
 SceneManager::~SceneManager(void) {}
 
-void SceneManager::AddObject(std::shared_ptr<IObject> object) { objects_.push_back(object); }
+void SceneManager::AddObject(IObject& object) {
+  objects_.push_back(&object);
+  is_update_graph_stale_ = true;
+}
 
-void SceneManager::RemoveObject(std::shared_ptr<IObject> object) {
-  for (auto it = objects_.begin(); it != objects_.end(); ++it)
-    if (*it == object) {
-      objects_.erase(it);
-      break;
-    }
+void SceneManager::RemoveObject(IObject& object) {
+  objects_.erase(std::remove(objects_.begin(), objects_.end(), &object), objects_.end());
+  is_update_graph_stale_ = true;
 }
 
 void SceneManager::Update(float dt) {
-  for (auto& object : objects_) object->Update(dt);
+  if (is_update_graph_stale_) {
+    update_graph_.Clear();
+    for (IObject* object : objects_) {
+      JobAccess access = object->GetUpdateAccess();
+      access.writes.push_back(object);
+      update_graph_.Add(object->GetName(), [this, object] { object->Update(dt_); }, access);
+    }
+    is_update_graph_stale_ = false;
+  }
+  dt_ = dt;
+  jobs_.Run(update_graph_);
 }
 
-void SceneManager::Render(const glm::mat4& model, const glm::mat4& view,
-                          const glm::mat4& projection) const {
-  for (const auto& object : objects_) object->Render(model, view, projection);
+void SceneManager::Snapshot(SceneSnapshot& snapshot) const {
+  for (const IObject* object : objects_) {
+    object->Snapshot(snapshot);
+    snapshot.objects.push_back(object);
+  }
 }
 
-bool SceneManager::ProcessEvent(const SDL_Event& event) {
-  for (auto& object : objects_)
-    if (object->ProcessEvent(event)) return true;
-  return false;
+void SceneManager::Render(const SceneSnapshot& snapshot, const glm::mat4& model,
+                          const glm::mat4& view, const glm::mat4& projection) const {
+  // The object list may be changing on the simulation thread: draw the
+  // snapshot's.
+  for (const IObject* object : snapshot.objects) object->Render(snapshot, model, view, projection);
 }
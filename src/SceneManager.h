@@ -17,35 +17,48 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include <memory>
 #include <vector>
 
 #include "IObject.h"
+#include "JobSystem.h"
 
 class SceneManager : public IObject {
   // Constructors
  public:
-  SceneManager();
+  // Objects update as jobs of the job system.
+  explicit SceneManager(JobSystem& jobs);
   virtual ~SceneManager();
 
   // Attributes
+  const char* GetName() const override { return "scene"; }
+
+  // The updates of the last Update(), with their times.
+  const JobGraph& GetUpdateGraph() const { return update_graph_; }
 
   // Operations
-  // Add object to the list.
-  void AddObject(std::shared_ptr<IObject> object);
-  void RemoveObject(std::shared_ptr<IObject> object);
+  // Add object to the list. Objects are systems, each updating and drawing
+  // all the entities of a kind: the list stays short. The object must outlive
+  // the scene.
+  void AddObject(IObject& object);
+  void RemoveObject(IObject& object);
 
-  // Asks objects to update their content.
+  // Asks objects to update their content. Updates that don't touch the same
+  // data run in parallel, the others in the order the objects were added.
   virtual void Update(float dt) override;
 
-  // Asks objects to render.
-  virtual void Render(const glm::mat4& view, const glm::mat4& model,
-                      const glm::mat4& projection) const override;
+  // Asks objects to copy their state, and lists them as the objects to draw.
+  virtual void Snapshot(SceneSnapshot& snapshot) const override;
 
-  // Asks objects to process an event.
-  virtual bool ProcessEvent(const SDL_Event& event) override;
+  // Asks the objects listed in the snapshot to render.
+  virtual void Render(const SceneSnapshot& snapshot, const glm::mat4& model, const glm::mat4& view,
+                      const glm::mat4& projection) const override;
 
   // Implementation
  private:
-  std::vector<std::shared_ptr<IObject>> objects_;
+  std::vector<IObject*> objects_;
+  JobSystem& jobs_;
+  // Built again when the objects change.
+  JobGraph update_graph_;
+  bool is_update_graph_stale_ = true;
+  float dt_ = 0.0f;  // Of the running update.
 };
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Lighting.h"
+#include "ParticleShader.h"
+
+class IObject;
+struct PaddleLatch;
+
+// Everything needed to draw one frame, copied from the simulation so that the
+// render thread never reads live game objects.
+struct SceneSnapshot {
+  struct BoardState {
+    int left_score = 0;
+    int right_score = 0;
+    int score_revision = 0;
+    float illuminate_left_border = 0.0f;
+    float illuminate_right_border = 0.0f;
+  };
+
+  struct PaddleState {
+    bool is_left = true;
+    float y = 0.0f;
+    float illuminate = 0.0f;
+    // Paddles outlive every snapshot.
+    PaddleLatch* latch = nullptr;
+  };
+
+  // Empties the snapshot, keeping the allocated memory.
+  void Clear() {
+    objects.clear();
+    paddles.clear();
+    ball_particles.clear();
+    prediction_particles.clear();
+    firework_particles.clear();
+    obstacle_particles.clear();
+  }
+
+  // Objects to draw, in order. They are owned by the game and outlive every
+  // snapshot.
+  std::vector<const IObject*> objects;
+
+  BoardState board;
+  std::vector<PaddleState> paddles;
+  std::vector<ParticleShader::Particle> ball_particles;
+  std::vector<ParticleShader::Particle> prediction_particles;  // Path of the balls.
+  std::vector<ParticleShader::Particle> firework_particles;
+  std::vector<ParticleShader::Particle> obstacle_particles;
+
+  // Display settings.
+  LightingMode lighting_mode = LightingMode::kBaked;
+  bool show_performance_overlay = false;
+  bool measure_latency = false;
+  glm::ivec2 viewport_size{0, 0};
+
+  // Simulation statistics, for the performance overlay.
+  float update_time = 0.0f;  // Milliseconds spent in the last tick.
+  // Milliseconds of the longest chain of dependent updates in the last tick.
+  float update_critical_path = 0.0f;
+  // Ticks of network play played again in the last tick, -1 without network
+  // play, and the milliseconds it took.
+  int resimulated_ticks = -1;
+  float resimulation_time = 0.0f;
+};
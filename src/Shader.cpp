@@ -3,78 +3,191 @@
 #include <iostream>
 #include <vector>
 
-static GLuint CompileShader(GLenum type, const char* source) {
-  // Skip leading line breaks.
+#include "FrameUniforms.h"
+#include "VertexFormat.h"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+static const char* SkipLeadingLineBreaks(const char* source) {
   while (*source == '\n') {
     ++source;
   }
+  return source;
+}
+
+static GLuint CompileShader(GLenum type, const char* source) {
+  source = SkipLeadingLineBreaks(source);
 
+  // The compile status is only checked in Finish(), so that the driver may
+  // compile several programs in parallel.
   GLuint shader = glCreateShader(type);
   glShaderSource(shader, 1, &source, nullptr);
   glCompileShader(shader);
+  return shader;
+}
 
+static void ReportShaderErrors(GLuint shader, const char* source) {
   GLint success;
   glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    GLint log_length;
-    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
-    std::vector<char> log(log_length);
-    glGetShaderInfoLog(shader, log_length, nullptr, log.data());
-    std::cout << "Shader code: " << std::endl << source << std::endl;
-    std::cerr << "Shader compilation failed: " << log.data() << std::endl;
-    glDeleteShader(shader);
-    return 0;
-  }
-  return shader;
+  if (success) return;
+
+  GLint log_length;
+  glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+  std::vector<char> log(log_length + 1);
+  glGetShaderInfoLog(shader, log_length, nullptr, log.data());
+  std::cout << "Shader code: " << std::endl << SkipLeadingLineBreaks(source) << std::endl;
+  std::cerr << "Shader compilation failed: " << log.data() << std::endl;
 }
 
-Shader::Shader(const char* vertex_shader_source, const char* fragment_shader_source) {
-  GLuint vertex_shader = CompileShader(GL_VERTEX_SHADER, vertex_shader_source);
-  GLuint fragment_shader = CompileShader(GL_FRAGMENT_SHADER, fragment_shader_source);
+static bool HasParallelShaderCompile() {
+#ifdef __EMSCRIPTEN__
+  return false;
+#else
+  return GLEW_KHR_parallel_shader_compile;
+#endif
+}
 
+Shader::Shader(const char* vertex_shader_source, const char* fragment_shader_source,
+               const ProgramBinary* binary)
+    : vertex_shader_source_(vertex_shader_source),
+      fragment_shader_source_(fragment_shader_source) {
   program_ = glCreateProgram();
-  glAttachShader(program_, vertex_shader);
-  glAttachShader(program_, fragment_shader);
+
+  if (binary && !binary->data.empty()) {
+    glProgramBinary(program_, binary->format, binary->data.data(), binary->data.size());
+    GLint success;
+    glGetProgramiv(program_, GL_LINK_STATUS, &success);
+    if (success) {
+      from_binary_ = true;
+      return;
+    }
+    // The driver changed since the binary was saved: build from the sources.
+  }
+
+  vertex_shader_ = CompileShader(GL_VERTEX_SHADER, vertex_shader_source_);
+  fragment_shader_ = CompileShader(GL_FRAGMENT_SHADER, fragment_shader_source_);
+
+  glAttachShader(program_, vertex_shader_);
+  glAttachShader(program_, fragment_shader_);
+  glBindAttribLocation(program_, kPositionAttribute, "aPos");
+  glBindAttribLocation(program_, kNormalAttribute, "aNormal");
+  glBindAttribLocation(program_, kTexCoordAttribute, "aTexCoord");
+  glBindAttribLocation(program_, kColorAttribute, "aColor");
+  glBindAttribLocation(program_, kRectAttribute, "aRect");
+  glBindAttribLocation(program_, kGlyphAttribute, "aGlyph");
+  glBindAttribLocation(program_, kLightAttribute, "aLight");
+  glBindAttribLocation(program_, kCenterAttribute, "aCenter");
+#ifndef __EMSCRIPTEN__
+  glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
   glLinkProgram(program_);
+}
+
+Shader::~Shader() {
+  if (vertex_shader_) glDeleteShader(vertex_shader_);
+  if (fragment_shader_) glDeleteShader(fragment_shader_);
+  if (program_) {
+    glDeleteProgram(program_);
+  }
+}
+
+bool Shader::IsLinkComplete() const {
+  if (finished_ || from_binary_ || !HasParallelShaderCompile()) return true;
+  GLint complete;
+  glGetProgramiv(program_, GL_COMPLETION_STATUS_KHR, &complete);
+  return complete;
+}
+
+bool Shader::Finish() {
+  if (finished_) return program_ != 0;
+  finished_ = true;
 
   GLint success;
   glGetProgramiv(program_, GL_LINK_STATUS, &success);
   if (!success) {
+    if (vertex_shader_) ReportShaderErrors(vertex_shader_, vertex_shader_source_);
+    if (fragment_shader_) ReportShaderErrors(fragment_shader_, fragment_shader_source_);
+
     GLint log_length;
     glGetProgramiv(program_, GL_INFO_LOG_LENGTH, &log_length);
-    std::vector<char> log(log_length);
+    std::vector<char> log(log_length + 1);
     glGetProgramInfoLog(program_, log_length, nullptr, log.data());
     std::cerr << "Shader linking failed: " << log.data() << std::endl;
     glDeleteProgram(program_);
     program_ = 0;
   }
 
-  glDeleteShader(vertex_shader);
-  glDeleteShader(fragment_shader);
-}
+  if (vertex_shader_) {
+    glDeleteShader(vertex_shader_);
+    vertex_shader_ = 0;
+  }
+  if (fragment_shader_) {
+    glDeleteShader(fragment_shader_);
+    fragment_shader_ = 0;
+  }
+  if (!program_) return false;
 
-Shader::~Shader() {
-  if (program_) {
-    glDeleteProgram(program_);
+  // Resolve all uniform locations once.
+  GLint uniform_count = 0;
+  GLint max_name_length = 0;
+  glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &uniform_count);
+  glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+  std::vector<char> name(max_name_length + 1);
+  for (GLint i = 0; i < uniform_count; ++i) {
+    GLint size;
+    GLenum type;
+    glGetActiveUniform(program_, i, name.size(), nullptr, &size, &type, name.data());
+    GLint location = glGetUniformLocation(program_, name.data());
+    // Uniforms inside blocks have no location.
+    if (location != -1) uniform_locations_[name.data()] = location;
   }
+
+  // Programs declaring the per-frame block share the same buffer binding.
+  GLuint frame_block = glGetUniformBlockIndex(program_, "Frame");
+  if (frame_block != GL_INVALID_INDEX)
+    glUniformBlockBinding(program_, frame_block, kFrameUniformsBinding);
+  return true;
+}
+
+bool Shader::GetBinary(ProgramBinary* binary) const {
+  if (!program_) return false;
+  GLint length = 0;
+  glGetProgramiv(program_, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return false;
+
+  binary->data.resize(length);
+  GLsizei written = 0;
+  glGetProgramBinary(program_, length, &written, &binary->format, binary->data.data());
+  binary->data.resize(written);
+  return written > 0;
 }
 
 void Shader::Use() const { glUseProgram(program_); }
 
-void Shader::SetUniform(const std::string& name, const glm::mat4& matrix) const {
-  glUniformMatrix4fv(glGetUniformLocation(program_, name.c_str()), 1, GL_FALSE, &matrix[0][0]);
+void Shader::SetUniform(Uniform<glm::mat4> uniform, const glm::mat4& matrix) const {
+  glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &matrix[0][0]);
+}
+
+void Shader::SetUniform(Uniform<glm::vec2> uniform, const glm::vec2& value) const {
+  glUniform2fv(uniform.location, 1, &value[0]);
+}
+
+void Shader::SetUniform(Uniform<glm::vec3> uniform, const glm::vec3& value) const {
+  glUniform3fv(uniform.location, 1, &value[0]);
 }
 
-void Shader::SetUniform(const std::string& name, const glm::vec3& value) const {
-  glUniform3fv(glGetUniformLocation(program_, name.c_str()), 1, &value[0]);
+void Shader::SetUniform(Uniform<glm::vec4> uniform, const glm::vec4& value) const {
+  glUniform4fv(uniform.location, 1, &value[0]);
 }
 
-void Shader::SetUniform(const std::string& name, const glm::vec4& value) const {
-  glUniform4fv(glGetUniformLocation(program_, name.c_str()), 1, &value[0]);
+void Shader::SetUniform(Uniform<float> uniform, float value) const {
+  glUniform1f(uniform.location, value);
 }
 
-void Shader::SetUniform(const std::string& name, int value) const {
-  glUniform1i(glGetUniformLocation(program_, name.c_str()), value);
+void Shader::SetUniform(Uniform<int> uniform, int value) const {
+  glUniform1i(uniform.location, value);
 }
 
 GLuint Shader::GetAttributeLocation(const std::string& name) const {
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #ifdef __EMSCRIPTEN__
 #include <GLES3/gl3.h>
@@ -9,20 +11,66 @@
 #include <GL/glew.h>
 #endif
 
+// Location of a uniform of type T, resolved once after linking.
+template <typename T>
+struct Uniform {
+  GLint location = -1;
+};
+
+// Driver-specific linked program, as returned by glGetProgramBinary.
+struct ProgramBinary {
+  GLenum format = 0;
+  std::vector<char> data;
+};
+
 class Shader {
  public:
-  Shader(const char* vertex_shader_source, const char* fragment_shader_source);
+  // Starts building the program, from the binary if it is given and still
+  // accepted by the driver, otherwise from the sources. Compilation may run in
+  // the background: Finish() must be called before using the program.
+  Shader(const char* vertex_shader_source, const char* fragment_shader_source,
+         const ProgramBinary* binary = nullptr);
   ~Shader();
 
+  // Returns true once Finish() would not block.
+  bool IsLinkComplete() const;
+
+  // Waits for the link, reports errors and resolves uniforms.
+  // Returns false if the program is unusable.
+  bool Finish();
+
+  // True if the program was restored from a binary rather than compiled.
+  bool IsFromBinary() const { return from_binary_; }
+
+  // Retrieves the linked program binary, to be cached.
+  bool GetBinary(ProgramBinary* binary) const;
+
   void Use() const;
 
-  void SetUniform(const std::string& name, const glm::mat4& matrix) const;
-  void SetUniform(const std::string& name, const glm::vec3& value) const;
-  void SetUniform(const std::string& name, const glm::vec4& value) const;
-  void SetUniform(const std::string& name, int value) const;
+  // Returns the handle of an active uniform (or an inactive handle that is
+  // silently ignored by SetUniform).
+  template <typename T>
+  Uniform<T> GetUniform(const std::string& name) const {
+    auto it = uniform_locations_.find(name);
+    return {it != uniform_locations_.end() ? it->second : -1};
+  }
+
+  void SetUniform(Uniform<glm::mat4> uniform, const glm::mat4& matrix) const;
+  void SetUniform(Uniform<glm::vec2> uniform, const glm::vec2& value) const;
+  void SetUniform(Uniform<glm::vec3> uniform, const glm::vec3& value) const;
+  void SetUniform(Uniform<glm::vec4> uniform, const glm::vec4& value) const;
+  void SetUniform(Uniform<float> uniform, float value) const;
+  void SetUniform(Uniform<int> uniform, int value) const;
 
   GLuint GetAttributeLocation(const std::string& name) const;
 
  private:
   GLuint program_ = 0;
+  GLuint vertex_shader_ = 0;
+  GLuint fragment_shader_ = 0;
+  const char* vertex_shader_source_;
+  const char* fragment_shader_source_;
+  bool from_binary_ = false;
+  bool finished_ = false;
+  std::unordered_map<std::string, GLint> uniform_locations_;
 };
@@ -0,0 +1,115 @@
+#include "ShaderLibrary.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "Cache.h"
+
+namespace {
+constexpr char kBinaryMagic[4] = {'G', 'L', 'P', 'B'};
+constexpr uint32_t kBinaryVersion = 1;
+
+std::string GetString(GLenum name) {
+  const GLubyte* value = glGetString(name);
+  return value ? reinterpret_cast<const char*>(value) : "";
+}
+}  // namespace
+
+ShaderLibrary::ShaderLibrary() {
+  driver_id_ = GetString(GL_VENDOR) + "/" + GetString(GL_RENDERER) + "/" + GetString(GL_VERSION);
+
+#ifndef __EMSCRIPTEN__
+  // Let the driver use as many compiler threads as it likes.
+  if (GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+#endif
+
+  GLint binary_format_count = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_format_count);
+  // None with WebGL.
+  if (binary_format_count > 0) cache_directory_ = GetCacheDirectory("shaders");
+}
+
+ShaderLibrary::~ShaderLibrary() {}
+
+void ShaderLibrary::Preload(const std::vector<const ShaderSource*>& sources) {
+  for (const ShaderSource* source : sources) Load(*source);
+}
+
+std::shared_ptr<Shader> ShaderLibrary::Get(const ShaderSource& source) {
+  Entry& entry = Load(source);
+  if (!entry.finished) {
+    entry.finished = true;
+    if (entry.shader->Finish() && !entry.shader->IsFromBinary() && !cache_directory_.empty()) {
+      ProgramBinary binary;
+      if (entry.shader->GetBinary(&binary)) WriteBinary(entry.hash, binary);
+    }
+  }
+  return entry.shader;
+}
+
+ShaderLibrary::Entry& ShaderLibrary::Load(const ShaderSource& source) {
+  const uint64_t hash = Hash(source.fragment, Hash(source.vertex));
+  auto it = programs_.find(hash);
+  if (it != programs_.end()) return it->second;
+
+  ProgramBinary binary;
+  bool has_binary = !cache_directory_.empty() && ReadBinary(hash, &binary);
+  Entry entry;
+  entry.hash = hash;
+  entry.shader = std::make_shared<Shader>(source.vertex, source.fragment,
+                                          has_binary ? &binary : nullptr);
+  if (has_binary && !entry.shader->IsFromBinary())
+    std::cerr << "Ignoring stale program binary of shader " << source.name << std::endl;
+  return programs_.emplace(hash, std::move(entry)).first->second;
+}
+
+std::filesystem::path ShaderLibrary::GetBinaryPath(uint64_t hash) const {
+  // The driver is part of the file name so that switching GPU keeps both.
+  char name[40];
+  snprintf(name, sizeof(name), "%016llx-%016llx.bin", static_cast<unsigned long long>(hash),
+           static_cast<unsigned long long>(Hash(driver_id_.c_str())));
+  return cache_directory_ / name;
+}
+
+bool ShaderLibrary::ReadBinary(uint64_t hash, ProgramBinary* binary) const {
+  std::ifstream file(GetBinaryPath(hash), std::ios::binary);
+  if (!file) return false;
+
+  char magic[4];
+  uint32_t version, format, length;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char*>(&version), sizeof(version));
+  file.read(reinterpret_cast<char*>(&format), sizeof(format));
+  file.read(reinterpret_cast<char*>(&length), sizeof(length));
+  if (!file || !std::equal(magic, magic + 4, kBinaryMagic) || version != kBinaryVersion)
+    return false;
+
+  binary->format = format;
+  binary->data.resize(length);
+  file.read(binary->data.data(), length);
+  return static_cast<bool>(file);
+}
+
+void ShaderLibrary::WriteBinary(uint64_t hash, const ProgramBinary& binary) const {
+  // Write then rename, so that a concurrent run never reads a partial file.
+  std::filesystem::path path = GetBinaryPath(hash);
+  std::filesystem::path temp_path = path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file) return;
+    const uint32_t version = kBinaryVersion;
+    const uint32_t format = binary.format;
+    const uint32_t length = binary.data.size();
+    file.write(kBinaryMagic, sizeof(kBinaryMagic));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    file.write(binary.data.data(), binary.data.size());
+    if (!file) return;
+  }
+  std::error_code error;
+  std::filesystem::rename(temp_path, path, error);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+#include "ShaderSources.h"
+
+// Builds each program once and shares it between all its users.
+//
+// Programs are keyed by a hash of their sources. Compilation is started for
+// all programs ahead of time (in parallel when GL_KHR_parallel_shader_compile
+// is available), and linked binaries are cached on disk so that later runs
+// skip compilation entirely.
+class ShaderLibrary {
+ public:
+  ShaderLibrary();
+  ~ShaderLibrary();
+
+  // Starts building the programs without waiting for them.
+  void Preload(const std::vector<const ShaderSource*>& sources);
+
+  // Returns the linked program of these sources.
+  std::shared_ptr<Shader> Get(const ShaderSource& source);
+
+ private:
+  struct Entry {
+    std::shared_ptr<Shader> shader;
+    uint64_t hash;
+    bool finished = false;
+  };
+
+  Entry& Load(const ShaderSource& source);
+  std::filesystem::path GetBinaryPath(uint64_t hash) const;
+  bool ReadBinary(uint64_t hash, ProgramBinary* binary) const;
+  void WriteBinary(uint64_t hash, const ProgramBinary& binary) const;
+
+  std::unordered_map<uint64_t, Entry> programs_;
+  // Identifies the driver, so that binaries of another driver are ignored.
+  std::string driver_id_;
+  // Empty when program binaries are not supported.
+  std::filesystem::path cache_directory_;
+};
@@ -0,0 +1,56 @@
+#include "ShaderSources.h"
+
+#include <string>
+
+#include "AssetArchive.h"
+
+namespace {
+// The "shaders/<name>.vert" and "shaders/<name>.frag" assets.
+ShaderSource LoadShaderSource(const char* name) {
+  const AssetArchive& assets = AssetArchive::Embedded();
+  const std::string path = std::string("shaders/") + name;
+  return {name, assets.Get(path + ".vert").GetText(), assets.Get(path + ".frag").GetText()};
+}
+}  // namespace
+
+const ShaderSource& GetLitShaderSource() {
+  static const ShaderSource source = LoadShaderSource("lit");
+  return source;
+}
+
+const ShaderSource& GetBakedLitShaderSource() {
+  static const ShaderSource source = LoadShaderSource("lit-baked");
+  return source;
+}
+
+const ShaderSource& GetParticleShaderSource() {
+  static const ShaderSource source = LoadShaderSource("particle");
+  return source;
+}
+
+const ShaderSource& GetInstancedParticleShaderSource() {
+  static const ShaderSource source = LoadShaderSource("particle-instanced");
+  return source;
+}
+
+const ShaderSource& GetHudShaderSource() {
+  static const ShaderSource source = LoadShaderSource("hud");
+  return source;
+}
+
+const ShaderSource& GetHudLayerShaderSource() {
+  static const ShaderSource source = LoadShaderSource("hud-layer");
+  return source;
+}
+
+const std::vector<const ShaderSource*>& AllShaderSources() {
+  static const std::vector<const ShaderSource*> sources = {
+      &GetLitShaderSource(),
+      &GetBakedLitShaderSource(),
+      &GetParticleShaderSource(),
+      &GetInstancedParticleShaderSource(),
+      &GetHudShaderSource(),
+      &GetHudLayerShaderSource(),
+  };
+  return sources;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+// GLSL sources of a program, from res/shaders in the asset archive.
+struct ShaderSource {
+  const char* name;  // Used in logs.
+  const char* vertex;
+  const char* fragment;
+};
+
+// Each source is loaded on first use, so that a missing or corrupt asset
+// throws from the code asking for it rather than before main().
+
+// Board and paddles, per-pixel lighting from the "Frame" block.
+const ShaderSource& GetLitShaderSource();
+// Board and paddles, with the light baked in the vertices (see BakeLighting()).
+const ShaderSource& GetBakedLitShaderSource();
+// Textured additive particles.
+const ShaderSource& GetParticleShaderSource();
+// Textured additive particles, a quad instanced per particle.
+const ShaderSource& GetInstancedParticleShaderSource();
+// Instanced text and rectangles of the HUD, from a distance field atlas.
+const ShaderSource& GetHudShaderSource();
+// Composites a cached HUD layer texture.
+const ShaderSource& GetHudLayerShaderSource();
+
+// Every program of the game, to be compiled ahead of time.
+const std::vector<const ShaderSource*>& AllShaderSources();
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Lock-free single producer, single consumer queue of at most Capacity - 1
+// elements.
+//
+// Neither side ever blocks or allocates, so the consumer can be a real-time
+// thread such as the audio callback.
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+ public:
+  // Producer side. Returns false, dropping the element, if the queue is full.
+  bool Push(const T& element) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t next_tail = (tail + 1) & kMask;
+    if (next_tail == head_.load(std::memory_order_acquire)) return false;
+    elements_[tail] = element;
+    tail_.store(next_tail, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false if the queue is empty.
+  bool Pop(T* element) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    *element = elements_[head];
+    head_.store((head + 1) & kMask, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  static constexpr size_t kMask = Capacity - 1;
+
+  std::array<T, Capacity> elements_;
+  // On separate cache lines, each written by one side only.
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
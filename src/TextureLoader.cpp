@@ -0,0 +1,325 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include "Cache.h"
+
+namespace {
+constexpr uint32_t kCacheVersion = 2;
+
+#ifdef __EMSCRIPTEN__
+// No threads: images are decoded by Upload() instead.
+constexpr std::launch kDecodePolicy = std::launch::deferred;
+#else
+constexpr std::launch kDecodePolicy = std::launch::async;
+#endif
+
+// Followed by the pixels of every level, largest first.
+struct CacheHeader {
+  char magic[4] = {'G', 'L', 'P', 'T'};
+  uint32_t version = kCacheVersion;
+  uint64_t source_hash = 0;  // Of the encoded image.
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t channels = 0;
+  uint32_t levels = 0;
+};
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool Open(const std::filesystem::path& path);
+
+  const unsigned char* GetData() const { return static_cast<const unsigned char*>(data_); }
+  size_t GetSize() const { return size_; }
+
+ private:
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+MappedFile::~MappedFile() {
+  if (!data_) return;
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+#else
+  munmap(data_, size_);
+#endif
+}
+
+bool MappedFile::Open(const std::filesystem::path& path) {
+#ifdef _WIN32
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  HANDLE mapping = nullptr;
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping) return false;
+  // The view keeps the mapping alive.
+  data_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!data_) return false;
+  size_ = static_cast<size_t>(size.QuadPart);
+#else
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) return false;
+  struct stat status;
+  if (fstat(file, &status) == 0 && status.st_size > 0) {
+    void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (data != MAP_FAILED) {
+      data_ = data;
+      size_ = status.st_size;
+    }
+  }
+  close(file);
+#endif
+  return data_ != nullptr;
+}
+
+int GetLevelCount(int width, int height) {
+  int levels = 1;
+  while ((width | height) >> levels) ++levels;
+  return levels;
+}
+
+size_t GetLevelSize(int width, int height, int channels, int level) {
+  return static_cast<size_t>(std::max(1, width >> level)) * std::max(1, height >> level) * channels;
+}
+
+// Box filters a level into the next one, half its size.
+void Downsample(const unsigned char* source, int width, int height, int channels,
+                unsigned char* destination) {
+  const int next_width = std::max(1, width / 2);
+  const int next_height = std::max(1, height / 2);
+  for (int y = 0; y < next_height; ++y) {
+    const int y0 = std::min(2 * y, height - 1) * width;
+    const int y1 = std::min(2 * y + 1, height - 1) * width;
+    for (int x = 0; x < next_width; ++x) {
+      const int x0 = std::min(2 * x, width - 1);
+      const int x1 = std::min(2 * x + 1, width - 1);
+      for (int c = 0; c < channels; ++c) {
+        int sum = source[(y0 + x0) * channels + c] + source[(y0 + x1) * channels + c] +
+                  source[(y1 + x0) * channels + c] + source[(y1 + x1) * channels + c];
+        *destination++ = static_cast<unsigned char>((sum + 2) / 4);
+      }
+    }
+  }
+}
+}  // namespace
+
+// A decoded image and its mip chain, with rows packed tightly.
+class TextureLoader::Image {
+ public:
+  // Maps the cached mip chain of the image, or decodes the image and caches
+  // its mip chain. No caching if cache_path is empty.
+  static std::unique_ptr<Image> Load(const std::string& name, const AssetArchive::Asset& source,
+                                     const std::filesystem::path& cache_path);
+
+  int width = 0;
+  int height = 0;
+  int channels = 0;
+  int levels = 0;
+  // Every level, largest first.
+  const unsigned char* pixels = nullptr;
+  size_t size = 0;
+  bool is_from_cache = false;
+
+ private:
+  bool Map(const std::filesystem::path& cache_path, const CacheHeader& source);
+  bool Decode(const AssetArchive::Asset& source);
+  void WriteCache(const std::filesystem::path& cache_path, CacheHeader header) const;
+
+  MappedFile mapping_;
+  std::vector<unsigned char> storage_;
+};
+
+std::unique_ptr<TextureLoader::Image> TextureLoader::Image::Load(
+    const std::string& name, const AssetArchive::Asset& source,
+    const std::filesystem::path& cache_path) {
+  auto image = std::make_unique<Image>();
+
+  CacheHeader header;
+  header.source_hash = source.hash;
+  if (!cache_path.empty() && image->Map(cache_path, header)) return image;
+
+  if (!image->Decode(source)) {
+    std::cerr << "Failed to load image: " << name << "\n";
+    return nullptr;
+  }
+  if (!cache_path.empty()) image->WriteCache(cache_path, header);
+  return image;
+}
+
+bool TextureLoader::Image::Map(const std::filesystem::path& cache_path,
+                               const CacheHeader& source) {
+  if (!mapping_.Open(cache_path) || mapping_.GetSize() < sizeof(CacheHeader)) return false;
+
+  CacheHeader header;
+  std::memcpy(&header, mapping_.GetData(), sizeof(header));
+  if (std::memcmp(header.magic, source.magic, sizeof(header.magic)) != 0 ||
+      header.version != kCacheVersion || header.source_hash != source.source_hash ||
+      header.channels < 1 || header.channels > 4 ||
+      header.levels != static_cast<uint32_t>(GetLevelCount(header.width, header.height))) {
+    return false;
+  }
+
+  width = header.width;
+  height = header.height;
+  channels = header.channels;
+  levels = header.levels;
+  size = 0;
+  for (int level = 0; level < levels; ++level) size += GetLevelSize(width, height, channels, level);
+  if (mapping_.GetSize() != sizeof(CacheHeader) + size) return false;
+  pixels = mapping_.GetData() + sizeof(CacheHeader);
+  is_from_cache = true;
+  return true;
+}
+
+bool TextureLoader::Image::Decode(const AssetArchive::Asset& source) {
+  unsigned char* data = stbi_load_from_memory(source.data, static_cast<int>(source.size), &width,
+                                              &height, &channels, 0);
+  if (!data) return false;
+
+  levels = GetLevelCount(width, height);
+  size = 0;
+  for (int level = 0; level < levels; ++level) size += GetLevelSize(width, height, channels, level);
+  storage_.resize(size);
+  std::memcpy(storage_.data(), data, GetLevelSize(width, height, channels, 0));
+  stbi_image_free(data);
+
+  unsigned char* level_pixels = storage_.data();
+  for (int level = 0; level + 1 < levels; ++level) {
+    unsigned char* next_level_pixels = level_pixels + GetLevelSize(width, height, channels, level);
+    Downsample(level_pixels, std::max(1, width >> level), std::max(1, height >> level), channels,
+               next_level_pixels);
+    level_pixels = next_level_pixels;
+  }
+  pixels = storage_.data();
+  return true;
+}
+
+void TextureLoader::Image::WriteCache(const std::filesystem::path& cache_path,
+                                      CacheHeader header) const {
+  header.width = width;
+  header.height = height;
+  header.channels = channels;
+  header.levels = levels;
+
+  // Write then rename, so that a concurrent run never maps a partial file.
+  std::filesystem::path temp_path = cache_path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file) return;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(pixels), size);
+    if (!file) return;
+  }
+  std::error_code error;
+  std::filesystem::rename(temp_path, cache_path, error);
+}
+
+TextureLoader::TextureLoader() : cache_directory_(GetCacheDirectory("textures")) {
+  glGenBuffers(1, &pixel_buffer_);
+}
+
+TextureLoader::~TextureLoader() {
+  // Waits for the workers.
+  requests_.clear();
+  glDeleteBuffers(1, &pixel_buffer_);
+}
+
+GLuint TextureLoader::Load(const std::string& name) {
+  const AssetArchive::Asset source = AssetArchive::Embedded().Get(name);
+
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  const GLubyte transparent_black[4] = {0, 0, 0, 0};
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent_black);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  std::filesystem::path cache_path;
+  if (!cache_directory_.empty()) {
+    // Named after the content: an edited image gets a new entry.
+    char file_name[24];
+    snprintf(file_name, sizeof(file_name), "%016llx.tex",
+             static_cast<unsigned long long>(source.hash));
+    cache_path = cache_directory_ / file_name;
+  }
+
+  requests_.push_back(
+      {texture, std::async(kDecodePolicy, &Image::Load, name, source, cache_path)});
+  return texture;
+}
+
+bool TextureLoader::Upload() {
+  bool is_done = true;
+  for (auto& request : requests_) {
+    if (!request.image.valid()) continue;  // Already uploaded.
+    if (request.image.wait_for(std::chrono::seconds(0)) == std::future_status::timeout) {
+      is_done = false;
+      continue;
+    }
+    std::unique_ptr<Image> image = request.image.get();
+    if (!image) continue;
+    if (image->is_from_cache) ++cached_count_;
+    UploadImage(request.texture, *image);
+  }
+  return is_done;
+}
+
+void TextureLoader::UploadImage(GLuint texture, const Image& image) {
+  static constexpr GLenum kInternalFormats[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+  static constexpr GLenum kFormats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+  const GLenum internal_format = kInternalFormats[image.channels - 1];
+  const GLenum format = kFormats[image.channels - 1];
+
+  // Copies the whole chain at once. Reallocating the buffer lets the driver
+  // keep feeding earlier uploads from the previous storage.
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, image.size, image.pixels, GL_STREAM_DRAW);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  glBindTexture(GL_TEXTURE_2D, texture);
+  size_t offset = 0;
+  for (int level = 0; level < image.levels; ++level) {
+    // With an unpack buffer bound, the pointer is an offset into it.
+    glTexImage2D(GL_TEXTURE_2D, level, internal_format, std::max(1, image.width >> level),
+                 std::max(1, image.height >> level), 0, format, GL_UNSIGNED_BYTE,
+                 reinterpret_cast<const void*>(offset));
+    offset += GetLevelSize(image.width, image.height, image.channels, level);
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levels - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __EMSCRIPTEN__
+#include <GLES3/gl3.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include "AssetArchive.h"
+
+// Loads textures without blocking the first frame.
+//
+// Images from the asset archive are decoded and mipmapped on worker threads,
+// then uploaded through a pixel unpack buffer by Upload(), on the thread owning
+// the GL context. The decoded mip chains are cached on disk and memory-mapped
+// by later runs, which don't decode PNG files at all.
+class TextureLoader {
+ public:
+  TextureLoader();
+  ~TextureLoader();
+
+  TextureLoader(const TextureLoader&) = delete;
+  TextureLoader& operator=(const TextureLoader&) = delete;
+
+  // Starts loading an image asset. The texture is returned at once, and stays
+  // transparent black until Upload() sets its image. One-channel images are
+  // GL_R8 textures: sample their red channel.
+  GLuint Load(const std::string& name);
+
+  // Uploads the images decoded so far. Returns true once every texture has its
+  // image, or failed to load.
+  bool Upload();
+
+  // Number of images read from the cache rather than decoded.
+  int GetCachedCount() const { return cached_count_; }
+
+ private:
+  class Image;
+
+  struct Request {
+    GLuint texture;
+    std::future<std::unique_ptr<Image>> image;
+  };
+
+  void UploadImage(GLuint texture, const Image& image);
+
+  std::filesystem::path cache_directory_;
+  std::vector<Request> requests_;
+  GLuint pixel_buffer_ = 0;
+  int cached_count_ = 0;
+};
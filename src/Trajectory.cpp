@@ -0,0 +1,41 @@
+#include "Trajectory.h"
+
+#include <cmath>
+
+std::optional<TrajectoryCrossing> PredictCrossing(glm::vec2 position, glm::vec2 speed,
+                                                  float line_x, float bottom, float top) {
+  const float time = (line_x - position.x) / speed.x;
+  if (!(time >= 0.0f) || !std::isfinite(time)) return std::nullopt;
+
+  // Seen in the walls' mirrors, the ball flies straight through copies of the
+  // board, every other one upside down. Fold its unbounced height back into
+  // the board.
+  const float height = top - bottom;
+  const float unfolded = position.y - bottom + speed.y * time;
+  float phase = std::fmod(unfolded, 2.0f * height);
+  if (phase < 0.0f) phase += 2.0f * height;
+
+  TrajectoryCrossing crossing;
+  crossing.y = bottom + (phase <= height ? phase : 2.0f * height - phase);
+  crossing.time = time;
+  crossing.bounce_count = static_cast<int>(std::abs(std::floor(unfolded / height)));
+  return crossing;
+}
+
+void PredictPath(glm::vec2 position, glm::vec2 speed, float line_x, float bottom, float top,
+                 std::vector<glm::vec2>& path) {
+  path.clear();
+  const std::optional<TrajectoryCrossing> crossing =
+      PredictCrossing(position, speed, line_x, bottom, top);
+  if (!crossing) return;
+
+  path.push_back(position);
+  for (int bounce = 0; bounce < crossing->bounce_count; ++bounce) {
+    const float wall = speed.y > 0.0f ? top : bottom;
+    position += speed * ((wall - position.y) / speed.y);
+    position.y = wall;
+    path.push_back(position);
+    speed.y = -speed.y;
+  }
+  path.push_back({line_x, crossing->y});
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <optional>
+#include <vector>
+
+// Straight flight of a ball bouncing between two horizontal walls, solved in
+// closed form: the cost doesn't depend on the number of bounces.
+
+struct TrajectoryCrossing {
+  float y;           // Where the ball crosses the line.
+  float time;        // Seconds until then.
+  int bounce_count;  // Bounces on the walls before.
+};
+
+// Where a ball crosses the vertical line at line_x, or nothing if it flies
+// away from it. bottom and top limit the center of the ball.
+std::optional<TrajectoryCrossing> PredictCrossing(glm::vec2 position, glm::vec2 speed,
+                                                  float line_x, float bottom, float top);
+
+// Replaces path with the positions of the ball from position to the line at
+// line_x: the start, each bounce and the crossing. Empty if the ball flies
+// away from the line.
+void PredictPath(glm::vec2 position, glm::vec2 speed, float line_x, float bottom, float top,
+                 std::vector<glm::vec2>& path);
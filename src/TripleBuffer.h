@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer, single consumer triple buffer.
+//
+// The writer fills the back buffer and publishes it; the reader picks up the
+// most recently published buffer. Neither side ever waits for the other, and a
+// buffer is never written while it is being read. Buffers are reused, so
+// containers inside T keep their capacity across publications.
+template <typename T>
+class TripleBuffer {
+ public:
+  // Writer side: the buffer to fill before Publish().
+  T& GetWriteBuffer() { return buffers_[back_]; }
+
+  // Writer side: makes the write buffer the latest one, and hands out another
+  // buffer to write.
+  void Publish() {
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex;
+  }
+
+  // Reader side: switches to the latest published buffer. Returns false if
+  // nothing was published since the previous call.
+  bool Acquire() {
+    if (!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+    return true;
+  }
+
+  // Reader side: the buffer acquired last.
+  const T& GetReadBuffer() const { return buffers_[front_]; }
+
+ private:
+  static constexpr uint8_t kIndex = 0x3;
+  static constexpr uint8_t kFresh = 0x4;  // Set when the middle buffer is unread.
+
+  std::array<T, 3> buffers_;
+  uint8_t back_ = 0;                // Owned by the writer.
+  std::atomic<uint8_t> middle_{1};  // Swapped by both sides.
+  uint8_t front_ = 2;               // Owned by the reader.
+};
@@ -0,0 +1,150 @@
+#include "UdpTransport.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+using DatagramSize = int;
+
+// Winsock is started on first use, and cleaned up at exit.
+void StartSockets() {
+  static const struct Winsock {
+    Winsock() {
+      WSADATA data;
+      if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+        throw std::runtime_error("Winsock can't be started");
+    }
+    ~Winsock() { WSACleanup(); }
+  } winsock;
+}
+
+bool SetNonBlocking(NativeSocket socket) {
+  u_long is_non_blocking = 1;
+  return ioctlsocket(socket, FIONBIO, &is_non_blocking) == 0;
+}
+
+void CloseSocket(NativeSocket socket) { closesocket(socket); }
+
+std::string GetSocketError() { return "error " + std::to_string(WSAGetLastError()); }
+#else
+using NativeSocket = int;
+using DatagramSize = ssize_t;
+
+void StartSockets() {}
+
+bool SetNonBlocking(NativeSocket socket) {
+  return fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) == 0;
+}
+
+void CloseSocket(NativeSocket socket) { close(socket); }
+
+std::string GetSocketError() { return std::strerror(errno); }
+#endif
+
+// INVALID_SOCKET on Windows.
+constexpr intptr_t kInvalidSocket = -1;
+}  // namespace
+
+UdpTransport::UdpTransport(uint16_t local_port, const std::string& remote_host,
+                           uint16_t remote_port, const LinkConditions& conditions)
+    : conditions_(conditions), gen_(std::random_device()()) {
+  StartSockets();
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  addrinfo* remote = nullptr;
+  if (getaddrinfo(remote_host.c_str(), nullptr, &hints, &remote) != 0 || !remote) {
+    std::cerr << "Unknown host: " << remote_host << std::endl;
+    throw std::runtime_error("Unknown host");
+  }
+  remote_ip_ = reinterpret_cast<const sockaddr_in*>(remote->ai_addr)->sin_addr.s_addr;
+  remote_port_ = htons(remote_port);
+  freeaddrinfo(remote);
+
+  const NativeSocket native_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  socket_ = static_cast<intptr_t>(native_socket);
+  sockaddr_in local_address = {};
+  local_address.sin_family = AF_INET;
+  local_address.sin_addr.s_addr = htonl(INADDR_ANY);
+  local_address.sin_port = htons(local_port);
+  if (socket_ == kInvalidSocket ||
+      bind(native_socket, reinterpret_cast<sockaddr*>(&local_address), sizeof(local_address)) !=
+          0 ||
+      !SetNonBlocking(native_socket)) {
+    std::cerr << "UDP port " << local_port << " can't be opened: " << GetSocketError()
+              << std::endl;
+    if (socket_ != kInvalidSocket) CloseSocket(native_socket);
+    throw std::runtime_error("UDP port can't be opened");
+  }
+}
+
+UdpTransport::~UdpTransport() { CloseSocket(static_cast<NativeSocket>(socket_)); }
+
+void UdpTransport::Send(const void* data, size_t size) {
+  if (std::bernoulli_distribution(conditions_.loss)(gen_)) return;
+  if (conditions_.latency <= 0.0f && conditions_.jitter <= 0.0f) {
+    SendNow(data, size);
+    return;
+  }
+
+  std::uniform_real_distribution<float> jitter(-conditions_.jitter, conditions_.jitter);
+  const float delay = std::max(0.0f, conditions_.latency + jitter(gen_));
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  delayed_.push_back({Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                         std::chrono::duration<float, std::milli>(delay)),
+                      std::vector<uint8_t>(bytes, bytes + size)});
+}
+
+size_t UdpTransport::Receive(void* buffer, size_t capacity) {
+  SendDueDatagrams();
+  while (true) {
+    sockaddr_in sender = {};
+    socklen_t sender_size = sizeof(sender);
+    const DatagramSize size =
+        recvfrom(static_cast<NativeSocket>(socket_), static_cast<char*>(buffer),
+                 static_cast<int>(capacity), 0, reinterpret_cast<sockaddr*>(&sender), &sender_size);
+    if (size <= 0) return 0;
+    if (sender.sin_addr.s_addr == remote_ip_ && sender.sin_port == remote_port_) return size;
+  }
+}
+
+void UdpTransport::SendNow(const void* data, size_t size) {
+  sockaddr_in remote_address = {};
+  remote_address.sin_family = AF_INET;
+  remote_address.sin_addr.s_addr = remote_ip_;
+  remote_address.sin_port = remote_port_;
+  // A full buffer drops the datagram, like the network would.
+  sendto(static_cast<NativeSocket>(socket_), static_cast<const char*>(data),
+         static_cast<int>(size), 0, reinterpret_cast<const sockaddr*>(&remote_address),
+         sizeof(remote_address));
+}
+
+void UdpTransport::SendDueDatagrams() {
+  // Jitter reorders the datagrams, like on real networks.
+  const Clock::time_point now = Clock::now();
+  auto due =
+      std::stable_partition(delayed_.begin(), delayed_.end(),
+                            [now](const DelayedDatagram& datagram) { return datagram.due > now; });
+  for (auto datagram = due; datagram != delayed_.end(); ++datagram)
+    SendNow(datagram->data.data(), datagram->data.size());
+  delayed_.erase(due, delayed_.end());
+}
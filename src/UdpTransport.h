@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Network faults added to what is sent, to try network play on one machine,
+// e.g. over the loopback interface.
+struct LinkConditions {
+  float latency = 0.0f;  // Milliseconds before a datagram leaves.
+  float jitter = 0.0f;   // Up to this many milliseconds more or less.
+  float loss = 0.0f;     // Fraction of the datagrams dropped.
+};
+
+// Datagrams to and from a single peer, without blocking. Datagrams from other
+// addresses are ignored.
+class UdpTransport {
+ public:
+  // Binds to the local port, on every interface. Throws if the socket can't
+  // be opened or the remote host resolved.
+  UdpTransport(uint16_t local_port, const std::string& remote_host, uint16_t remote_port,
+               const LinkConditions& conditions = {});
+  ~UdpTransport();
+
+  UdpTransport(const UdpTransport&) = delete;
+  UdpTransport& operator=(const UdpTransport&) = delete;
+
+  // Sends now, or later under latency. Datagrams may be lost or reordered.
+  void Send(const void* data, size_t size);
+
+  // Copies the next datagram received into the buffer and returns its size,
+  // or returns 0 if there is none. Sends the delayed datagrams that are due.
+  size_t Receive(void* buffer, size_t capacity);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct DelayedDatagram {
+    Clock::time_point due;
+    std::vector<uint8_t> data;
+  };
+
+  void SendNow(const void* data, size_t size);
+  void SendDueDatagrams();
+
+  // A file descriptor, or on Windows a SOCKET, which is wider than an int.
+  intptr_t socket_ = -1;
+  // IPv4, in network byte order. Kept apart from the socket headers, which
+  // are Winsock's on Windows.
+  uint32_t remote_ip_ = 0;
+  uint16_t remote_port_ = 0;
+  LinkConditions conditions_;
+  std::mt19937 gen_;
+  std::vector<DelayedDatagram> delayed_;
+};
@@ -0,0 +1,43 @@
+#include "VertexFormat.h"
+
+#include <glm/gtc/packing.hpp>
+
+VertexLayout::VertexLayout(GLsizei stride, std::initializer_list<VertexAttribute> attributes)
+    : stride_(stride), attributes_(attributes) {}
+
+void VertexLayout::Apply() const {
+  for (const auto& attribute : attributes_) {
+    glEnableVertexAttribArray(attribute.location);
+    glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized,
+                          stride_, (void*)attribute.offset);
+    glVertexAttribDivisor(attribute.location, attribute.divisor);
+  }
+}
+
+GLuint PackNormal(const glm::vec3& normal) {
+  return glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+}
+
+GLhalf PackHalf(float value) { return glm::packHalf1x16(value); }
+
+GLubyte PackUnorm8(float value) {
+  return static_cast<GLubyte>(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+LitVertex::LitVertex(const glm::vec3& position, const glm::vec3& normal)
+    : position{PackHalf(position.x), PackHalf(position.y), PackHalf(position.z)},
+      light(PackHalf(1.0f)),
+      normal(PackNormal(normal)) {}
+
+const VertexLayout& LitVertex::Layout() {
+  // Board and paddle coordinates are small integers, exactly representable as
+  // half floats.
+  static const VertexLayout layout(
+      sizeof(LitVertex),
+      {
+          {kPositionAttribute, 3, GL_HALF_FLOAT, GL_FALSE, offsetof(LitVertex, position)},
+          {kLightAttribute, 1, GL_HALF_FLOAT, GL_FALSE, offsetof(LitVertex, light)},
+          {kNormalAttribute, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(LitVertex, normal)},
+      });
+  return layout;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <initializer_list>
+#include <vector>
+
+#ifdef __EMSCRIPTEN__
+#include <GLES3/gl3.h>
+#else
+#include <GL/glew.h>
+#endif
+
+// Attribute locations bound by Shader before linking, so vertex layouts don't
+// depend on any particular program.
+constexpr GLuint kPositionAttribute = 0;  // aPos
+constexpr GLuint kNormalAttribute = 1;    // aNormal
+constexpr GLuint kTexCoordAttribute = 2;  // aTexCoord
+constexpr GLuint kColorAttribute = 3;     // aColor
+constexpr GLuint kRectAttribute = 4;      // aRect
+constexpr GLuint kGlyphAttribute = 5;     // aGlyph
+constexpr GLuint kLightAttribute = 6;     // aLight
+constexpr GLuint kCenterAttribute = 7;    // aCenter
+
+// One attribute inside an interleaved vertex buffer.
+struct VertexAttribute {
+  GLuint location;
+  GLint size;
+  GLenum type;
+  GLboolean normalized;
+  size_t offset;
+  // 0 for per-vertex attributes, 1 for per-instance attributes.
+  GLuint divisor = 0;
+};
+
+// Interleaved vertex buffer layout.
+class VertexLayout {
+ public:
+  VertexLayout(GLsizei stride, std::initializer_list<VertexAttribute> attributes);
+
+  // Enables and describes the attributes of the bound GL_ARRAY_BUFFER on the
+  // bound vertex array object.
+  void Apply() const;
+
+  GLsizei GetStride() const { return stride_; }
+
+ private:
+  GLsizei stride_;
+  std::vector<VertexAttribute> attributes_;
+};
+
+// Packs a unit normal as GL_INT_2_10_10_10_REV.
+GLuint PackNormal(const glm::vec3& normal);
+
+// Packs a float as GL_HALF_FLOAT.
+GLhalf PackHalf(float value);
+
+// Packs a [0, 1] float as a normalized GL_UNSIGNED_BYTE.
+GLubyte PackUnorm8(float value);
+
+// Vertex of the static lit geometry (board and paddles): half-float position,
+// baked light (see BakeLighting()) and packed normal, 12 bytes instead of 24.
+struct LitVertex {
+  LitVertex(const glm::vec3& position, const glm::vec3& normal);
+
+  static const VertexLayout& Layout();
+
+  GLhalf position[3];
+  GLhalf light;
+  GLuint normal;
+};
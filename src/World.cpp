@@ -0,0 +1,8 @@
+#include "World.h"
+
+void World::Destroy(Entity entity) {
+  balls.Remove(entity);
+  trails.Remove(entity);
+  paddles.Remove(entity);
+  entities.Destroy(entity);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ComponentStore.h"
+#include "Components.h"
+#include "Entity.h"
+
+// Entities of the game and their components. Systems keep no state per
+// entity: they iterate the component stores, and entities refer to each other
+// through handles.
+struct World {
+  Entity Create() { return entities.Create(); }
+
+  // Removes the entity's components and invalidates its handles.
+  void Destroy(Entity entity);
+
+  EntityPool entities;
+  ComponentStore<Ball> balls;
+  ComponentStore<BallTrail> trails;
+  ComponentStore<Paddle> paddles;
+};
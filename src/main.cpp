@@ -4,7 +4,8 @@
 
 int main(int argc, char* argv[]) {
   try {
-    GLPong game;
+    SystemClock clock;
+    GLPong game(clock);
     game.Run();
   } catch (const std::exception& e) {
     std::cerr << "An exception occurred: " << e.what() << std::endl;
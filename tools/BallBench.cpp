@@ -0,0 +1,183 @@
+// Offline benchmark of the multi-ball mode on one thread: the work of
+// BallSystem in a tick, without GL. Balls move and bounce off each other, with
+// the grid and with every pair for comparison; their trails are updated and
+// copied as for a snapshot. Also checks that the grid finds every pair of
+// touching balls.
+//
+// Usage: ball_bench [ticks]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "BallGrid.h"
+#include "Components.h"
+#include "ParticleKernels.h"
+#include "PongPhysics.h"
+#include "Random.h"
+
+namespace {
+constexpr float kTickTime = 1.0f / 60.0f;
+
+struct Balls {
+  explicit Balls(int count)
+      : radius(GetBallRadius(count)), grid(2.0f * radius), positions(count), speeds(count),
+        trails(count) {
+    Xorshift64 generator(1);
+    std::uniform_real_distribution<float> x(kBoardRight + kPaddleWidth + radius,
+                                            kBoardLeft - kPaddleWidth - radius);
+    std::uniform_real_distribution<float> y(kBoardBottom + radius, kBoardTop - radius);
+    for (int i = 0; i < count; ++i) {
+      ServeBall(positions[i], speeds[i], i % 2, NextServeAngle(random_state));
+      positions[i] = {x(generator), y(generator)};
+      for (TrailParticle& particle : trails[i].particles)
+        particle = {1.0f, 10.0f, glm::vec3(positions[i], -radius)};
+    }
+  }
+
+  float radius;
+  BallGrid grid;
+  std::vector<glm::vec2> positions;
+  std::vector<glm::vec2> speeds;
+  std::vector<BallTrail> trails;
+  std::vector<BillboardParticle> particles;
+  uint64_t random_state = 42;
+  float time = 0.0f;
+  float paddle_y = 0.0f;
+};
+
+void MoveBalls(Balls& balls) {
+  // Paddles sweeping up and down.
+  balls.time += kTickTime;
+  balls.paddle_y = (kBoardTop - kPaddleHeight) * std::sin(2.0f * balls.time);
+  for (size_t i = 0; i < balls.positions.size(); ++i) {
+    const uint8_t events = StepBall(balls.positions[i], balls.speeds[i], &balls.paddle_y,
+                                    &balls.paddle_y, kTickTime, balls.radius);
+    if (events & (kBallPassedLeft | kBallPassedRight)) {
+      ServeBall(balls.positions[i], balls.speeds[i], events & kBallPassedLeft,
+                NextServeAngle(balls.random_state));
+    }
+  }
+}
+
+int CollideWithGrid(Balls& balls) {
+  balls.grid.Build(balls.positions);
+  int bounce_count = 0;
+  balls.grid.ForEachNearbyPair([&](uint32_t i, uint32_t j) {
+    bounce_count += CollideBalls(balls.positions[i], balls.speeds[i], balls.positions[j],
+                                 balls.speeds[j], balls.radius);
+  });
+  return bounce_count;
+}
+
+int CollideEveryPair(Balls& balls) {
+  int bounce_count = 0;
+  for (size_t i = 0; i < balls.positions.size(); ++i) {
+    for (size_t j = i + 1; j < balls.positions.size(); ++j) {
+      bounce_count += CollideBalls(balls.positions[i], balls.speeds[i], balls.positions[j],
+                                   balls.speeds[j], balls.radius);
+    }
+  }
+  return bounce_count;
+}
+
+void UpdateTrails(Balls& balls) {
+  for (size_t i = 0; i < balls.trails.size(); ++i) {
+    for (TrailParticle& particle : balls.trails[i].particles) {
+      particle.life -= particle.fade * kTickTime;
+      if (particle.life >= 0.0f) continue;
+      particle.life = 1.0f;
+      particle.fade = 3.0f + 25.0f * NextRandom(balls.random_state);
+      particle.pos = glm::vec3(balls.positions[i], -balls.radius);
+    }
+  }
+  balls.particles.clear();
+  for (const BallTrail& trail : balls.trails) {
+    for (const TrailParticle& particle : trail.particles) {
+      if (particle.life > 0.0f)
+        balls.particles.push_back({particle.pos, particle.life, glm::vec3(0.0f, 1.0f, 0.0f)});
+    }
+  }
+}
+
+using Pairs = std::set<std::pair<uint32_t, uint32_t>>;
+
+Pairs FindTouchingPairs(const Balls& balls, bool with_grid) {
+  Pairs pairs;
+  auto add_if_touching = [&](uint32_t i, uint32_t j) {
+    if (glm::distance(balls.positions[i], balls.positions[j]) < 2.0f * balls.radius)
+      pairs.insert({std::min(i, j), std::max(i, j)});
+  };
+  if (with_grid) {
+    balls.grid.ForEachNearbyPair(add_if_touching);
+  } else {
+    for (uint32_t i = 0; i < balls.positions.size(); ++i)
+      for (uint32_t j = i + 1; j < balls.positions.size(); ++j) add_if_touching(i, j);
+  }
+  return pairs;
+}
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMilliseconds(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int ticks = argc > 1 ? std::atoi(argv[1]) : 600;
+
+  for (int count : {100, 1000, 2000, 5000}) {
+    Balls balls(count);
+    // Settled first: the balls start overlapping.
+    for (int tick = 0; tick < 60; ++tick) {
+      MoveBalls(balls);
+      CollideWithGrid(balls);
+    }
+    balls.grid.Build(balls.positions);
+    if (FindTouchingPairs(balls, true) != FindTouchingPairs(balls, false)) {
+      std::cout << "The grid misses touching balls" << std::endl;
+      return 1;
+    }
+
+    // The steps of each tick, timed apart.
+    int bounce_count = 0;
+    double move_time = 0.0, grid_time = 0.0, trail_time = 0.0;
+    for (int tick = 0; tick < ticks; ++tick) {
+      auto start = Clock::now();
+      MoveBalls(balls);
+      move_time += ElapsedMilliseconds(start);
+      start = Clock::now();
+      bounce_count += CollideWithGrid(balls);
+      grid_time += ElapsedMilliseconds(start);
+      start = Clock::now();
+      UpdateTrails(balls);
+      trail_time += ElapsedMilliseconds(start);
+    }
+    move_time /= ticks;
+    grid_time /= ticks;
+    trail_time /= ticks;
+    // Quadratic: on fewer ticks.
+    const int every_pair_ticks = std::max(1, ticks * 10 / count);
+    const auto start = Clock::now();
+    for (int tick = 0; tick < every_pair_ticks; ++tick) {
+      MoveBalls(balls);
+      CollideEveryPair(balls);
+    }
+    const double every_pair_time = ElapsedMilliseconds(start) / every_pair_ticks - move_time;
+    const double tick_time = move_time + grid_time + trail_time;
+    std::cout << count << " balls of radius " << balls.radius << ": " << tick_time
+              << " ms per tick (" << 1000.0 / tick_time << " Hz)" << std::endl;
+    std::cout << "  move " << move_time << " ms, collide " << grid_time << " ms ("
+              << double(bounce_count) / ticks << " bounces), trails " << trail_time << " ms, "
+              << balls.particles.size() << " particles" << std::endl;
+    std::cout << "  every pair instead of the grid: " << every_pair_time << " ms" << std::endl;
+  }
+  return 0;
+}
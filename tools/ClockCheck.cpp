@@ -0,0 +1,78 @@
+// Headless check of the game loop's pacing: the tick loop of TickPacer runs on
+// a FakeClock at several time scales, with a tick of work each, and must
+// take the time the scale asks for. Also checks the fake clock itself, and
+// that a stall restarts the ticks rather than catching up.
+//
+// Usage: clock_check
+
+#include <cmath>
+#include <iostream>
+
+#include "GameClock.h"
+
+namespace {
+constexpr double kTick = 1.0 / 120.0;
+constexpr int kTickCount = 1200;
+constexpr double kWorkTime = 0.001;  // Of each tick, on the clock.
+
+bool Check(bool condition, const char* what) {
+  if (!condition) std::cout << "Failed: " << what << std::endl;
+  return condition;
+}
+
+bool IsNear(double a, double b) { return std::abs(a - b) < 1e-6; }
+
+// Seconds of the clock kTickCount ticks take.
+double RunTicks(FakeClock& clock, double time_scale) {
+  TickPacer pacer(clock);
+  const double start = clock.GetTime();
+  for (int i = 0; i < kTickCount; ++i) {
+    clock.Advance(kWorkTime);
+    pacer.ScheduleNext(kTick, time_scale);
+    pacer.WaitForNextTick([] { return true; });
+  }
+  return clock.GetTime() - start;
+}
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  FakeClock clock(10.0);
+  clock.Advance(0.5);
+  ok &= Check(IsNear(clock.GetTime(), 10.5), "Advance() moves the time");
+  clock.SleepUntil(11.0);
+  ok &= Check(IsNear(clock.GetTime(), 11.0), "SleepUntil() jumps to the time");
+  clock.SleepUntil(10.0);
+  ok &= Check(IsNear(clock.GetTime(), 11.0), "SleepUntil() never goes back");
+  ok &= Check(!clock.WaitEventUntil(12.0) && IsNear(clock.GetTime(), 12.0),
+              "WaitEventUntil() waits the whole time");
+
+  for (double scale : {0.25, 1.0, 4.0}) {
+    const double time = RunTicks(clock, scale);
+    const double expected = kTickCount * kTick / scale;
+    std::cout << "Scale " << scale << ": " << time << " s for " << kTickCount << " ticks, "
+              << expected << " s expected" << std::endl;
+    ok &= Check(IsNear(time, expected), "ticks are paced by the time scale");
+  }
+  // Faster than the work allows: only the work takes time.
+  const double fast_time = RunTicks(clock, 100.0);
+  ok &= Check(IsNear(fast_time, kTickCount * kWorkTime), "late ticks follow each other");
+  const double unlimited_time = RunTicks(clock, kUnlimitedTimeScale);
+  std::cout << "As fast as possible: " << unlimited_time << " s for " << kTickCount << " ticks"
+            << std::endl;
+  ok &= Check(IsNear(unlimited_time, kTickCount * kWorkTime), "unlimited ticks don't wait");
+
+  // A stall of a second: the next tick is right away, and the one after a
+  // tick later, instead of a burst of the ticks missed.
+  TickPacer pacer(clock);
+  clock.Advance(1.0);
+  pacer.ScheduleNext(kTick, 1.0);
+  ok &= Check(IsNear(pacer.GetNextTick(), clock.GetTime()), "a stall restarts from now");
+  pacer.ScheduleNext(kTick, 1.0);
+  pacer.WaitForNextTick([] { return true; });
+  ok &= Check(IsNear(pacer.GetNextTick(), clock.GetTime()), "then ticks are paced again");
+
+  std::cout << (ok ? "OK" : "FAILED") << std::endl;
+  return ok ? 0 : 1;
+}
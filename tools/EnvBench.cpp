@@ -0,0 +1,92 @@
+// Offline benchmark of the batched training environment: steps per second with
+// random actions, on one thread and more. Also checks that a seed replays the
+// same matches.
+//
+// Usage: env_bench [environment count] [steps]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "PongEnv.h"
+
+namespace {
+struct Buffers {
+  explicit Buffers(int env_count)
+      : actions(2 * env_count),
+        observations(PongEnv::kObservationSize * env_count),
+        rewards(2 * env_count),
+        dones(env_count) {}
+
+  std::vector<int8_t> actions;
+  std::vector<float> observations;
+  std::vector<float> rewards;
+  std::vector<uint8_t> dones;
+};
+
+// Random actions, drawn beforehand so that the generator is not measured.
+std::vector<int8_t> MakeActions(int env_count, int batch_count) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> random(-1, 1);
+  std::vector<int8_t> actions(2 * env_count * batch_count);
+  for (int8_t& action : actions) action = static_cast<int8_t>(random(generator));
+  return actions;
+}
+
+// Runs steps, returning the points and finished matches in the last buffers.
+void Run(PongEnv& env, const std::vector<int8_t>& actions, int steps, Buffers& buffers,
+         int& point_count, int& match_count) {
+  const size_t batch_size = 2 * env.GetEnvCount();
+  const int batch_count = static_cast<int>(actions.size() / batch_size);
+  env.Reset(42, buffers.observations.data());
+  point_count = 0;
+  match_count = 0;
+  for (int step = 0; step < steps; ++step) {
+    env.Step(actions.data() + step % batch_count * batch_size, buffers.observations.data(),
+             buffers.rewards.data(), buffers.dones.data());
+    for (int i = 0; i < env.GetEnvCount(); ++i) {
+      point_count += buffers.rewards[2 * i] != 0.0f;
+      match_count += buffers.dones[i] == PongEnv::kMatchOver;
+    }
+  }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int env_count = argc > 1 ? std::atoi(argv[1]) : 4096;
+  const int steps = argc > 2 ? std::atoi(argv[2]) : 2000;
+  const std::vector<int8_t> actions = MakeActions(env_count, 64);
+  std::cout << env_count << " environments, " << steps << " steps" << std::endl;
+
+  // Matches depend on the seed and the actions only, not on the threads.
+  Buffers reference(env_count), threaded(env_count);
+  int point_count, match_count, threaded_point_count, threaded_match_count;
+  PongEnv single(env_count);
+  PongEnv parallel(env_count, 1.0f / 60.0f, 0, 3);
+  Run(single, actions, 500, reference, point_count, match_count);
+  Run(parallel, actions, 500, threaded, threaded_point_count, threaded_match_count);
+  if (reference.observations != threaded.observations || point_count != threaded_point_count) {
+    std::cout << "Threaded steps disagree with the single thread" << std::endl;
+    return 1;
+  }
+
+  for (int threads : {1, 2, 4}) {
+    PongEnv env(env_count, 1.0f / 60.0f, 0, threads);
+    Buffers buffers(env_count);
+    double best = 1e9;
+    for (int run = 0; run < 3; ++run) {
+      const auto start = std::chrono::steady_clock::now();
+      Run(env, actions, steps, buffers, point_count, match_count);
+      const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+      best = std::min(best, duration.count());
+    }
+    std::cout << "  " << threads << (threads == 1 ? " thread: " : " threads: ")
+              << double(env_count) * steps / best / 1e6 << " M steps/s, " << point_count
+              << " points, " << match_count << " matches" << std::endl;
+  }
+  return 0;
+}
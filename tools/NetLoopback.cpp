@@ -0,0 +1,99 @@
+// Two peers of a network match in one process, over loopback UDP with network
+// faults, playing random inputs in real time. Reports the rollbacks and their
+// cost, and fails if the peers desynchronize.
+//
+// Usage: net_loopback [seconds] [latency ms] [jitter ms] [loss] [input delay]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include "MatchState.h"
+#include "RollbackSession.h"
+#include "UdpTransport.h"
+
+constexpr uint16_t kLeftPort = 47701;
+constexpr uint16_t kRightPort = 47702;
+constexpr int kTickRate = 60;
+
+namespace {
+// Holds a random direction for a random time, like a player would.
+class RandomPlayer {
+ public:
+  explicit RandomPlayer(unsigned seed) : gen_(seed) {}
+
+  uint8_t NextInput() {
+    if (--ticks_left_ <= 0) {
+      ticks_left_ = std::uniform_int_distribution<int>(5, 40)(gen_);
+      input_ = std::uniform_int_distribution<int>(0, 2)(gen_);
+    }
+    return input_;
+  }
+
+ private:
+  std::mt19937 gen_;
+  int ticks_left_ = 0;
+  uint8_t input_ = 0;
+};
+
+void Report(const char* name, const RollbackStats& stats, int frame_count) {
+  std::cout << name << ": " << stats.tick_count << " ticks, " << stats.rollback_count
+            << " rollbacks, " << stats.stall_count << " stalls, " << stats.sync_wait_count
+            << " sync waits, " << stats.checked_hash_count << " hashes checked" << std::endl;
+  std::cout << "  re-simulation per frame: "
+            << double(stats.total_resimulated_ticks) / frame_count << " ticks, "
+            << stats.total_resimulation_time * 1000.0 / frame_count << " us on average; "
+            << stats.max_resimulated_ticks << " ticks, " << stats.max_resimulation_time * 1000.0f
+            << " us at most" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const float seconds = argc > 1 ? std::atof(argv[1]) : 10.0f;
+  LinkConditions conditions;
+  conditions.latency = argc > 2 ? std::atof(argv[2]) : 50.0f;
+  conditions.jitter = argc > 3 ? std::atof(argv[3]) : 10.0f;
+  conditions.loss = argc > 4 ? std::atof(argv[4]) : 0.05f;
+  const int input_delay = argc > 5 ? std::atoi(argv[5]) : 2;
+  std::cout << "Latency " << conditions.latency << " ms, jitter " << conditions.jitter
+            << " ms, loss " << conditions.loss * 100.0f << "%, input delay " << input_delay
+            << " ticks" << std::endl;
+
+  UdpTransport left_transport(kLeftPort, "127.0.0.1", kRightPort, conditions);
+  UdpTransport right_transport(kRightPort, "127.0.0.1", kLeftPort, conditions);
+  const float tick_time = 1.0f / kTickRate;
+  RollbackSession left(left_transport, true, 1234, tick_time, input_delay);
+  RollbackSession right(right_transport, false, 1234, tick_time, input_delay);
+  RandomPlayer left_player(1), right_player(2);
+
+  // A frame per tick, like the game.
+  using Clock = std::chrono::steady_clock;
+  const auto frame_time = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<float>(tick_time));
+  const int frame_count = static_cast<int>(seconds * kTickRate);
+  auto next_frame = Clock::now();
+  for (int frame = 0; frame < frame_count; ++frame) {
+    left.AdvanceTick(left_player.NextInput());
+    right.AdvanceTick(right_player.NextInput());
+    next_frame += frame_time;
+    std::this_thread::sleep_until(next_frame);
+  }
+
+  Report("Left", left.GetStats(), frame_count);
+  Report("Right", right.GetStats(), frame_count);
+  const MatchState& state = left.GetState();
+  std::cout << "Score " << state.left_score << " - " << state.right_score << std::endl;
+
+  if (left.GetStats().desync_tick >= 0 || right.GetStats().desync_tick >= 0) {
+    std::cout << "Desynchronized" << std::endl;
+    return 1;
+  }
+  if (!left.GetStats().checked_hash_count || !right.GetStats().checked_hash_count) {
+    std::cout << "No state compared" << std::endl;
+    return 1;
+  }
+  return 0;
+}
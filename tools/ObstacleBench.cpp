@@ -0,0 +1,123 @@
+// Offline benchmark of the obstacle field: building its hierarchy, moving the
+// moving obstacles and sweeping balls through it, from 10 to 100000 obstacles
+// covering a fifth of the board. Sweeps are compared with testing every
+// obstacle, and must find the same hits.
+//
+// Usage: obstacle_bench [sweeps]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ObstacleField.h"
+#include "PongPhysics.h"
+#include "Random.h"
+
+namespace {
+constexpr float kCoverage = 0.2f;
+constexpr float kMovingFraction = 0.1f;
+constexpr float kTickTime = 1.0f / 60.0f;
+
+std::vector<Obstacle> CreateObstacles(int count, Xorshift64& generator) {
+  const float board_area = (kBoardLeft - kBoardRight) * (kBoardTop - kBoardBottom);
+  // Smaller the more they are.
+  const float area = kCoverage * board_area / count;
+  std::uniform_real_distribution<float> x(kBoardRight, kBoardLeft);
+  std::uniform_real_distribution<float> y(kBoardBottom, kBoardTop);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::uniform_real_distribution<float> aspect(0.25f, 4.0f);
+  std::vector<Obstacle> obstacles(count);
+  for (Obstacle& obstacle : obstacles) {
+    obstacle.center = {x(generator), y(generator)};
+    if (unit(generator) < 0.5f) {
+      const float ratio = std::sqrt(aspect(generator));
+      obstacle.half_size = 0.5f * std::sqrt(area) * glm::vec2(ratio, 1.0f / ratio);
+    } else {
+      obstacle.shape = Obstacle::Shape::kBumper;
+      obstacle.radius = std::sqrt(area / 3.14159265f);
+    }
+    if (unit(generator) < kMovingFraction) {
+      obstacle.motion = glm::vec2(unit(generator), unit(generator)) * 4.0f * std::sqrt(area);
+      obstacle.period = 2.0f + 4.0f * unit(generator);
+    }
+  }
+  return obstacles;
+}
+
+struct Query {
+  glm::vec2 position;
+  glm::vec2 motion;
+};
+
+// Balls at full speed, moving by a tick.
+std::vector<Query> CreateQueries(int count, Xorshift64& generator) {
+  std::uniform_real_distribution<float> x(kBoardRight, kBoardLeft);
+  std::uniform_real_distribution<float> y(kBoardBottom, kBoardTop);
+  std::uniform_real_distribution<float> angle(0.0f, 2.0f * 3.14159265f);
+  std::vector<Query> queries(count);
+  for (Query& query : queries) {
+    const float a = angle(generator);
+    query.position = {x(generator), y(generator)};
+    query.motion = kBallSpeed * kTickTime * glm::vec2(std::cos(a), std::sin(a));
+  }
+  return queries;
+}
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMilliseconds(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int sweep_count = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+  Xorshift64 generator(1);
+  const std::vector<Query> queries = CreateQueries(sweep_count, generator);
+  for (int count : {10, 100, 1000, 10000, 100000}) {
+    std::vector<Obstacle> obstacles = CreateObstacles(count, generator);
+    auto start = Clock::now();
+    ObstacleField field(obstacles);
+    const double build_time = ElapsedMilliseconds(start);
+
+    start = Clock::now();
+    constexpr int kMoveTicks = 60;
+    for (int tick = 1; tick <= kMoveTicks; ++tick) field.SetTime(tick * kTickTime);
+    const double move_time = ElapsedMilliseconds(start) / kMoveTicks;
+
+    int hit_count = 0;
+    start = Clock::now();
+    for (const Query& query : queries)
+      hit_count += field.Sweep(query.position, query.motion, kBallRadius).has_value();
+    const double sweep_time = ElapsedMilliseconds(start) * 1e6 / sweep_count;
+
+    // Linear: on fewer sweeps.
+    const int every_obstacle_count =
+        std::clamp(int(int64_t(sweep_count) * 10 / count), 1, sweep_count);
+    start = Clock::now();
+    for (int i = 0; i < every_obstacle_count; ++i)
+      field.SweepEveryObstacle(queries[i].position, queries[i].motion, kBallRadius);
+    const double every_obstacle_time = ElapsedMilliseconds(start) * 1e6 / every_obstacle_count;
+
+    for (int i = 0; i < every_obstacle_count; ++i) {
+      const auto hit = field.Sweep(queries[i].position, queries[i].motion, kBallRadius);
+      const auto expected =
+          field.SweepEveryObstacle(queries[i].position, queries[i].motion, kBallRadius);
+      if (hit.has_value() != expected.has_value() || (hit && hit->time != expected->time)) {
+        std::cout << "The hierarchy misses obstacles" << std::endl;
+        return 1;
+      }
+    }
+
+    std::cout << count << " obstacles, " << field.GetNodeCount() << " nodes: built in "
+              << build_time << " ms, moved in " << move_time << " ms" << std::endl;
+    std::cout << "  sweep " << sweep_time << " ns (" << 100.0 * hit_count / sweep_count
+              << "% hit), every obstacle instead: " << every_obstacle_time << " ns" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Packs resource files into an AssetArchive (see src/AssetArchive.h), written
+// as a C++ source file that builds the archive into the executable.
+//
+// Usage: pack_assets <output.cpp> <root directory> <files...>
+//
+// Assets are named after their path relative to the root directory.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "AssetArchive.h"
+#include "Cache.h"
+
+namespace {
+struct InputFile {
+  std::string name;
+  std::vector<char> data;
+};
+
+size_t Align(size_t offset) {
+  return (offset + AssetArchive::kAlignment - 1) / AssetArchive::kAlignment *
+         AssetArchive::kAlignment;
+}
+
+std::vector<unsigned char> Pack(const std::vector<InputFile>& files) {
+  const size_t index_size =
+      sizeof(AssetArchive::Header) + files.size() * sizeof(AssetArchive::Entry);
+  size_t size = index_size;
+  for (const InputFile& file : files) size += file.name.size() + 1;
+  std::vector<size_t> data_offsets;
+  for (const InputFile& file : files) {
+    size = Align(size);
+    data_offsets.push_back(size);
+    size += file.data.size() + 1;
+  }
+
+  std::vector<unsigned char> archive(size, 0);
+  AssetArchive::Header header = {};
+  std::memcpy(header.magic, AssetArchive::kMagic, sizeof(header.magic));
+  header.version = AssetArchive::kVersion;
+  header.entry_count = files.size();
+  std::memcpy(archive.data(), &header, sizeof(header));
+
+  size_t name_offset = index_size;
+  for (size_t i = 0; i < files.size(); ++i) {
+    const InputFile& file = files[i];
+    AssetArchive::Entry entry = {};
+    entry.hash = HashBytes(file.data.data(), file.data.size());
+    entry.name_offset = name_offset;
+    entry.data_offset = data_offsets[i];
+    entry.data_size = file.data.size();
+    std::memcpy(archive.data() + sizeof(header) + i * sizeof(entry), &entry, sizeof(entry));
+
+    std::copy(file.name.begin(), file.name.end(), archive.begin() + name_offset);
+    name_offset += file.name.size() + 1;
+    std::copy(file.data.begin(), file.data.end(), archive.begin() + data_offsets[i]);
+  }
+  return archive;
+}
+
+bool WriteSource(const std::filesystem::path& path, const std::vector<unsigned char>& archive) {
+  std::ofstream source(path, std::ios::trunc);
+  source << "// Generated by tools/PackAssets.cpp. Do not edit.\n"
+            "#include <cstddef>\n\n"
+            "extern const unsigned char kAssetArchiveData[];\n"
+            "extern const size_t kAssetArchiveSize;\n\n"
+            "alignas("
+         << AssetArchive::kAlignment << ") const unsigned char kAssetArchiveData[] = {";
+  for (size_t i = 0; i < archive.size(); ++i) {
+    if (i % 16 == 0) source << "\n   ";
+    source << ' ' << static_cast<int>(archive[i]) << ',';
+  }
+  source << "\n};\n"
+            "const size_t kAssetArchiveSize = "
+         << archive.size() << ";\n";
+  return static_cast<bool>(source);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <output.cpp> <root directory> <files...>" << std::endl;
+    return 1;
+  }
+  const std::filesystem::path output = argv[1];
+  const std::filesystem::path root = argv[2];
+
+  std::vector<InputFile> files;
+  for (int i = 3; i < argc; ++i) {
+    std::ifstream input(argv[i], std::ios::binary);
+    if (!input) {
+      std::cerr << "Cannot read " << argv[i] << std::endl;
+      return 1;
+    }
+    InputFile file;
+    file.name = std::filesystem::path(argv[i]).lexically_relative(root).generic_string();
+    file.data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    files.push_back(std::move(file));
+  }
+  // The archive index is searched by name.
+  std::sort(files.begin(), files.end(),
+            [](const InputFile& a, const InputFile& b) { return a.name < b.name; });
+
+  if (!WriteSource(output, Pack(files))) {
+    std::cerr << "Cannot write " << output.string() << std::endl;
+    return 1;
+  }
+  return 0;
+}
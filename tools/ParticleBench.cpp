@@ -0,0 +1,137 @@
+// Offline benchmark of the particle kernels: scalar against SIMD, and the
+// update split over threads.
+//
+// Usage: particle_bench [particle count] [iterations]
+//
+// Build it with make.sh --bench to run it under Node.js as WebAssembly, with
+// SIMD and threads. The CMake build makes a native version.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ParticleKernels.h"
+
+namespace {
+// Particles of the size of the fire ones, all active, some fading out.
+ParticleArrays MakeParticles(size_t count) {
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> random(0.0f, 1.0f);
+  ParticleArrays particles(count);
+  for (size_t i = 0; i < count; ++i) {
+    particles.active[i] = ~0;
+    particles.initial_life[i] = 1.0f + random(generator);
+    particles.life[i] = particles.initial_life[i] * random(generator);
+    particles.initial_size[i] = 0.8f;
+    particles.weight[i] = 0.8f;
+    particles.SetPosition(i, {random(generator), random(generator), random(generator)});
+    particles.SetSpeed(i, {random(generator), random(generator), random(generator)});
+    particles.SetColor(i, {1.0f, 0.5f, 0.0f});
+  }
+  return particles;
+}
+
+// Best time of a few runs, in seconds per iteration.
+double Measure(int iterations, const std::function<void()>& function) {
+  double best = 1e9;
+  for (int run = 0; run < 5; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) function();
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    best = std::min(best, duration.count() / iterations);
+  }
+  return best;
+}
+
+void Report(const char* name, size_t count, double seconds, double baseline) {
+  std::cout << "  " << name << ": " << count / seconds / 1e6 << " M particles/s, x"
+            << baseline / seconds << std::endl;
+}
+
+float MaxDifference(const std::vector<float>& a, const std::vector<float>& b) {
+  float difference = 0.0f;
+  for (size_t i = 0; i < a.size(); ++i) difference = std::max(difference, std::abs(a[i] - b[i]));
+  return difference;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const size_t count = argc > 1 ? std::atoi(argv[1]) : 100000;
+  const int iterations = argc > 2 ? std::atoi(argv[2]) : 100;
+  const float dt = 1.0f / 240.0f;
+  std::cout << count << " particles, " << iterations << " iterations, SIMD kernels "
+            << (HasSimdParticleKernels() ? "enabled" : "disabled (scalar fallback)") << std::endl;
+
+  // The kernels must agree before their speed matters. Particles die during
+  // the iterations, exercising the fading.
+  ParticleArrays scalar = MakeParticles(count);
+  ParticleArrays simd = MakeParticles(count);
+  for (int i = 0; i < iterations; ++i) {
+    UpdateParticlesScalar(scalar, 0, scalar.active.size(), dt, true);
+    UpdateParticlesSimd(simd, 0, simd.active.size(), dt, true);
+  }
+  const float difference = std::max({MaxDifference(scalar.x, simd.x),
+                                     MaxDifference(scalar.speed_y, simd.speed_y),
+                                     MaxDifference(scalar.size, simd.size),
+                                     MaxDifference(scalar.r, simd.r)});
+  std::cout << "Largest difference between the update kernels: " << difference << std::endl;
+  if (difference > 1e-4f) return 1;
+
+  std::cout << "Update:" << std::endl;
+  ParticleArrays particles = MakeParticles(count);
+  const size_t padded_count = particles.active.size();
+  // Small steps, so that particles stay alive across the runs.
+  const float step = 1e-6f;
+  const double update_scalar =
+      Measure(iterations, [&] { UpdateParticlesScalar(particles, 0, padded_count, step, true); });
+  Report("scalar", count, update_scalar, update_scalar);
+  Report("SIMD", count,
+         Measure(iterations,
+                 [&] { UpdateParticlesSimd(particles, 0, padded_count, step, true); }),
+         update_scalar);
+  for (int threads : {2, 4}) {
+    const std::string name = "SIMD, " + std::to_string(threads) + " threads";
+    Report(name.c_str(), count,
+           Measure(iterations, [&] { UpdateParticlesParallel(particles, step, true, threads); }),
+           update_scalar);
+  }
+
+  std::cout << "Billboards:" << std::endl;
+  std::vector<BillboardParticle> billboards(count);
+  for (size_t i = 0; i < count; ++i)
+    billboards[i] = {particles.GetPosition(i), particles.size[i], particles.GetColor(i)};
+  const glm::vec3 right(0.8f, 0.0f, 0.6f);
+  const glm::vec3 up(0.0f, 1.0f, 0.0f);
+  std::vector<BillboardVertex> vertices(count * 4);
+  std::vector<BillboardVertex> simd_vertices(count * 4);
+  ExpandBillboardsScalar(billboards.data(), count, right, up, vertices.data());
+  ExpandBillboardsSimd(billboards.data(), count, right, up, simd_vertices.data());
+  float position_difference = 0.0f;
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    const glm::vec3 offset = vertices[i].position - simd_vertices[i].position;
+    position_difference = std::max({position_difference, std::abs(offset.x), std::abs(offset.y),
+                                    std::abs(offset.z)});
+    if (std::memcmp(vertices[i].color, simd_vertices[i].color, 8) != 0) {
+      std::cout << "Billboard kernels disagree on the colors or texture coordinates" << std::endl;
+      return 1;
+    }
+  }
+  std::cout << "  largest difference between the kernels: " << position_difference << std::endl;
+  if (position_difference > 1e-4f) return 1;
+  const double expand_scalar = Measure(iterations, [&] {
+    ExpandBillboardsScalar(billboards.data(), count, right, up, vertices.data());
+  });
+  Report("scalar", count, expand_scalar, expand_scalar);
+  Report("SIMD", count, Measure(iterations, [&] {
+           ExpandBillboardsSimd(billboards.data(), count, right, up, vertices.data());
+         }),
+         expand_scalar);
+  return 0;
+}
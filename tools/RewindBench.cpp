@@ -0,0 +1,167 @@
+// Offline benchmark of the rewind history: a match between two AI paddles is
+// recorded at 60 ticks per second, then every tick kept is read back and
+// compared. Reports the memory per minute of history, its index included, the
+// time to record a tick and to seek to one.
+//
+// Usage: rewind_bench [minutes] [capacity in MB]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "PongPhysics.h"
+#include "RewindBuffer.h"
+
+namespace {
+constexpr float kTickTime = 1.0f / 60.0f;
+constexpr int kTicksPerMinute = 60 * 60;
+
+// One tick of a game alike to the real one: a ball with its trail, paddles
+// following the ball with some error and reaction time, fading lights.
+void Step(GameState& state) {
+  GameState::BallState& ball = state.balls[0];
+  GameState::PaddleState& left = state.paddles[0];
+  GameState::PaddleState& right = state.paddles[1];
+  const uint8_t events = StepBall(ball.position, ball.speed, &left.y, &right.y, kTickTime);
+  if (events & (kBallLeftPaddleHit | kBallRightPaddleHit | kBallPassedLeft | kBallPassedRight)) {
+    if (events & kBallPassedLeft) {
+      state.board.left_score = AddPoint(state.board.left_score);
+      state.board.illuminate_left_border = 1.0f;
+    } else if (events & kBallPassedRight) {
+      state.board.right_score = AddPoint(state.board.right_score);
+      state.board.illuminate_right_border = 1.0f;
+    } else {
+      (events & kBallLeftPaddleHit ? left : right).illuminate = 0.5f;
+    }
+    if (events & (kBallPassedLeft | kBallPassedRight)) {
+      ServeBall(ball.position, ball.speed, events & kBallPassedLeft,
+                NextServeAngle(state.ball_random_state));
+    }
+    ball.predicted_y = ball.position.y + ball.speed.y;
+    ++ball.trajectory_revision;
+  }
+  if (IsMatchWon(state.board.left_score, state.board.right_score) ||
+      IsMatchWon(state.board.right_score, state.board.left_score))
+    state.board.left_score = state.board.right_score = 0;
+  for (float* light : {&state.board.illuminate_left_border, &state.board.illuminate_right_border})
+    *light = std::max(0.0f, *light - kTickTime);
+
+  for (GameState::PaddleState& paddle : state.paddles) {
+    paddle.time_since_last_input += kTickTime;
+    paddle.illuminate = std::max(0.0f, paddle.illuminate - 0.3f * kTickTime);
+    if (paddle.ai_trajectory_revision != ball.trajectory_revision) {
+      paddle.ai_trajectory_revision = ball.trajectory_revision;
+      paddle.ai_reaction_time = 0.3f;
+      paddle.ai_target_y =
+          ball.predicted_y + (NextRandom(state.paddle_random_state) - 0.5f) * kPaddleHeight;
+    }
+    if (paddle.ai_reaction_time > 0.0f) {
+      paddle.ai_reaction_time -= kTickTime;
+      paddle.speed = 0.0f;
+    } else {
+      paddle.speed =
+          std::clamp((paddle.ai_target_y - paddle.y) / kTickTime, -kPaddleSpeed, kPaddleSpeed);
+    }
+    StepPaddle(paddle.y, paddle.speed, kTickTime);
+  }
+
+  for (TrailParticle& particle : ball.trail) {
+    particle.life -= particle.fade * kTickTime;
+    if (particle.life >= 0.0f) continue;
+    particle.life = 1.0f;
+    particle.fade = 3.0f + 25.0f * NextRandom(state.ball_random_state);
+    particle.pos = {ball.position.x + NextRandom(state.ball_random_state),
+                    ball.position.y + NextRandom(state.ball_random_state),
+                    -kBallRadius + NextRandom(state.ball_random_state)};
+  }
+}
+
+// What a tick reads back as: its trail burnt out.
+GameState WithoutTrails(GameState state) {
+  for (GameState::BallState& ball : state.balls)
+    for (TrailParticle& particle : ball.trail) particle = {-1.0f, 0.0f, glm::vec3(0.0f)};
+  return state;
+}
+
+double ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int minutes = argc > 1 ? std::atoi(argv[1]) : 10;
+  const size_t capacity = (argc > 2 ? std::atoi(argv[2]) : 4) << 20;
+  const int tick_count = minutes * kTicksPerMinute;
+
+  GameState state{};
+  state.ball_count = 1;
+  state.paddles[1].is_left = false;
+  state.ball_random_state = 42;
+  state.paddle_random_state = 43;
+  ServeBall(state.balls[0].position, state.balls[0].speed, true,
+            NextServeAngle(state.ball_random_state));
+  std::vector<GameState> states(tick_count);
+  for (GameState& tick_state : states) {
+    Step(state);
+    tick_state = state;
+  }
+
+  // Unbounded, for the size of every tick.
+  RewindBuffer whole(size_t(tick_count) * sizeof(GameState));
+  for (const GameState& tick_state : states) whole.Record(tick_state);
+  std::cout << minutes << " minutes, " << tick_count << " ticks of " << sizeof(GameState)
+            << " bytes" << std::endl;
+  const double bytes_per_minute = double(whole.GetUsedBytes()) / minutes;
+  std::cout << "  history: " << bytes_per_minute / 1024 << " KB per minute, "
+            << double(whole.GetUsedBytes()) / tick_count << " bytes per tick" << std::endl;
+
+  RewindBuffer rewind(capacity);
+  double record_time = 1e9;
+  for (int run = 0; run < 3; ++run) {
+    rewind.Clear();
+    const auto start = std::chrono::steady_clock::now();
+    for (const GameState& tick_state : states) rewind.Record(tick_state);
+    record_time = std::min(record_time, ElapsedMicroseconds(start) / tick_count);
+  }
+  const int kept_count = rewind.GetLastTick() - rewind.GetFirstTick() + 1;
+  std::cout << "  record: " << record_time << " us per tick" << std::endl;
+  std::cout << "  " << (capacity >> 20) << " MB keep " << kept_count / double(kTicksPerMinute)
+            << " minutes (" << rewind.GetUsedBytes() << " bytes used)" << std::endl;
+  if (rewind.GetUsedBytes() > capacity) {
+    std::cout << "The history takes more than its capacity" << std::endl;
+    return 1;
+  }
+
+  // Every tick kept reads back as recorded.
+  GameState read;
+  double seek_time = 0.0, max_seek_time = 0.0;
+  for (int tick = rewind.GetFirstTick(); tick <= rewind.GetLastTick(); ++tick) {
+    const auto start = std::chrono::steady_clock::now();
+    const bool is_read = rewind.Seek(tick, read);
+    const double time = ElapsedMicroseconds(start);
+    seek_time += time;
+    max_seek_time = std::max(max_seek_time, time);
+    const GameState expected = WithoutTrails(states[tick]);
+    if (!is_read || std::memcmp(&read, &expected, sizeof(read)) != 0) {
+      std::cout << "Tick " << tick << " reads back differently" << std::endl;
+      return 1;
+    }
+  }
+  std::cout << "  seek: " << seek_time / kept_count << " us on average, " << max_seek_time
+            << " us at most" << std::endl;
+
+  // Playing again from a tick in the past.
+  const int rewound_tick = rewind.GetLastTick() - 1000;
+  rewind.Truncate(rewound_tick);
+  for (int tick = rewound_tick + 1; tick < tick_count; ++tick) rewind.Record(states[tick]);
+  const GameState expected = WithoutTrails(states.back());
+  if (!rewind.Seek(tick_count - 1, read) || std::memcmp(&read, &expected, sizeof(read)) != 0) {
+    std::cout << "Ticks recorded after a rewind read back differently" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,117 @@
+// Offline benchmark of the game state snapshots: saving and restoring the
+// world, forking a state by copy, and the binary files, checked for round
+// trips.
+//
+// Usage: state_bench [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "GameState.h"
+#include "World.h"
+
+namespace {
+// The entities of a game, in the middle of a rally.
+void MakeWorld(World& world) {
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> random(-1.0f, 1.0f);
+  Entity left_paddle = world.Create();
+  Entity right_paddle = world.Create();
+  for (Entity entity : {left_paddle, right_paddle}) {
+    Paddle& paddle = world.paddles.Add(entity);
+    paddle.is_left = entity == left_paddle;
+    paddle.y = 20.0f * random(generator);
+    paddle.speed = 150.0f;
+    paddle.illuminate = 0.3f;
+  }
+  Entity entity = world.Create();
+  Ball& ball = world.balls.Add(entity);
+  ball.left_paddle = left_paddle;
+  ball.right_paddle = right_paddle;
+  ball.position = {10.0f * random(generator), 10.0f * random(generator)};
+  ball.speed = {110.0f, 40.0f};
+  for (TrailParticle& particle : world.trails.Add(entity).particles)
+    particle = {random(generator), 10.0f * random(generator),
+                {random(generator), random(generator), random(generator)}};
+}
+
+// Best time of a few runs, in nanoseconds per iteration.
+double Measure(int iterations, const std::function<void()>& function) {
+  double best = 1e9;
+  for (int run = 0; run < 5; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) function();
+    const std::chrono::duration<double, std::nano> duration =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, duration.count() / iterations);
+  }
+  return best;
+}
+
+bool operator==(const GameState& a, const GameState& b) {
+  // Saved field by field, so that the padding doesn't matter.
+  std::stringstream a_file, b_file;
+  WriteGameState(a_file, a);
+  WriteGameState(b_file, b);
+  return a_file.str() == b_file.str();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  World world;
+  MakeWorld(world);
+  GameState state;
+  state.ball_random_state = 42;
+  state.paddle_random_state = 43;
+  state.board = {30, 40, 0.2f, 0.0f, false};
+  if (!SaveWorld(world, state)) return 1;
+  std::cout << "GameState: " << sizeof(GameState) << " bytes" << std::endl;
+
+  // Restoring a state into another world, then saving it, gives it back.
+  World other_world;
+  MakeWorld(other_world);
+  for (Paddle& paddle : other_world.paddles) paddle.y = 0.0f;
+  RestoreWorld(state, other_world);
+  GameState restored = state;
+  restored.balls = {};
+  SaveWorld(other_world, restored);
+  if (!(restored == state)) {
+    std::cout << "Restored state differs" << std::endl;
+    return 1;
+  }
+
+  std::stringstream file;
+  WriteGameState(file, state);
+  const size_t file_size = file.str().size();
+  GameState read;
+  if (!ReadGameState(file, read) || !(read == state)) {
+    std::cout << "State read differs" << std::endl;
+    return 1;
+  }
+
+  GameState fork;
+  std::cout << "  save: " << Measure(iterations, [&] { SaveWorld(world, state); }) << " ns"
+            << std::endl;
+  std::cout << "  restore: " << Measure(iterations, [&] { RestoreWorld(state, world); })
+            << " ns" << std::endl;
+  std::cout << "  fork (copy): " << Measure(iterations, [&] {
+    fork = state;
+    // Keeps the copy from being optimized out.
+    asm volatile("" : : "r"(&fork) : "memory");
+  }) << " ns" << std::endl;
+  std::cout << "  write: " << Measure(iterations / 100, [&] {
+    std::stringstream out;
+    WriteGameState(out, state);
+  }) << " ns, " << file_size << " bytes" << std::endl;
+  std::cout << "  read: " << Measure(iterations / 100, [&] {
+    std::stringstream in(file.str());
+    ReadGameState(in, read);
+  }) << " ns" << std::endl;
+  return 0;
+}
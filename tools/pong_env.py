@@ -0,0 +1,91 @@
+"""Batched Pong environment for training paddle controllers.
+
+A thin ctypes binding of src/PongEnv.h. Arrays are allocated once and the
+library writes into them: reset() and step() return the same arrays every
+time, so copy what must outlive the next step.
+
+    env = PongVecEnv(1024)
+    observations = env.reset(seed=0)
+    while training:
+        actions = policy(observations)  # int8, (1024, 2), -1, 0 or 1
+        observations, rewards, dones = env.step(actions)
+
+Build the library with CMake (target pongenv).
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+_FLOAT_P = ctypes.POINTER(ctypes.c_float)
+_INT8_P = ctypes.POINTER(ctypes.c_int8)
+_UINT8_P = ctypes.POINTER(ctypes.c_uint8)
+
+MATCH_OVER = 1
+TRUNCATED = 2
+
+
+def _load(path):
+    if path is None:
+        path = os.environ.get("PONGENV_LIBRARY", "libpongenv.so")
+    library = ctypes.CDLL(path)
+    library.pong_env_create.argtypes = [ctypes.c_int, ctypes.c_float, ctypes.c_int, ctypes.c_int]
+    library.pong_env_create.restype = ctypes.c_void_p
+    library.pong_env_destroy.argtypes = [ctypes.c_void_p]
+    library.pong_env_destroy.restype = None
+    library.pong_env_observation_size.argtypes = []
+    library.pong_env_observation_size.restype = ctypes.c_int
+    library.pong_env_reset.argtypes = [ctypes.c_void_p, ctypes.c_uint64, _FLOAT_P]
+    library.pong_env_reset.restype = None
+    library.pong_env_step.argtypes = [ctypes.c_void_p, _INT8_P, _FLOAT_P, _FLOAT_P, _UINT8_P]
+    library.pong_env_step.restype = None
+    return library
+
+
+class PongVecEnv:
+    """env_count matches, for the left and the right player each.
+
+    observations: float32 (env_count, 8): ball x, y, speed x, speed y, left
+    and right paddle heights, left and right scores. The scores are the
+    game's: the left one counts the balls that passed the left paddle, so the
+    points won by the right player, and the other way round.
+    rewards: float32 (env_count, 2): 1 for winning a point, -1 for losing it.
+    dones: uint8 (env_count,): 0, MATCH_OVER or TRUNCATED. Done matches start
+    over: their observation is the first of the next match.
+    """
+
+    def __init__(self, env_count, dt=1.0 / 60.0, max_match_steps=0, thread_count=1,
+                 library_path=None):
+        self._library = _load(library_path)
+        self._env = self._library.pong_env_create(env_count, dt, max_match_steps, thread_count)
+        self.env_count = env_count
+        observation_size = self._library.pong_env_observation_size()
+        self.observations = np.zeros((env_count, observation_size), dtype=np.float32)
+        self.rewards = np.zeros((env_count, 2), dtype=np.float32)
+        self.dones = np.zeros(env_count, dtype=np.uint8)
+        self._observations_p = self.observations.ctypes.data_as(_FLOAT_P)
+        self._rewards_p = self.rewards.ctypes.data_as(_FLOAT_P)
+        self._dones_p = self.dones.ctypes.data_as(_UINT8_P)
+
+    def reset(self, seed=0):
+        self._library.pong_env_reset(self._env, seed, self._observations_p)
+        return self.observations
+
+    def step(self, actions):
+        # Only converts when the caller's array is not already int8 and
+        # contiguous.
+        actions = np.ascontiguousarray(actions, dtype=np.int8)
+        if actions.size != 2 * self.env_count:
+            raise ValueError("expected %d actions, got %d" % (2 * self.env_count, actions.size))
+        self._library.pong_env_step(self._env, actions.ctypes.data_as(_INT8_P),
+                                    self._observations_p, self._rewards_p, self._dones_p)
+        return self.observations, self.rewards, self.dones
+
+    def close(self):
+        if self._env:
+            self._library.pong_env_destroy(self._env)
+            self._env = None
+
+    def __del__(self):
+        self.close()